@@ -0,0 +1,119 @@
+#include "Cache.hpp"
+#include "Core/SigiLog.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CACHESIM_X86_SIMD
+#endif
+
+namespace CacheSim
+{
+
+namespace
+{
+auto findScalar(const uint64_t *set, unsigned paddedWays, uint64_t tag) -> int
+{
+    for (unsigned w = 0; w < paddedWays; ++w)
+        if (set[w] == tag)
+            return w;
+    return -1;
+}
+
+
+#ifdef CACHESIM_X86_SIMD
+/* Compiled for their instruction sets regardless of the build's flags,
+ * and only called once the CPU is known to support them */
+__attribute__((target("sse4.1")))
+auto findSSE41(const uint64_t *set, unsigned paddedWays, uint64_t tag) -> int
+{
+    const __m128i key = _mm_set1_epi64x(tag);
+    for (unsigned w = 0; w < paddedWays; w += 4)
+    {
+        __m128i lo = _mm_cmpeq_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(set + w)), key);
+        __m128i hi = _mm_cmpeq_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(set + w + 2)), key);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(lo)) |
+                   (_mm_movemask_pd(_mm_castsi128_pd(hi)) << 2);
+        if (mask != 0)
+            return w + __builtin_ctz(mask);
+    }
+    return -1;
+}
+
+
+__attribute__((target("avx2")))
+auto findAVX2(const uint64_t *set, unsigned paddedWays, uint64_t tag) -> int
+{
+    const __m256i key = _mm256_set1_epi64x(tag);
+    for (unsigned w = 0; w < paddedWays; w += 4)
+    {
+        __m256i eq = _mm256_cmpeq_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(set + w)), key);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        if (mask != 0)
+            return w + __builtin_ctz(mask);
+    }
+    return -1;
+}
+#endif
+
+
+auto isPowerOfTwo(uint64_t n) -> bool
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+auto setsFor(const std::string &name, CacheConfig config, unsigned lineBytes) -> uint64_t
+{
+    if (config.ways == 0 || config.ways > 64)
+        SigiLog::fatal("CacheSim " + name + ": associativity must be from 1 to 64");
+    if (config.bytes % (static_cast<uint64_t>(lineBytes) * config.ways) != 0)
+        SigiLog::fatal("CacheSim " + name + ": size must be a multiple of line size x associativity");
+
+    uint64_t sets = config.bytes / (static_cast<uint64_t>(lineBytes) * config.ways);
+    if (isPowerOfTwo(sets) == false)
+        SigiLog::fatal("CacheSim " + name + ": number of sets must be a power of two");
+    return sets;
+}
+}; //end namespace
+
+
+auto Cache::findWay() -> FindWay
+{
+#ifdef CACHESIM_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return findAVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return findSSE41;
+#endif
+    return findScalar;
+}
+
+
+Cache::Cache(std::string name, CacheConfig config, unsigned lineBytes, Replacement policy)
+    : name(name)
+    , ways(config.ways)
+    , sets(setsFor(name, config, lineBytes))
+    , paddedWays((config.ways + 3) & ~3U)
+    , policy(policy)
+    , findTag(findWay())
+    , tags(sets * paddedWays, INVALID_LINE)
+{
+    if (policy == Replacement::LRU)
+    {
+        stamps.resize(sets * paddedWays, 0);
+        clocks.resize(sets, 0);
+    }
+    else
+    {
+        if (isPowerOfTwo(ways) == false)
+            SigiLog::fatal("CacheSim " + name + ": PLRU requires a power of two associativity");
+        while ((1U << treeLevels) < ways)
+            ++treeLevels;
+        trees.resize(sets, 0);
+    }
+}
+
+}; //end namespace CacheSim
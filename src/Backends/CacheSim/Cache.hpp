@@ -0,0 +1,171 @@
+#ifndef CACHESIM_CACHE_H
+#define CACHESIM_CACHE_H
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <array>
+#include <mutex>
+
+namespace CacheSim
+{
+
+enum class Replacement { LRU, PLRU };
+
+/* Line addresses are at most 62 bits, with 4 byte lines, so never a real tag */
+constexpr uint64_t INVALID_LINE{~0ULL};
+
+struct CacheConfig
+{
+    uint64_t bytes;
+    unsigned ways;
+};
+
+
+class Cache
+{
+    /* A set-associative cache of line addresses.
+     *
+     * Each set's tags are stored contiguously, padded to a multiple of 4 ways
+     * with invalid tags, so a lookup compares 4 ways at a time:
+     * with AVX2 or SSE4.1, chosen at run time for the host CPU,
+     * or one way at a time otherwise.
+     * Only tags are kept; data is not simulated. */
+  public:
+    Cache(std::string name, CacheConfig config, unsigned lineBytes, Replacement policy);
+
+    using FindWay = int (*)(const uint64_t *set, unsigned paddedWays, uint64_t tag);
+    static auto findWay() -> FindWay;
+    /* The fastest tag search for the host CPU.
+     * Returns the first of 'paddedWays' ways of 'set' holding 'tag', or -1 */
+
+    auto access(uint64_t line) -> bool;
+    /* Returns true on a hit. A miss fills the line, evicting a victim */
+
+    const std::string name;
+    const unsigned ways;
+    const uint64_t sets;
+
+  private:
+    auto find(const uint64_t *tags, uint64_t tag) const -> int;
+    auto touch(uint64_t set, unsigned way) -> void;
+    auto victim(uint64_t set) const -> unsigned;
+
+    const unsigned paddedWays;
+    const Replacement policy;
+    const FindWay findTag;
+    unsigned treeLevels{0};
+
+    std::vector<uint64_t> tags;
+    /* sets x paddedWays */
+    std::vector<uint64_t> stamps;
+    std::vector<uint64_t> clocks;
+    /* LRU: the last access of each way, by a clock per set,
+     * so sets can be updated concurrently; invalid ways are 0 */
+    std::vector<uint64_t> trees;
+    /* PLRU: one tree per set; bit N is node N of the binary tree,
+     * pointing towards the less recently used half */
+};
+
+
+class SharedCache
+{
+    /* A cache shared by every event stream.
+     * Sets are locked in stripes, so streams only contend
+     * when they touch the same stripe at the same time */
+  public:
+    SharedCache(std::string name, CacheConfig config, unsigned lineBytes, Replacement policy)
+        : cache(name, config, lineBytes, policy) {}
+
+    auto access(uint64_t line) -> bool
+    {
+        std::lock_guard<std::mutex> lock(stripes[line & (cache.sets - 1) & (stripes.size() - 1)]);
+        return cache.access(line);
+    }
+
+  private:
+    Cache cache;
+    std::array<std::mutex, 64> stripes;
+    /* indexed by the low bits of the set, so each set maps to one stripe */
+};
+
+
+inline auto Cache::find(const uint64_t *set, uint64_t tag) const -> int
+{
+    return findTag(set, paddedWays, tag);
+}
+
+
+inline auto Cache::access(uint64_t line) -> bool
+{
+    uint64_t set = line & (sets - 1);
+    uint64_t *setTags = &tags[set * paddedWays];
+
+    int way = find(setTags, line);
+    if (way >= 0)
+    {
+        touch(set, way);
+        return true;
+    }
+
+    /* fill an invalid way first; padding ways are past 'ways' */
+    way = find(setTags, INVALID_LINE);
+    if (way < 0 || static_cast<unsigned>(way) >= ways)
+        way = victim(set);
+
+    setTags[way] = line;
+    touch(set, way);
+    return false;
+}
+
+
+inline auto Cache::touch(uint64_t set, unsigned way) -> void
+{
+    if (policy == Replacement::LRU)
+    {
+        stamps[set * paddedWays + way] = ++clocks[set];
+    }
+    else
+    {
+        uint64_t &tree = trees[set];
+        unsigned node = 1;
+        for (unsigned level = treeLevels; level > 0; --level)
+        {
+            unsigned bit = (way >> (level - 1)) & 1;
+            /* point away from the half just used */
+            tree = bit ? (tree & ~(1ULL << node)) : (tree | (1ULL << node));
+            node = node*2 + bit;
+        }
+    }
+}
+
+
+inline auto Cache::victim(uint64_t set) const -> unsigned
+{
+    if (policy == Replacement::LRU)
+    {
+        const uint64_t *setStamps = &stamps[set * paddedWays];
+        unsigned way = 0;
+        for (unsigned w = 1; w < ways; ++w)
+            if (setStamps[w] < setStamps[way])
+                way = w;
+        return way;
+    }
+    else
+    {
+        uint64_t tree = trees[set];
+        unsigned node = 1;
+        unsigned way = 0;
+        for (unsigned level = 0; level < treeLevels; ++level)
+        {
+            unsigned bit = (tree >> node) & 1;
+            way = way*2 + bit;
+            node = node*2 + bit;
+        }
+        return way;
+    }
+}
+
+}; //end namespace CacheSim
+
+#endif
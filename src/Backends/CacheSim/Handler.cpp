@@ -0,0 +1,376 @@
+#include "Handler.hpp"
+#include "Core/SigiLog.hpp"
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unordered_set>
+
+using namespace SigiLog; // console logging
+namespace CacheSim
+{
+
+namespace
+{
+/* Configuration */
+std::string outputPath{"."};
+unsigned lineBits{6};
+CacheConfig l1Config{32ULL << 10, 8};
+CacheConfig l2Config{256ULL << 10, 8};
+CacheConfig llcConfig{8ULL << 20, 16};
+Replacement policy{Replacement::LRU};
+
+/* Global to all event streams */
+std::unique_ptr<SharedCache> llc;
+
+std::mutex gMtx;
+std::unordered_set<TID> seenThreads;
+std::map<TID, Counters> threadCounters;
+std::map<std::string, Counters> functionCounters;
+/* gathered as each event stream finishes */
+
+
+auto parseAll(const Args &args, const std::set<char> &options) -> std::map<char, std::string>
+{
+    std::map<char, std::string> matches;
+    for (auto arg = args.cbegin(); arg != args.cend(); ++arg)
+    {
+        if ((*arg).length() < 2 || (*arg)[0] != '-' || options.count((*arg)[1]) == 0)
+            fatal("unexpected cachesim option: " + *arg);
+
+        /* read before 'arg' moves on to the option's value */
+        char opt = (*arg)[1];
+        if ((*arg).length() > 2)
+            matches[opt] = (*arg).substr(2, std::string::npos);
+        else if (arg + 1 != args.cend())
+            matches[opt] = *(++arg);
+    }
+
+    return matches;
+}
+
+
+auto parseSize(std::string size, std::string what) -> uint64_t
+{
+    /* size in bytes, or with a K/M/G suffix */
+    try
+    {
+        size_t pos = 0;
+        uint64_t ret = std::stoull(size, &pos);
+        uint64_t unit = 1;
+        if (pos + 1 == size.length())
+        {
+            switch (::tolower(size.back()))
+            {
+            case 'k': unit = 1ULL << 10; break;
+            case 'm': unit = 1ULL << 20; break;
+            case 'g': unit = 1ULL << 30; break;
+            default: fatal("CacheSim " + what + ": invalid suffix");
+            }
+        }
+        else if (pos != size.length())
+        {
+            fatal("CacheSim " + what + ": invalid argument");
+        }
+        return ret * unit;
+    }
+    catch (std::invalid_argument &e)
+    {
+        fatal("CacheSim " + what + ": invalid argument");
+    }
+    catch (std::out_of_range &e)
+    {
+        fatal("CacheSim " + what + ": out_of_range");
+    }
+}
+
+
+auto parseCache(std::string arg, std::string what, CacheConfig defaultConfig) -> CacheConfig
+{
+    /* SIZE,WAYS */
+    if (arg.empty() == true)
+        return defaultConfig;
+
+    auto comma = arg.find(',');
+    if (comma == std::string::npos)
+        fatal("CacheSim " + what + ": expected SIZE,WAYS");
+
+    /* checked before narrowing, so large values are not truncated */
+    uint64_t ways = parseSize(arg.substr(comma + 1), what + " associativity");
+    if (ways == 0 || ways > 64)
+        fatal("CacheSim " + what + ": associativity must be from 1 to 64");
+
+    return {parseSize(arg.substr(0, comma), what), static_cast<unsigned>(ways)};
+}
+
+
+auto parseLineBits(std::string arg) -> unsigned
+{
+    if (arg.empty() == true)
+        return 6; // 64 byte lines
+
+    uint64_t bytes = parseSize(arg, "line size");
+    unsigned bits = 0;
+    while ((1ULL << bits) < bytes)
+        ++bits;
+    if ((1ULL << bits) != bytes || bits < 2 || bits > 12)
+        fatal("CacheSim line size: expected a power of two from 4 to 4096");
+    return bits;
+}
+
+
+auto parsePolicy(std::string arg) -> Replacement
+{
+    if (arg.empty() == true || arg == "lru")
+        return Replacement::LRU;
+    else if (arg == "plru")
+        return Replacement::PLRU;
+
+    fatal("CacheSim replacement policy: expected 'lru' or 'plru'");
+}
+
+
+auto writeCounters(FILE *fp, const std::string &key, const Counters &counters) -> void
+{
+    fprintf(fp, "%s", key.c_str());
+    for (unsigned level = 0; level < LEVELS; ++level)
+        fprintf(fp, ",%lu,%lu",
+                static_cast<unsigned long>(counters.hits[level]),
+                static_cast<unsigned long>(counters.misses[level]));
+    fprintf(fp, "\n");
+}
+
+
+template <typename Map, typename KeyString>
+auto flushCounters(std::string filePath, std::string keyName, const Map &counters,
+                   KeyString keyString) -> void
+{
+    FILE *fp = fopen(filePath.c_str(), "w");
+    if (fp == nullptr)
+        fatal("opening " + filePath + ": " + strerror(errno));
+
+    fprintf(fp, "%s,l1Hits,l1Misses,l2Hits,l2Misses,llcHits,llcMisses\n", keyName.c_str());
+    for (auto &p : counters)
+        writeCounters(fp, keyString(p.first), p.second);
+
+    if (fclose(fp) != 0)
+        fatal("closing " + filePath + ": " + strerror(errno));
+}
+
+
+auto missRate(const Counters &counters, unsigned level) -> std::string
+{
+    uint64_t accesses = counters.hits[level] + counters.misses[level];
+    if (accesses == 0)
+        return "-";
+
+    char rate[16];
+    snprintf(rate, sizeof(rate), "%.2f%%", 100.0 * counters.misses[level] / accesses);
+    return rate;
+}
+
+}; //end namespace
+
+
+auto onParse(Args args) -> void
+{
+    /* only accept short options */
+    std::set<char> options;
+    options.insert('o'); // -o OUTPUT_DIRECTORY
+    options.insert('1'); // -1 L1_SIZE,WAYS
+    options.insert('2'); // -2 L2_SIZE,WAYS
+    options.insert('3'); // -3 LLC_SIZE,WAYS
+    options.insert('b'); // -b LINE_SIZE
+    options.insert('p'); // -p {lru,plru}
+    auto matches = parseAll(args, options);
+
+    if (matches['o'].empty() == false)
+        outputPath = matches['o'];
+    l1Config = parseCache(matches['1'], "L1", l1Config);
+    l2Config = parseCache(matches['2'], "L2", l2Config);
+    llcConfig = parseCache(matches['3'], "LLC", llcConfig);
+    lineBits = parseLineBits(matches['b']);
+    policy = parsePolicy(matches['p']);
+
+    /* check the private caches' configuration once, up front */
+    Cache("L1", l1Config, 1U << lineBits, policy);
+    Cache("L2", l2Config, 1U << lineBits, policy);
+    llc = std::make_unique<SharedCache>("LLC", llcConfig, 1U << lineBits, policy);
+}
+
+
+auto onExit() -> void
+{
+    flushCounters(outputPath + "/sigil.cachesim.threads.csv", "thread", threadCounters,
+                  [](TID tid){ return std::to_string(tid); });
+    flushCounters(outputPath + "/sigil.cachesim.functions.csv", "function", functionCounters,
+                  [](const std::string &name){ return name; });
+
+    Counters total;
+    for (auto &p : threadCounters)
+        total += p.second;
+    info("CacheSim miss rates: L1 " + missRate(total, L1) +
+         ", L2 " + missRate(total, L2) + ", LLC " + missRate(total, LLC));
+    llc.reset();
+}
+
+
+auto requirements() -> sigil2::capabilities
+{
+    using namespace sigil2;
+    using namespace sigil2::capability;
+
+    auto caps = initCaps();
+
+    caps[MEMORY]         = availability::enabled;
+    caps[MEMORY_LDST]    = availability::enabled;
+    caps[MEMORY_SIZE]    = availability::enabled;
+    caps[MEMORY_ADDRESS] = availability::enabled;
+
+    caps[COMPUTE]              = availability::disabled;
+    caps[COMPUTE_INT_OR_FLOAT] = availability::disabled;
+    caps[COMPUTE_ARITY]        = availability::disabled;
+    caps[COMPUTE_OP]           = availability::disabled;
+    caps[COMPUTE_SIZE]         = availability::disabled;
+
+    caps[CONTROL_FLOW] = availability::disabled;
+
+    caps[SYNC]      = availability::enabled;
+    caps[SYNC_TYPE] = availability::enabled;
+    caps[SYNC_ARGS] = availability::disabled;
+
+    caps[CONTEXT_INSTRUCTION] = availability::disabled;
+    caps[CONTEXT_BASIC_BLOCK] = availability::disabled;
+    caps[CONTEXT_FUNCTION]    = availability::enabled;
+    caps[CONTEXT_THREAD]      = availability::enabled;
+
+    return caps;
+}
+
+
+ThreadState::ThreadState()
+    : l1("L1", l1Config, 1U << lineBits, policy)
+    , l2("L2", l2Config, 1U << lineBits, policy)
+{
+}
+
+
+Handler::Handler()
+{
+    /* events before the first thread switch */
+    functionNames.push_back("(none)");
+    onSwap(0);
+}
+
+
+Handler::~Handler()
+{
+    std::lock_guard<std::mutex> lock(gMtx);
+    for (auto &p : threads)
+    {
+        threadCounters[p.first] += p.second->counters;
+        auto &functions = p.second->functions;
+        for (FnID fn = 0; fn < functions.size(); ++fn)
+            functionCounters[functionNames[fn]] += functions[fn];
+    }
+}
+
+
+auto Handler::onSyncEv(const sigil2::SyncEvent &ev) -> void
+{
+    if (ev.type() == SyncTypeEnum::SGLPRIM_SYNC_SWAP)
+        onSwap(ev.data());
+}
+
+
+auto Handler::onMemEv(const sigil2::MemEvent &ev) -> void
+{
+    /* every line touched by the access */
+    uint64_t bytes = ev.bytes() > 0 ? ev.bytes() : 1;
+    uint64_t first = ev.addr() >> lineBits;
+    uint64_t last = (ev.addr() + bytes - 1) >> lineBits;
+
+    FnID fn = current->callstack.empty() ? 0 : current->callstack.back();
+    Counters &fnCounters = current->functions[fn];
+    for (uint64_t line = first; line <= last; ++line)
+    {
+        unsigned hitLevel = lookup(line);
+        current->counters.record(hitLevel);
+        fnCounters.record(hitLevel);
+    }
+}
+
+
+auto Handler::onCxtEv(const sigil2::CxtEvent &ev) -> void
+{
+    switch (ev.type())
+    {
+      case CxtTypeEnum::SGLPRIM_CXT_FUNC_ENTER:
+        current->callstack.push_back(function(ev.getName()));
+        break;
+      case CxtTypeEnum::SGLPRIM_CXT_FUNC_EXIT:
+        /* a thread can be swapped in partway through a function */
+        if (current->callstack.empty() == false)
+            current->callstack.pop_back();
+        break;
+      default:
+        break;
+    }
+}
+
+
+auto Handler::onSwap(TID tid) -> void
+{
+    if (tid == currentTID)
+        return;
+
+    auto &state = threads[tid];
+    if (state == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(gMtx);
+        /* thread 0 is each stream's events before its first switch */
+        if (tid != 0 && seenThreads.insert(tid).second == false)
+            fatal("CacheSim thread " + std::to_string(tid) + " seen in multiple event streams");
+        state = std::make_unique<ThreadState>();
+    }
+    state->functions.resize(functionNames.size());
+
+    currentTID = tid;
+    current = state.get();
+}
+
+
+auto Handler::lookup(uint64_t line) -> unsigned
+{
+    /* Returns the level the line hit in, or LEVELS if it missed in every level.
+     * Each level is filled on a miss */
+    if (current->l1.access(line) == true)
+        return L1;
+    if (current->l2.access(line) == true)
+        return L2;
+    if (llc->access(line) == true)
+        return LLC;
+    return LEVELS;
+}
+
+
+auto Handler::function(const char *name) -> FnID
+{
+    auto it = functionIds.find(name);
+    if (it != functionIds.end())
+        return it->second;
+
+    FnID fn = functionNames.size();
+    functionIds.emplace(name, fn);
+    functionNames.push_back(name);
+
+    /* every thread in this stream indexes functions the same way */
+    for (auto &p : threads)
+        p.second->functions.resize(functionNames.size());
+    return fn;
+}
+
+}; //end namespace CacheSim
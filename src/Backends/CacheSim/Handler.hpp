@@ -0,0 +1,95 @@
+#ifndef CACHESIM_HANDLER_H
+#define CACHESIM_HANDLER_H
+
+#include "Core/Backends.hpp"
+#include "Cache.hpp"
+
+#include <memory>
+#include <unordered_map>
+
+namespace CacheSim
+{
+
+auto onParse(Args args) -> void;
+auto onExit() -> void;
+auto requirements() -> sigil2::capabilities;
+/* Sigil2 hooks */
+
+using TID = int32_t;
+using FnID = uint32_t;
+
+/* Private L1 and L2, and a shared last level cache */
+enum Level : unsigned { L1 = 0, L2, LLC, LEVELS };
+
+struct Counters
+{
+    uint64_t hits[LEVELS]{};
+    uint64_t misses[LEVELS]{};
+
+    auto record(unsigned hitLevel) -> void
+    {
+        /* every level above the one that hit was a miss;
+         * LEVELS means the line came from memory */
+        for (unsigned level = 0; level < hitLevel; ++level)
+            ++misses[level];
+        if (hitLevel < LEVELS)
+            ++hits[hitLevel];
+    }
+
+    auto operator+=(const Counters &other) -> Counters&
+    {
+        for (unsigned level = 0; level < LEVELS; ++level)
+        {
+            hits[level] += other.hits[level];
+            misses[level] += other.misses[level];
+        }
+        return *this;
+    }
+};
+
+
+struct ThreadState
+{
+    ThreadState();
+
+    Cache l1;
+    Cache l2;
+
+    Counters counters;
+    std::vector<Counters> functions;
+    /* indexed by the event stream's function IDs */
+    std::vector<FnID> callstack;
+};
+
+
+class Handler : public BackendIface
+{
+  public:
+    Handler();
+    Handler(const Handler &) = delete;
+    Handler &operator=(const Handler &) = delete;
+    virtual ~Handler() override;
+
+    virtual auto onSyncEv(const sigil2::SyncEvent &ev) -> void override;
+    virtual auto onMemEv(const sigil2::MemEvent &ev) -> void override;
+    virtual auto onCxtEv(const sigil2::CxtEvent &ev) -> void override;
+    /* Sigil2 event hooks */
+
+  private:
+    auto onSwap(TID tid) -> void;
+    auto lookup(uint64_t line) -> unsigned;
+    auto function(const char *name) -> FnID;
+    /* helpers */
+
+    std::unordered_map<TID, std::unique_ptr<ThreadState>> threads;
+    TID currentTID{-1};
+    ThreadState *current{nullptr};
+
+    std::unordered_map<std::string, FnID> functionIds;
+    std::vector<std::string> functionNames;
+    /* function 0 is time spent outside of any function */
+};
+
+}; //end namespace CacheSim
+
+#endif
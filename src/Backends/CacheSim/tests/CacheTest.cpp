@@ -0,0 +1,184 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "CacheSim/Cache.hpp"
+#include "CacheSim/Handler.hpp"
+
+using namespace CacheSim;
+
+constexpr unsigned lineBytes = 64;
+
+namespace
+{
+
+auto oneSet(unsigned ways, Replacement policy) -> Cache
+{
+    /* every line maps to set 0 */
+    return Cache("test", CacheConfig{lineBytes * ways, ways}, lineBytes, policy);
+}
+
+}; //end namespace
+
+
+TEST_CASE("invalid ways are filled before any eviction", "[CacheFill]")
+{
+    for (auto policy : {Replacement::LRU, Replacement::PLRU})
+    {
+        Cache cache = oneSet(8, policy);
+        for (uint64_t line = 0; line < 8; ++line)
+            REQUIRE(cache.access(line) == false);
+        for (uint64_t line = 0; line < 8; ++line)
+            REQUIRE(cache.access(line) == true);
+    }
+}
+
+
+TEST_CASE("LRU evicts the least recently used way", "[CacheLRU]")
+{
+    Cache cache = oneSet(4, Replacement::LRU);
+    for (uint64_t line : {1, 2, 3, 4})
+        REQUIRE(cache.access(line) == false);
+
+    SECTION("a hit makes a way the most recently used")
+    {
+        REQUIRE(cache.access(1) == true);
+        REQUIRE(cache.access(5) == false); // evicts 2
+        REQUIRE(cache.access(1) == true);
+        REQUIRE(cache.access(3) == true);
+        REQUIRE(cache.access(4) == true);
+        REQUIRE(cache.access(5) == true);
+        REQUIRE(cache.access(2) == false); // evicts 1
+        REQUIRE(cache.access(1) == false);
+    }
+
+    SECTION("misses evict in the order lines were filled")
+    {
+        for (uint64_t line : {5, 6, 7, 8})
+            REQUIRE(cache.access(line) == false);
+        for (uint64_t line : {5, 6, 7, 8})
+            REQUIRE(cache.access(line) == true);
+        for (uint64_t line : {1, 2, 3, 4})
+            REQUIRE(cache.access(line) == false);
+    }
+}
+
+
+TEST_CASE("tree-PLRU evicts the way its tree points to", "[CachePLRU]")
+{
+    Cache cache = oneSet(4, Replacement::PLRU);
+    for (uint64_t line : {1, 2, 3, 4})
+        REQUIRE(cache.access(line) == false);
+
+    /* way 3 was touched last: the root points to ways 0-1,
+     * and their node to way 0 */
+    REQUIRE(cache.access(5) == false); // evicts 1, way 0
+
+    /* the root now points to ways 2-3, and their node to way 2,
+     * even though 2 was used less recently than 3 */
+    REQUIRE(cache.access(1) == false); // evicts 3, way 2
+    REQUIRE(cache.access(2) == true);
+    REQUIRE(cache.access(4) == true);
+    REQUIRE(cache.access(5) == true);
+    REQUIRE(cache.access(3) == false);
+}
+
+
+TEST_CASE("padding ways never hold lines", "[CachePadding]")
+{
+    /* 6 ways are padded to 8 */
+    Cache cache = oneSet(6, Replacement::LRU);
+    for (uint64_t line = 0; line < 6; ++line)
+        REQUIRE(cache.access(line) == false);
+
+    REQUIRE(cache.access(6) == false); // evicts 0
+    for (uint64_t line = 1; line < 7; ++line)
+        REQUIRE(cache.access(line) == true);
+    REQUIRE(cache.access(0) == false);
+}
+
+
+TEST_CASE("lines only conflict within their set", "[CacheSets]")
+{
+    Cache cache("test", CacheConfig{lineBytes * 2 * 4, 2}, lineBytes, Replacement::LRU);
+    REQUIRE(cache.sets == 4);
+
+    /* lines 0, 4, 8 share set 0; lines 1-3 each have their own */
+    for (uint64_t line : {0, 4, 1, 2, 3})
+        REQUIRE(cache.access(line) == false);
+    REQUIRE(cache.access(8) == false); // evicts 0
+    for (uint64_t line : {4, 8, 1, 2, 3})
+        REQUIRE(cache.access(line) == true);
+    REQUIRE(cache.access(0) == false);
+}
+
+
+TEST_CASE("the tag search finds the first matching way", "[CacheFind]")
+{
+    srand(time(NULL));
+    auto find = Cache::findWay();
+
+    for (unsigned paddedWays = 4; paddedWays <= 64; paddedWays += 4)
+    {
+        std::vector<uint64_t> set(paddedWays, INVALID_LINE);
+        REQUIRE(find(set.data(), paddedWays, 42) == -1);
+        REQUIRE(find(set.data(), paddedWays, INVALID_LINE) == 0);
+
+        for (unsigned w = 0; w < paddedWays; ++w)
+            set[w] = (static_cast<uint64_t>(rand()) << 20) | w;
+        for (unsigned w = 0; w < paddedWays; ++w)
+            REQUIRE(find(set.data(), paddedWays, set[w]) == static_cast<int>(w));
+        REQUIRE(find(set.data(), paddedWays, INVALID_LINE) == -1);
+    }
+}
+
+
+TEST_CASE("shared cache behaves as a cache", "[SharedCache]")
+{
+    SharedCache cache("test", CacheConfig{lineBytes * 2 * 128, 2}, lineBytes, Replacement::LRU);
+    for (uint64_t line = 0; line < 256; ++line)
+        REQUIRE(cache.access(line) == false);
+    for (uint64_t line = 0; line < 256; ++line)
+        REQUIRE(cache.access(line) == true);
+}
+
+
+TEST_CASE("counters record a miss at every level above a hit", "[Counters]")
+{
+    Counters counters;
+
+    counters.record(L1);
+    REQUIRE(counters.hits[L1] == 1);
+    REQUIRE(counters.misses[L1] == 0);
+
+    counters.record(L2);
+    REQUIRE(counters.misses[L1] == 1);
+    REQUIRE(counters.hits[L2] == 1);
+    REQUIRE(counters.misses[L2] == 0);
+
+    counters.record(LLC);
+    REQUIRE(counters.misses[L1] == 2);
+    REQUIRE(counters.misses[L2] == 1);
+    REQUIRE(counters.hits[LLC] == 1);
+    REQUIRE(counters.misses[LLC] == 0);
+
+    /* from memory */
+    counters.record(LEVELS);
+    REQUIRE(counters.hits[L1] == 1);
+    REQUIRE(counters.hits[L2] == 1);
+    REQUIRE(counters.hits[LLC] == 1);
+    REQUIRE(counters.misses[L1] == 3);
+    REQUIRE(counters.misses[L2] == 2);
+    REQUIRE(counters.misses[LLC] == 1);
+
+    Counters total;
+    total += counters;
+    total += counters;
+    for (unsigned level = 0; level < LEVELS; ++level)
+    {
+        REQUIRE(total.hits[level] == 2 * counters.hits[level]);
+        REQUIRE(total.misses[level] == 2 * counters.misses[level]);
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef SC_COMMEDGES_H
+#define SC_COMMEDGES_H
+
+#include "SCShadowMemory.hpp"
+
+#include <limits>
+#include <vector>
+#include <utility>
+
+namespace SigilClassic
+{
+
+/* Entity IDs start at -1 (no writer), so this is never a producer */
+constexpr Int EMPTY_EDGE{std::numeric_limits<Int>::min()};
+
+/* Bytes communicated to an entity, by producer entity.
+ *
+ * Most entities read from only 1-3 producers, so the first few edges are
+ * kept inline. Past that, edges move to a flat open-addressing table,
+ * instead of a node per edge in a std::unordered_map. */
+class CommEdges
+{
+  public:
+    using Edge = std::pair<Int, UInt>;
+    /* producer entity ID, bytes */
+
+    auto add(Int producer, UInt bytes) -> void
+    {
+        if (table.empty() == true)
+        {
+            for (unsigned i = 0; i < inlineUsed; ++i)
+            {
+                if (inlined[i].first == producer)
+                {
+                    inlined[i].second += bytes;
+                    return;
+                }
+            }
+
+            if (inlineUsed < inlineEdges)
+            {
+                inlined[inlineUsed++] = {producer, bytes};
+                return;
+            }
+
+            grow();
+        }
+
+        Edge &slot = find(producer);
+        if (slot.first == EMPTY_EDGE)
+        {
+            if ((tableUsed + 1) * 4 > table.size() * 3)
+            {
+                grow();
+                return add(producer, bytes);
+            }
+            slot.first = producer;
+            ++tableUsed;
+        }
+        slot.second += bytes;
+    }
+
+    auto size() const -> size_t
+    {
+        return table.empty() ? inlineUsed : tableUsed;
+    }
+
+    template <typename F>
+    auto forEach(F f) const -> void
+    {
+        if (table.empty() == true)
+        {
+            for (unsigned i = 0; i < inlineUsed; ++i)
+                f(inlined[i].first, inlined[i].second);
+        }
+        else
+        {
+            for (auto &edge : table)
+                if (edge.first != EMPTY_EDGE)
+                    f(edge.first, edge.second);
+        }
+    }
+
+  private:
+    static constexpr unsigned inlineEdges = 3;
+
+    auto find(Int producer) -> Edge&
+    {
+        size_t mask = table.size() - 1;
+        size_t i = (static_cast<UInt>(producer) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+        while (table[i].first != EMPTY_EDGE && table[i].first != producer)
+            i = (i + 1) & mask;
+        return table[i];
+    }
+
+    auto grow() -> void
+    {
+        /* power-of-two table, rehashed from whichever storage is in use */
+        std::vector<Edge> old(table.empty() ? inlined : table.data(),
+                              table.empty() ? inlined + inlineUsed : table.data() + table.size());
+        table.assign(table.empty() ? 8 : table.size() * 2, Edge{EMPTY_EDGE, 0});
+        tableUsed = 0;
+
+        for (auto &edge : old)
+        {
+            if (edge.first == EMPTY_EDGE)
+                continue;
+            find(edge.first) = edge;
+            ++tableUsed;
+        }
+    }
+
+    Edge inlined[inlineEdges];
+    unsigned inlineUsed{0};
+
+    std::vector<Edge> table;
+    size_t tableUsed{0};
+};
+
+}; //end namespace SigilClassic
+
+#endif
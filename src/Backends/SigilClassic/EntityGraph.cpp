@@ -0,0 +1,150 @@
+#include "EntityGraph.hpp"
+#include "Core/SigiLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+namespace SigilClassic
+{
+
+EntityGraphWriter::EntityGraphWriter(std::string path)
+    : path(path)
+{
+    fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr)
+        SigiLog::fatal("opening " + path + ": " + strerror(errno));
+
+    EntityGraphHeader header{};
+    memcpy(header.magic, "SGLCLENT", sizeof(header.magic));
+    header.version = entityGraphVersion;
+    header.byteOrder = 0x0102;
+    if (fwrite(&header, sizeof(header), 1, fp) != 1)
+        SigiLog::fatal("writing " + path + ": " + strerror(errno));
+
+    worker = std::thread(&EntityGraphWriter::run, this);
+}
+
+
+EntityGraphWriter::~EntityGraphWriter()
+{
+    if (fp != nullptr)
+        close({});
+}
+
+
+auto EntityGraphWriter::write(TID tid, TContext &&tcxt) -> void
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.emplace_back(tid, std::move(tcxt));
+    }
+    cv.notify_one();
+}
+
+
+auto EntityGraphWriter::close(const std::vector<const std::string*> &names) -> void
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closing = true;
+    }
+    cv.notify_one();
+    worker.join();
+
+    std::vector<uint32_t> nameEnd;
+    nameEnd.reserve(names.size());
+    std::vector<char> text;
+    for (auto name : names)
+    {
+        text.insert(text.end(), name->begin(), name->end());
+        nameEnd.push_back(text.size());
+    }
+
+    buffer.clear();
+    column(nameEnd);
+    column(text);
+    writeBlock({EntityBlockHeader::NAMES, -1,
+                static_cast<uint32_t>(nameEnd.size()), static_cast<uint32_t>(text.size()),
+                buffer.size()});
+
+    if (fclose(fp) != 0)
+        SigiLog::fatal("closing " + path + ": " + strerror(errno));
+    fp = nullptr;
+}
+
+
+auto EntityGraphWriter::run() -> void
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]{ return queue.empty() == false || closing == true; });
+        if (queue.empty() == true)
+            return;
+
+        auto next = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+
+        encode(next.first, next.second);
+        /* the thread's entities are freed here */
+    }
+}
+
+
+auto EntityGraphWriter::encode(TID tid, const TContext &tcxt) -> void
+{
+    std::vector<const std::pair<const EID, EntityData>*> sorted;
+    sorted.reserve(tcxt.entity_data.size());
+    for (auto &p : tcxt.entity_data)
+        sorted.push_back(&p);
+    std::sort(sorted.begin(), sorted.end(),
+              [](decltype(sorted)::value_type a, decltype(sorted)::value_type b)
+              { return a->first < b->first; });
+
+    auto n = sorted.size();
+    std::vector<int32_t> eid(n), caller(n), producer;
+    std::vector<uint32_t> function(n), iops(n), flops(n), localBytes(n), edgeEnd(n), bytes;
+    for (size_t i = 0; i < n; ++i)
+    {
+        const EntityData &data = sorted[i]->second;
+        eid[i]        = sorted[i]->first;
+        function[i]   = data.fn;
+        caller[i]     = data.caller;
+        iops[i]       = data.iops;
+        flops[i]      = data.flops;
+        localBytes[i] = data.local_bytes_read;
+
+        data.comm_edges.forEach([&](EID from, UInt count)
+                                { producer.push_back(from); bytes.push_back(count); });
+        edgeEnd[i] = producer.size();
+    }
+
+    buffer.clear();
+    column(eid);
+    column(function);
+    column(caller);
+    column(iops);
+    column(flops);
+    column(localBytes);
+    column(edgeEnd);
+    column(producer);
+    column(bytes);
+    writeBlock({EntityBlockHeader::THREAD, tid,
+                static_cast<uint32_t>(n), static_cast<uint32_t>(producer.size()),
+                buffer.size()});
+
+    ++threadCount;
+    entityCount += n;
+}
+
+
+auto EntityGraphWriter::writeBlock(const EntityBlockHeader &header) -> void
+{
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fwrite(buffer.data(), 1, buffer.size(), fp) != buffer.size())
+        SigiLog::fatal("writing " + path + ": " + strerror(errno));
+}
+
+}; //end namespace SigilClassic
@@ -0,0 +1,123 @@
+#ifndef SC_ENTITYGRAPH_H
+#define SC_ENTITYGRAPH_H
+
+#include "SigilClassic.hpp"
+
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+/* SigilClassic entity graph format.
+ *
+ * sigil.entities.out is an EntityGraphHeader, followed by a series of
+ * blocks, in the writing machine's byte order. Each block is an
+ * EntityBlockHeader followed by 'blockBytes' of columns.
+ *
+ * A THREAD block holds every entity of one thread, sorted by entity ID,
+ * one column per field:
+ *
+ *   int32  eid[entities]
+ *   uint32 function[entities]   interned function ID, or INVL_FN
+ *   int32  caller[entities]
+ *   uint32 iops[entities]
+ *   uint32 flops[entities]
+ *   uint32 localBytes[entities]
+ *   uint32 edgeEnd[entities]    entity i's edges are [edgeEnd[i-1], edgeEnd[i])
+ *   int32  producer[edges]      -1 for bytes no entity has written
+ *   uint32 bytes[edges]
+ *
+ * The last block is a NAMES block, with 'entities' function names
+ * in 'edges' bytes of text:
+ *
+ *   uint32 nameEnd[entities]    function i is text [nameEnd[i-1], nameEnd[i])
+ *   char   text[edges]
+ *
+ * Entity IDs are unique across threads, so producers can be looked up
+ * in any thread's block. The exception is -1, which each thread uses
+ * for costs outside of any function.
+ * See SigilClassic/scripts/sigilclassic_aggregator.py for a reader. */
+
+namespace SigilClassic
+{
+
+constexpr uint16_t entityGraphVersion = 1;
+
+struct EntityGraphHeader
+{
+    char magic[8];          /* "SGLCLENT" */
+    uint16_t version;       /* entityGraphVersion */
+    uint16_t byteOrder;     /* 0x0102, in the writer's byte order */
+    uint32_t reserved;
+};
+
+
+struct EntityBlockHeader
+{
+    enum Type : uint32_t
+    {
+        THREAD = 0,
+        NAMES  = 1,
+    };
+
+    uint32_t type;
+    int32_t tid;            /* -1 for NAMES */
+    uint32_t entities;
+    uint32_t edges;
+    uint64_t blockBytes;    /* following this header */
+};
+
+
+class EntityGraphWriter
+{
+    /* Encodes and writes each thread's entities in a background thread,
+     * so that finished threads are written while other event
+     * streams are still running */
+  public:
+    EntityGraphWriter(std::string path);
+    EntityGraphWriter(const EntityGraphWriter &) = delete;
+    EntityGraphWriter &operator=(const EntityGraphWriter &) = delete;
+    ~EntityGraphWriter();
+
+    auto write(TID tid, TContext &&tcxt) -> void;
+    /* The thread must have finished; its entities are released once written */
+
+    auto close(const std::vector<const std::string*> &names) -> void;
+    /* Write any queued threads, then the function names, indexed by function ID */
+
+    auto threads() const -> uint64_t { return threadCount; }
+    auto entities() const -> uint64_t { return entityCount; }
+    /* written so far; only read after close */
+
+  private:
+    auto run() -> void;
+    auto encode(TID tid, const TContext &tcxt) -> void;
+    auto writeBlock(const EntityBlockHeader &header) -> void;
+
+    template <typename T>
+    auto column(const std::vector<T> &values) -> void
+    {
+        const char *data = reinterpret_cast<const char*>(values.data());
+        buffer.insert(buffer.end(), data, data + values.size()*sizeof(T));
+    }
+
+    std::string path;
+    FILE *fp{nullptr};
+    std::vector<char> buffer;
+    /* the block being written */
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::pair<TID, TContext>> queue;
+    bool closing{false};
+    /* guarded by the mutex */
+
+    uint64_t threadCount{0};
+    uint64_t entityCount{0};
+    std::thread worker;
+};
+
+}; //end namespace SigilClassic
+
+#endif
@@ -1,8 +1,139 @@
 #include "Handler.hpp"
+#include "EntityGraph.hpp"
+#include "Core/SigiLog.hpp"
 
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+
+using namespace SigiLog; // console logging
 namespace SigilClassic
 {
 
+namespace
+{
+
+std::string outputPath{"."};
+std::unique_ptr<EntityGraphWriter> graphWriter;
+/* each thread is written as its event stream finishes */
+
+std::mutex gMtx;
+TContext unswapped;
+/* thread 0 of every event stream, i.e. the events before each
+ * stream's first thread switch, merged and written at exit */
+
+
+auto parseAll(const Args &args, const std::set<char> &options) -> std::map<char, std::string>
+{
+    std::map<char, std::string> matches;
+    for (auto arg = args.cbegin(); arg != args.cend(); ++arg)
+    {
+        if ((*arg).length() < 2 || (*arg)[0] != '-' || options.count((*arg)[1]) == 0)
+            fatal("unexpected sigilclassic option: " + *arg);
+
+        /* read before 'arg' moves on to the option's value */
+        char opt = (*arg)[1];
+        if ((*arg).length() > 2)
+            matches[opt] = (*arg).substr(2, std::string::npos);
+        else if (arg + 1 != args.cend())
+            matches[opt] = *(++arg);
+    }
+
+    return matches;
+}
+
+
+auto parseAggregation(std::string mode) -> Aggregation
+{
+    if (mode.empty() == true || mode == "call")
+        return Aggregation::Call;
+    else if (mode == "context")
+        return Aggregation::Context;
+
+    fatal("SigilClassic aggregation: expected 'call' or 'context'");
+}
+
+
+auto parseContextDepth(std::string depth) -> unsigned
+{
+    if (depth.empty() == true)
+        return defaultMaxContextDepth;
+
+    try
+    {
+        size_t pos = 0;
+        int ret = std::stoi(depth, &pos);
+        if (ret < 1 || pos != depth.length())
+            fatal("SigilClassic context depth: invalid argument");
+        return ret;
+    }
+    catch (std::invalid_argument &e)
+    {
+        fatal("SigilClassic context depth: invalid argument");
+    }
+    catch (std::out_of_range &e)
+    {
+        fatal("SigilClassic context depth: out_of_range");
+    }
+}
+
+}; //end namespace
+
+
+auto onParse(Args args) -> void
+{
+    /* only accept short options */
+    std::set<char> options;
+    options.insert('o'); // -o OUTPUT_DIRECTORY
+    options.insert('a'); // -a {call,context}
+    options.insert('d'); // -d MAX_CONTEXT_DEPTH
+    auto matches = parseAll(args, options);
+
+    if (matches['o'].empty() == false)
+        outputPath = matches['o'];
+
+    auto aggregation = parseAggregation(matches['a']);
+    if (aggregation != Aggregation::Context && matches['d'].empty() == false)
+        fatal("SigilClassic: -d only applies to '-a context'");
+
+    SigilContext::configure(aggregation, parseContextDepth(matches['d']));
+
+    /* only once every option is valid, so a bad option leaves no output behind */
+    graphWriter = std::make_unique<EntityGraphWriter>(outputPath + "/sigil.entities.out");
+}
+
+
+auto onExit() -> void
+{
+    /* Every event stream has finished, and written all but thread 0 */
+    graphWriter->write(0, std::move(unswapped));
+    graphWriter->close(SigilContext::functionNames());
+
+    SigiLog::info("SigilClassic: " + std::to_string(graphWriter->threads()) + " threads, " +
+                  std::to_string(graphWriter->entities()) + " entities written to " +
+                  outputPath + "/sigil.entities.out");
+    graphWriter.reset();
+}
+
+
+Handler::~Handler()
+{
+    for (auto &p : cxt.thread_contexts)
+    {
+        if (p.first != 0)
+        {
+            graphWriter->write(p.first, std::move(p.second));
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(gMtx);
+            unswapped.merge(std::move(p.second));
+        }
+    }
+}
+
+
 auto Handler::onSyncEv(const sigil2::SyncEvent &ev) -> void
 {
     /* save the current entity so that it can
@@ -7,9 +7,16 @@
 namespace SigilClassic
 {
 
+auto onParse(Args args) -> void;
+auto onExit() -> void;
+
 /* interface to Sigil2 */
 class Handler : public BackendIface
 {
+  public:
+    virtual ~Handler() override;
+
+  private:
     virtual auto onSyncEv(const sigil2::SyncEvent &ev) -> void override;
     virtual auto onCompEv(const sigil2::CompEvent &ev) -> void override;
     virtual auto onMemEv(const sigil2::MemEvent &ev) -> void override;
@@ -22,6 +22,14 @@ class SCShadowMemory
     auto isReaderFID(Addr addr, FID fid) -> bool;
     auto getWriterFID(Addr addr) -> FID;
 
+    /* Classify a read of [addr, addr+bytes) by 'fid'.
+     * Bytes that 'fid' wrote or last read are passed to 'local(count)';
+     * each run of other bytes with the same writer to 'remote(writer, count)'.
+     * Each secondary map is looked up once for the whole range, and a span
+     * with a single remote writer is passed on without a branch per byte */
+    template <typename Local, typename Remote>
+    auto classifyRead(Addr addr, ByteCount bytes, FID fid, Local local, Remote remote) -> void;
+
     struct ShadowObject
     {
         FID last_writer{SO_UNDEF}; // Last function to write to addr
@@ -33,25 +41,98 @@ class SCShadowMemory
 
 inline auto SCShadowMemory::updateWriter(Addr addr, ByteCount bytes, FID fid) -> void
 {
-    for (ByteCount i = 0; i < bytes; ++i)
+    Addr left = bytes;
+    while (left > 0)
     {
-        ShadowObject &so = sm[addr + i];
-        so.last_writer = fid;
-        so.last_reader = SO_UNDEF; // Reset readers on new write
+        auto span = sm.range(addr, left);
+        for (Addr i = 0; i < span.second; ++i)
+        {
+            span.first[i].last_writer = fid;
+            span.first[i].last_reader = SO_UNDEF; // Reset readers on new write
+        }
+        addr += span.second;
+        left -= span.second;
     }
 }
 
 
 inline auto SCShadowMemory::updateReader(Addr addr, ByteCount bytes, FID fid) -> void
 {
-    for (ByteCount i = 0; i < bytes; ++i)
+    Addr left = bytes;
+    while (left > 0)
     {
-        ShadowObject &so = sm[addr + i];
-        so.last_reader = fid;
+        auto span = sm.range(addr, left);
+        for (Addr i = 0; i < span.second; ++i)
+            span.first[i].last_reader = fid;
+        addr += span.second;
+        left -= span.second;
     }
 }
 
 
+template <typename Local, typename Remote>
+inline auto SCShadowMemory::classifyRead(Addr addr, ByteCount bytes, FID fid,
+                                         Local local, Remote remote) -> void
+{
+    ByteCount localBytes = 0;
+    FID runWriter = SO_UNDEF;
+    ByteCount runBytes = 0;
+
+    Addr left = bytes;
+    while (left > 0)
+    {
+        auto span = sm.range(addr, left);
+
+        /* fast path: the whole span was written by one other function,
+         * and none of it was last read by this one */
+        const FID writer = span.first[0].last_writer;
+        bool uniform = (writer != fid);
+        for (Addr i = 0; i < span.second; ++i)
+            uniform &= (span.first[i].last_writer == writer) & (span.first[i].last_reader != fid);
+
+        if (uniform == true)
+        {
+            if (writer != runWriter && runBytes > 0)
+            {
+                remote(runWriter, runBytes);
+                runBytes = 0;
+            }
+            runWriter = writer;
+            runBytes += span.second;
+        }
+        else
+        {
+            for (Addr i = 0; i < span.second; ++i)
+            {
+                const ShadowObject &so = span.first[i];
+                if/*local*/(so.last_writer == fid || so.last_reader == fid)
+                {
+                    ++localBytes;
+                }
+                else if/*same producer*/(so.last_writer == runWriter)
+                {
+                    ++runBytes;
+                }
+                else
+                {
+                    if (runBytes > 0)
+                        remote(runWriter, runBytes);
+                    runWriter = so.last_writer;
+                    runBytes = 1;
+                }
+            }
+        }
+        addr += span.second;
+        left -= span.second;
+    }
+
+    if (runBytes > 0)
+        remote(runWriter, runBytes);
+    if (localBytes > 0)
+        local(localBytes);
+}
+
+
 inline auto SCShadowMemory::isReaderFID(Addr addr, FID fid) -> bool
 {
     ShadowObject &so = sm[addr];
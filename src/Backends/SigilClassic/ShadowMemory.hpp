@@ -1,5 +1,5 @@
-#ifndef SHADOWMEMORY_H
-#define SHADOWMEMORY_H
+#ifndef SIGILCLASSIC_SHADOWMEMORY_H
+#define SIGILCLASSIC_SHADOWMEMORY_H
 
 #include "Core/Primitive.h" // PtrVal type
 #include "Core/SigiLog.hpp"
@@ -7,7 +7,10 @@
 #include <limits>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 
 /* Shadow Memory tracks 'shadow state' for an address.
  * For further clarification, please read,
@@ -19,12 +22,25 @@ using Addr = PtrVal;
 using SigiLog::fatal;
 using SigiLog::warn;
 
-/* XXX: Setting {addr, pm} bits too large can cause bad_alloc errors */
+namespace SigilClassic
+{
+
+/* XXX: Setting {addr - pm} bits too large can cause bad_alloc errors,
+ * because each touched secondary map covers 2^(addr - pm) addresses.
+ * The primary map is split into a directory of lazily allocated chunks,
+ * so a large PM_BITS costs little until the address space is touched.
+ *
+ * The shadow memory can be shared by multiple event streams.
+ * Chunks and secondary maps are published atomically, and only allocating
+ * a missing one takes a lock. Shadow objects themselves are not
+ * synchronized: streams that touch the same address concurrently
+ * have no defined order between them anyway. */
 template <typename SO, unsigned ADDR_BITS = 38, unsigned PM_BITS = 16>
 class ShadowMemory
 {
     static_assert(ADDR_BITS > 0 && ADDR_BITS < 64, "Invalid address range");
     static_assert(PM_BITS > 0, "Invalid offset for primary map");
+    static_assert(PM_BITS < ADDR_BITS, "Primary map must leave bits for the secondary maps");
     static_assert(sizeof(Addr)*CHAR_BIT >= ADDR_BITS, "Max address is too large for the platform");
 
   public:
@@ -34,7 +50,10 @@ class ShadowMemory
         , sm_bits(addr_bits - pm_bits)
         , pm_size(1ULL << pm_bits)
         , sm_size(1ULL << sm_bits)
-        , pm(pm_size)
+        , chunk_bits(pm_bits / 2)
+        , chunk_size(1ULL << chunk_bits)
+        , pm(new Slot<Slot<SecondaryMap>>[1ULL << (pm_bits - chunk_bits)]())
+        , instance(nextInstance())
     {}
     ShadowMemory(const ShadowMemory &) = delete;
     ShadowMemory &operator=(const ShadowMemory &) = delete;
@@ -45,20 +64,28 @@ class ShadowMemory
     const Addr sm_bits;
     const Addr pm_size;
     const Addr sm_size;
+    const Addr chunk_bits;
+    const Addr chunk_size;
 
     /* Implementation */
     using SecondaryMap = std::vector<SO>;
-    using PrimaryMap = std::vector<std::unique_ptr<SecondaryMap>>;
+    template <typename T>
+    using Slot = std::atomic<T*>;
 
     auto operator[](Addr addr) -> SO&
     {
         if ((addr >> addr_bits) == 0)
         {
-            auto &ptr = pm[addr >> sm_bits]; /* PM offset */
-            if (ptr == nullptr)
-                ptr = std::make_unique<SecondaryMap>(sm_size);
+            /* Most accesses fall in the same secondary map
+             * as this thread's last access */
+            struct LastMap { uint64_t instance; Addr pmIdx; SecondaryMap *sm; };
+            static thread_local LastMap last{0, 0, nullptr};
 
-            return (*ptr)[addr & ((1ULL << sm_bits) - 1)]; /* SM offset */
+            Addr pmIdx = addr >> sm_bits; /* PM offset */
+            if (last.instance != instance || last.pmIdx != pmIdx)
+                last = {instance, pmIdx, &secondary(pmIdx)};
+
+            return (*last.sm)[addr & ((1ULL << sm_bits) - 1)]; /* SM offset */
         }
         else
         {
@@ -74,9 +101,70 @@ class ShadowMemory
         }
     }
 
+    /* The shadow objects for [addr, addr+bytes), up to the end of addr's
+     * secondary map, with a single lookup. Returns the first object and
+     * how many follow it contiguously; the caller continues from there */
+    auto range(Addr addr, Addr bytes) -> std::pair<SO*, Addr>
+    {
+        SO *first = &(*this)[addr];
+        Addr left = sm_size - (addr & ((1ULL << sm_bits) - 1));
+        return {first, bytes < left ? bytes : left};
+    }
+
   private:
-    PrimaryMap pm;
+    static auto nextInstance() -> uint64_t
+    {
+        static std::atomic<uint64_t> instances{0};
+        return ++instances;
+    }
+
+    auto secondary(Addr pmIdx) -> SecondaryMap&
+    {
+        auto *chunk = pm[pmIdx >> chunk_bits].load(std::memory_order_acquire);
+        if (chunk != nullptr)
+        {
+            auto *sm = chunk[pmIdx & (chunk_size - 1)].load(std::memory_order_acquire);
+            if (sm != nullptr)
+                return *sm;
+        }
+
+        return allocate(pmIdx);
+    }
+
+    auto allocate(Addr pmIdx) -> SecondaryMap&
+    {
+        std::lock_guard<std::mutex> lock(allocMtx);
 
+        auto &chunkSlot = pm[pmIdx >> chunk_bits];
+        auto *chunk = chunkSlot.load(std::memory_order_relaxed);
+        if (chunk == nullptr)
+        {
+            chunks.emplace_back(new Slot<SecondaryMap>[chunk_size]());
+            chunk = chunks.back().get();
+            chunkSlot.store(chunk, std::memory_order_release);
+        }
+
+        auto &smSlot = chunk[pmIdx & (chunk_size - 1)];
+        auto *sm = smSlot.load(std::memory_order_relaxed);
+        if (sm == nullptr)
+        {
+            sms.push_back(std::make_unique<SecondaryMap>(sm_size));
+            sm = sms.back().get();
+            smSlot.store(sm, std::memory_order_release);
+        }
+
+        return *sm;
+    }
+
+    std::unique_ptr<Slot<Slot<SecondaryMap>>[]> pm;
+    const uint64_t instance;
+
+    std::mutex allocMtx;
+    std::vector<std::unique_ptr<Slot<SecondaryMap>[]>> chunks;
+    std::vector<std::unique_ptr<SecondaryMap>> sms;
+    /* owned here, guarded by the mutex; the slots above only point into them */
 };
 
+}; //end namespace SigilClassic
+
 #endif
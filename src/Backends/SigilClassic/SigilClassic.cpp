@@ -1,36 +1,69 @@
 #include "SigilClassic.hpp"
 #include "Core/SigiLog.hpp"
 
-/* XXX overflow builtin not in GCC <5.
- * This overflow check should only be used for
- * variables which increment by 1 each time. */
-#if __GNUC__ >= 5
-#define INCR_EID_OVERFLOW(var) __builtin_add_overflow(var, 1, &var)
-#else
-#define INCR_EID_OVERFLOW(var) (var == INT_MAX ? true : (var += 1) && false)
-#endif
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <unordered_set>
 
 
 namespace SigilClassic
 {
 
+SCShadowMemory SigilContext::sm;
 
-SigilContext::SigilContext()
+namespace
 {
-    setThreadContext(0);
-    enterEntity("__BEGINNING_OF_SIGIL__");
+Aggregation aggregation{Aggregation::Call};
+unsigned maxContextDepth{defaultMaxContextDepth};
+
+/* Global to all event streams */
+std::atomic<EID> global_eid_cnt{INVL_EID};
+std::mutex gMtx;
+std::unordered_map<std::string, FnID> interned;
+std::unordered_set<TID> seenThreads;
+}; //end namespace
+
+
+auto SigilContext::configure(Aggregation mode, unsigned maxDepth) -> void
+{
+    aggregation = mode;
+    maxContextDepth = maxDepth;
 }
 
-SigilContext::~SigilContext()
+
+auto SigilContext::functionNames() -> std::vector<const std::string*>
 {
-    /* TODO Print out stats */
+    std::lock_guard<std::mutex> lock(gMtx);
+    std::vector<const std::string*> names(interned.size());
+    for (auto &p : interned)
+        names[p.second] = &p.first;
+    return names;
+}
+
+
+SigilContext::SigilContext()
+{
+    setThreadContext(0);
+    enterEntity("__BEGINNING_OF_SIGIL__");
 }
 
 auto SigilContext::setThreadContext(TID tid) -> void
 {
     if(cur_tid != tid)
     {
-        cur_tcxt = &thread_contexts[tid];
+        auto it = thread_contexts.find(tid);
+        if (it == thread_contexts.end())
+        {
+            /* Thread 0 holds the events of each stream before
+             * its first thread switch, so every stream has one */
+            std::lock_guard<std::mutex> lock(gMtx);
+            if (tid != 0 && seenThreads.insert(tid).second == false)
+                SigiLog::fatal("SigilClassic thread " + std::to_string(tid) +
+                               " seen in multiple event streams");
+            it = thread_contexts.emplace(tid, TContext{}).first;
+        }
+        cur_tcxt = &it->second;
 
         cur_eid         = &cur_tcxt->cur_eid;
         cur_entity_ids  = &cur_tcxt->entity_ids;
@@ -43,58 +76,130 @@ auto SigilContext::setThreadContext(TID tid) -> void
 }
 
 
-auto SigilContext::enterEntity(std::string name) -> void
+auto SigilContext::enterEntity(const std::string &name) -> void
 {
-    /* Initialize new metadata in map, and set name */
+    *cur_eid = (aggregation == Aggregation::Context) ? enterContext(name) : enterCall(name);
+    cur_callstack->push(*cur_eid);
+}
 
-    /* count is not bounded, error if too many functions */
-    if(INCR_EID_OVERFLOW(global_eid_cnt))
-        SigiLog::fatal("SigilClassic detected overflow in entity count");
 
-    EID caller = *cur_eid;
-    *cur_eid = global_eid_cnt;
+auto SigilContext::exitEntity() -> void
+{
+    /* a thread can be swapped in partway through a function */
+    if (cur_callstack->empty() == true)
+        return;
+
+    cur_callstack->pop();
+    *cur_eid   = cur_callstack->empty() ? INVL_EID : cur_callstack->top();
+    cur_entity = &(*cur_entity_data)[*cur_eid];
+}
 
-    auto it = cur_entity_ids->emplace(name, *cur_eid);
-    auto p  = cur_entity_data->emplace(*cur_eid, EntityData{});
 
+auto SigilContext::function(const std::string &name) -> Function
+{
+    auto it = fn_ids.find(name);
+    if (it != fn_ids.end())
+        return it->second;
+
+    std::lock_guard<std::mutex> lock(gMtx);
+    auto fn = interned.emplace(name, static_cast<FnID>(interned.size())).first;
+    return fn_ids.emplace(name, Function{fn->second, &fn->first}).first->second;
+}
+
+
+auto SigilContext::newEntity(EID caller) -> EID
+{
+    /* count is not bounded, error if too many functions */
+    EID eid = global_eid_cnt.fetch_add(1, std::memory_order_relaxed);
+    if (eid == std::numeric_limits<EID>::max())
+        SigiLog::fatal("SigilClassic detected overflow in entity count");
+    ++eid;
+
+    auto p = cur_entity_data->emplace(eid, EntityData{});
     cur_entity         = &p.first->second;
-    cur_entity->name   = &it->first;
     cur_entity->caller = caller;
 
-    cur_callstack->push(*cur_eid);
+    return eid;
 }
 
 
-auto SigilContext::exitEntity() -> void
+auto SigilContext::enterCall(const std::string &name) -> EID
 {
-    cur_callstack->pop();
-    *cur_eid = cur_callstack->top();
+    /* Initialize new metadata in map, and set name */
+    auto fn = function(name);
+    EID eid = newEntity(*cur_eid);
+    cur_entity_ids->emplace(fn.first, eid);
+    cur_entity->name = fn.second;
+    cur_entity->fn   = fn.first;
+
+    return eid;
 }
 
 
-auto SigilContext::monitorWrite(Addr addr, ByteCount bytes) -> void
+auto SigilContext::enterContext(const std::string &name) -> EID
 {
-    for(int i = 0; i < bytes; ++i)
+    /* Reuse the entity of this function under the current context,
+     * or grow the calling context tree by one node */
+    EID parent = *cur_eid;
+    if (cur_callstack->size() >= maxContextDepth)
+        return parent;
+
+    auto fn = function(name);
+    uint64_t key = (static_cast<uint64_t>(static_cast<UInt>(parent)) << 32) | fn.first;
+    auto child = cur_tcxt->cct_children.emplace(key, INVL_EID);
+    if (child.second == true)
+    {
+        child.first->second = newEntity(parent);
+        cur_entity->name = fn.second;
+        cur_entity->fn   = fn.first;
+    }
+    else
     {
-        auto cur_addr = addr + i;
-        sm.updateWriter(cur_addr, 1, *cur_eid);
+        cur_entity = &(*cur_entity_data)[child.first->second];
     }
+
+    return child.first->second;
 }
 
 
-auto SigilContext::monitorRead(Addr addr, ByteCount bytes) -> void
+auto TContext::merge(TContext &&other) -> void
 {
-    for(int i = 0; i < bytes; ++i)
+    for (auto &p : other.entity_data)
     {
-        auto cur_addr = addr + i;
-        auto writer = sm.getWriterFID(cur_addr);
-
-        if/*local*/((writer == *cur_eid) ||
-                    sm.isReaderFID(cur_addr, *cur_eid))
-            cur_entity->local_bytes_read++;
-        else/*unique*/
-            cur_entity->comm_edges[writer]++;
+        auto it = entity_data.find(p.first);
+        if (it == entity_data.end())
+        {
+            entity_data.emplace(p.first, std::move(p.second));
+            continue;
+        }
+
+        EntityData &data = it->second;
+        p.second.comm_edges.forEach([&](EID producer, UInt bytes)
+                                    { data.comm_edges.add(producer, bytes); });
+        data.local_bytes_read += p.second.local_bytes_read;
+        data.iops += p.second.iops;
+        data.flops += p.second.flops;
     }
+
+    entity_ids.insert(other.entity_ids.begin(), other.entity_ids.end());
+    cct_children.insert(other.cct_children.begin(), other.cct_children.end());
+    other = TContext{};
+}
+
+
+auto SigilContext::monitorWrite(Addr addr, ByteCount bytes) -> void
+{
+    sm.updateWriter(addr, bytes, *cur_eid);
+}
+
+
+auto SigilContext::monitorRead(Addr addr, ByteCount bytes) -> void
+{
+    /* bytes from the same producer are counted together */
+    EntityData *entity = cur_entity;
+    sm.classifyRead(addr, bytes, *cur_eid,
+                    [entity](ByteCount local){ entity->local_bytes_read += local; },
+                    [entity](FID writer, ByteCount unique){ entity->comm_edges.add(writer, unique); });
 }
 
 
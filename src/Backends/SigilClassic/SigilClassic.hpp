@@ -5,8 +5,11 @@
 #include <stack>
 #include <string>
 #include <cstdint>
+#include <limits>
+#include <vector>
 
 #include "SCShadowMemory.hpp"
+#include "CommEdges.hpp"
 #include "Core/Primitive.h"
 
 namespace SigilClassic
@@ -26,6 +29,21 @@ constexpr EID INVL_EID{-1};
 using TID = Int;
 constexpr TID INVL_TID{-1};
 
+/* Interned function name */
+using FnID = UInt;
+constexpr FnID INVL_FN{std::numeric_limits<FnID>::max()};
+
+
+/* How function calls are grouped into entities.
+ * 'Call' creates a new entity for every function call.
+ * 'Context' creates one entity per calling context, i.e. per distinct path
+ * of functions from the start of the thread, so that memory grows with the
+ * number of contexts instead of the number of calls. */
+enum class Aggregation { Call, Context };
+
+/* Calls deeper than this share the entity of the context at the limit */
+constexpr unsigned defaultMaxContextDepth{64};
+
 
 /* Keeps track of entity metadata */
 struct EntityData
@@ -33,9 +51,10 @@ struct EntityData
     /* The same function name may be called many times.
      * Save some space by pointing to the name */
     const std::string *name{nullptr};
+    FnID fn{INVL_FN};
 
     /* Unique communication between entities */
-    std::unordered_map<EID, UInt> comm_edges;
+    CommEdges comm_edges;
 
     /* Bytes read, that are written by this same entity */
     UInt local_bytes_read{0};
@@ -52,17 +71,30 @@ struct EntityData
 /* Keeps track of state between thread context switches */
 struct TContext
 {
-    std::unordered_multimap<std::string, EID> entity_ids;
+    /* Fold another stream's context for the same thread into this one.
+     * Entity IDs are unique across streams, so only the entity outside
+     * of any function (INVL_EID) needs its costs added */
+    auto merge(TContext &&other) -> void;
+
+    std::unordered_multimap<FnID, EID> entity_ids;
     std::unordered_map<EID, EntityData> entity_data;
     std::stack<EID> callstack;
     EID cur_eid{INVL_EID};
+
+    /* Calling context tree, (parent entity, function) -> entity.
+     * Only populated when aggregating by calling context */
+    std::unordered_map<uint64_t, EID> cct_children;
 };
 
 
 struct SigilContext
 {
     SigilContext();
-    ~SigilContext();
+
+    static auto configure(Aggregation mode, unsigned maxDepth) -> void;
+
+    /* Every function name interned so far, indexed by FnID */
+    static auto functionNames() -> std::vector<const std::string*>;
 
     /* Reset all the contexts to that of 'tid'.
      * Necessary because an entity (e.g. function) can be
@@ -71,7 +103,7 @@ struct SigilContext
 
     /* Beginning or end marker of a entity.
      * Creates or destroys new metadata for the entity */
-    auto enterEntity(std::string name) -> void;
+    auto enterEntity(const std::string &name) -> void;
     auto exitEntity() -> void;
 
     auto monitorWrite(Addr addr, ByteCount bytes) -> void;
@@ -80,11 +112,20 @@ struct SigilContext
     auto incrFLOPCost() -> void;
 
 
-    SCShadowMemory sm;
+    /* Shared by every event stream, so that communication between
+     * entities seen by different streams is detected */
+    static SCShadowMemory sm;
+
+    /* Only the threads seen by this event stream */
     std::unordered_map<TID, TContext> thread_contexts;
 
+    /* Function names are interned once for all event streams,
+     * regardless of how often they are called.
+     * Each stream caches the names it has seen */
+    using Function = std::pair<FnID, const std::string*>;
+    std::unordered_map<std::string, Function> fn_ids;
+
     TID cur_tid{INVL_TID};
-    EID global_eid_cnt{INVL_EID};
     TContext *cur_tcxt;
 
     /* cache tcontext */
@@ -93,6 +134,12 @@ struct SigilContext
     decltype(TContext::entity_data) *cur_entity_data{nullptr};
     decltype(TContext::callstack)   *cur_callstack{nullptr};
     EntityData *cur_entity{nullptr};
+
+  private:
+    auto function(const std::string &name) -> Function;
+    auto newEntity(EID caller) -> EID;
+    auto enterCall(const std::string &name) -> EID;
+    auto enterContext(const std::string &name) -> EID;
 };
 
 
@@ -0,0 +1,158 @@
+#!/bin/python
+
+# Folds the per-call (or per-context) entities of a SigilClassic
+# sigil.entities.out into one summary per function, using a process per core.
+#
+# usage: sigilclassic_aggregator.py sigil.entities.out [WORKERS]
+#
+# Writes two CSV tables to stdout:
+#   function,entities,iops,flops,localBytes
+#   consumer,producer,bytes
+# where communication is summed over every entity of each function.
+
+import sys
+import os
+import struct
+import array
+from multiprocessing import Pool
+
+# See EntityGraph.hpp for the layout
+header = struct.Struct('=8sHHI')
+block = struct.Struct('=IiIIQ')
+THREAD, NAMES = range(2)
+INVL_FN = 0xFFFFFFFF
+
+# Set in each worker by init(), so workers do not rely on
+# inheriting the parent's globals through fork
+path = None
+
+
+def init(tracePath):
+    global path
+    path = tracePath
+
+
+def column(data, offset, typecode, count):
+    values = array.array(typecode)
+    values.frombytes(data[offset:offset + count * values.itemsize])
+    return values, offset + count * values.itemsize
+
+
+def readBlock(offset, blockBytes):
+    with open(path, 'rb') as f:
+        f.seek(offset)
+        return f.read(blockBytes)
+
+
+def scan():
+    # Block offsets, and the function names; columns are only read by workers
+    blocks, names = [], []
+    with open(path, 'rb') as f:
+        magic, version, byteOrder, _ = header.unpack(f.read(header.size))
+        if magic != b'SGLCLENT' or byteOrder != 0x0102:
+            raise Exception('not an entity graph, or written with another byte order')
+        while True:
+            raw = f.read(block.size)
+            if not raw:
+                break
+            which, tid, entities, edges, blockBytes = block.unpack(raw)
+            offset = f.tell()
+            if which == THREAD:
+                blocks.append((offset, blockBytes, entities, edges))
+                f.seek(blockBytes, os.SEEK_CUR)
+            elif which == NAMES:
+                data = f.read(blockBytes)
+                nameEnd, pos = column(data, 0, 'I', entities)
+                start = 0
+                for end in nameEnd:
+                    names.append(data[pos + start:pos + end].decode('utf-8', 'replace'))
+                    start = end
+    return blocks, names
+
+
+def functions(b):
+    # Phase 1: entity ID -> function ID, for every entity in a block,
+    # and the distinct producers the block's edges refer to
+    offset, blockBytes, entities, edges = b
+    data = readBlock(offset, blockBytes)
+    eid, pos = column(data, 0, 'i', entities)
+    function, pos = column(data, pos, 'I', entities)
+    producer, _ = column(data, 7 * 4 * entities, 'i', edges)
+    return b, eid, function, array.array('i', sorted(set(producer)))
+
+
+def fold(task):
+    # Phase 2: per-function costs and communication for a block.
+    # 'producerFunction' only holds the producers this block refers to
+    b, producerFunction = task
+    offset, blockBytes, entities, edges = b
+    data = readBlock(offset, blockBytes)
+    pos = 0
+    eid, pos = column(data, pos, 'i', entities)
+    function, pos = column(data, pos, 'I', entities)
+    caller, pos = column(data, pos, 'i', entities)
+    iops, pos = column(data, pos, 'I', entities)
+    flops, pos = column(data, pos, 'I', entities)
+    localBytes, pos = column(data, pos, 'I', entities)
+    edgeEnd, pos = column(data, pos, 'I', entities)
+    producer, pos = column(data, pos, 'i', edges)
+    edgeBytes, pos = column(data, pos, 'I', edges)
+
+    costs, comm = {}, {}
+    start = 0
+    for i in range(entities):
+        fn = function[i]
+        c = costs.setdefault(fn, [0, 0, 0, 0])
+        c[0] += 1
+        c[1] += iops[i]
+        c[2] += flops[i]
+        c[3] += localBytes[i]
+        for e in range(start, edgeEnd[i]):
+            key = (fn, producerFunction[producer[e]])
+            comm[key] = comm.get(key, 0) + edgeBytes[e]
+        start = edgeEnd[i]
+    return costs, comm
+
+
+def main():
+    tracePath = sys.argv[1]
+    workers = int(sys.argv[2]) if len(sys.argv) > 2 else os.cpu_count()
+
+    init(tracePath)
+    blocks, names = scan()
+    # largest blocks first, so one big thread does not finish last
+    blocks.sort(key=lambda b: b[1], reverse=True)
+
+    costs, comm = {}, {}
+    with Pool(workers, initializer=init, initargs=(tracePath,)) as pool:
+        functionOf, producersOf = {}, {}
+        for b, eid, function, producers in pool.imap_unordered(functions, blocks):
+            functionOf.update(zip(eid, function))
+            producersOf[b] = producers
+
+        # each block is sent only the functions of its own producers,
+        # instead of every worker getting the whole map
+        tasks = ((b, {p: functionOf.get(p, INVL_FN) for p in producersOf[b]})
+                 for b in blocks)
+        for blockCosts, blockComm in pool.imap_unordered(fold, tasks):
+            for fn, c in blockCosts.items():
+                total = costs.setdefault(fn, [0, 0, 0, 0])
+                for i in range(4):
+                    total[i] += c[i]
+            for key, b in blockComm.items():
+                comm[key] = comm.get(key, 0) + b
+
+    def name(fn):
+        return names[fn] if fn < len(names) else '(none)'
+
+    out = sys.stdout
+    out.write('function,entities,iops,flops,localBytes\n')
+    for fn, c in sorted(costs.items(), key=lambda x: name(x[0])):
+        out.write('%s,%d,%d,%d,%d\n' % (name(fn), c[0], c[1], c[2], c[3]))
+    out.write('\nconsumer,producer,bytes\n')
+    for (consumer, producer), b in sorted(comm.items(), key=lambda x: -x[1]):
+        out.write('%s,%s,%d\n' % (name(consumer), name(producer), b))
+
+
+if __name__ == '__main__':
+    main()
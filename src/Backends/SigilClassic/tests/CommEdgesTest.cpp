@@ -0,0 +1,117 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <map>
+
+#include "SigilClassic/CommEdges.hpp"
+
+using SigilClassic::CommEdges;
+using SigilClassic::Int;
+using SigilClassic::UInt;
+using SigilClassic::SO_UNDEF;
+
+namespace
+{
+
+auto edges(const CommEdges &comm) -> std::map<Int, UInt>
+{
+    /* each producer should be visited exactly once */
+    std::map<Int, UInt> ret;
+    comm.forEach([&](Int producer, UInt bytes)
+    {
+        REQUIRE(ret.count(producer) == 0);
+        ret[producer] = bytes;
+    });
+    REQUIRE(ret.size() == comm.size());
+    return ret;
+}
+
+}; //end namespace
+
+
+TEST_CASE("the first edges are kept inline", "[CommEdgesInline]")
+{
+    CommEdges comm;
+    REQUIRE(comm.size() == 0);
+    REQUIRE(edges(comm).empty() == true);
+
+    comm.add(5, 10);
+    comm.add(7, 1);
+    comm.add(5, 3);
+    comm.add(9, 4);
+    REQUIRE(edges(comm) == (std::map<Int, UInt>{{5, 13}, {7, 1}, {9, 4}}));
+
+    SECTION("a fourth producer moves the edges to the table")
+    {
+        comm.add(11, 2);
+        comm.add(7, 6);
+        REQUIRE(edges(comm) == (std::map<Int, UInt>{{5, 13}, {7, 7}, {9, 4}, {11, 2}}));
+    }
+}
+
+
+TEST_CASE("reads of unwritten bytes are an edge from producer -1", "[CommEdgesUndef]")
+{
+    /* -1 must not be mistaken for an empty slot, inline or in the table */
+    CommEdges comm;
+    comm.add(SO_UNDEF, 8);
+    comm.add(SO_UNDEF, 8);
+    REQUIRE(edges(comm) == (std::map<Int, UInt>{{SO_UNDEF, 16}}));
+
+    for (Int producer = 0; producer < 100; ++producer)
+        comm.add(producer, 1);
+    comm.add(SO_UNDEF, 4);
+
+    auto got = edges(comm);
+    REQUIRE(got.size() == 101);
+    REQUIRE(got[SO_UNDEF] == 20);
+}
+
+
+TEST_CASE("edges survive the table growing", "[CommEdgesRehash]")
+{
+    srand(time(NULL));
+
+    SECTION("many producers")
+    {
+        CommEdges comm;
+        std::map<Int, UInt> expected;
+        for (Int producer = -1; producer < 5000; ++producer)
+        {
+            comm.add(producer, producer + 2);
+            expected[producer] += producer + 2;
+        }
+        REQUIRE(edges(comm) == expected);
+    }
+
+    SECTION("random producers match a map")
+    {
+        CommEdges comm;
+        std::map<Int, UInt> expected;
+        for (int i = 0; i < 200000; ++i)
+        {
+            /* a few hot producers, and a long tail */
+            Int producer = (rand() % 4 == 0) ? rand() % 4 - 1 : rand() % 20000 - 1;
+            UInt bytes = rand() % 64 + 1;
+            comm.add(producer, bytes);
+            expected[producer] += bytes;
+        }
+        REQUIRE(edges(comm) == expected);
+    }
+
+    SECTION("producers with equal low bits")
+    {
+        /* IDs that differ only in their high bits */
+        CommEdges comm;
+        std::map<Int, UInt> expected;
+        for (Int i = 0; i < 64; ++i)
+        {
+            comm.add(i << 24, 1);
+            comm.add(i << 24, 2);
+            expected[i << 24] += 3;
+        }
+        REQUIRE(edges(comm) == expected);
+    }
+}
@@ -0,0 +1,194 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "SigilClassic/EntityGraph.hpp"
+
+using namespace SigilClassic;
+
+namespace
+{
+
+struct Entity
+{
+    /* an entity as it should read back */
+    EID eid;
+    FnID fn;
+    EID caller;
+    UInt iops, flops, localBytes;
+    std::map<Int, UInt> edges;
+};
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.entities.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    std::ifstream in(path, std::ios::binary);
+    REQUIRE(in.good() == true);
+    std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    unlink(path.c_str());
+    return data;
+}
+
+template <typename T>
+auto columnAt(const std::string &data, size_t offset, size_t count) -> std::vector<T>
+{
+    REQUIRE(offset + count*sizeof(T) <= data.size());
+    std::vector<T> values(count);
+    memcpy(values.data(), data.data() + offset, count*sizeof(T));
+    return values;
+}
+
+auto makeContext(const std::vector<Entity> &entities) -> TContext
+{
+    TContext tcxt;
+    for (auto &e : entities)
+    {
+        EntityData &data = tcxt.entity_data[e.eid];
+        data.fn = e.fn;
+        data.caller = e.caller;
+        data.iops = e.iops;
+        data.flops = e.flops;
+        data.local_bytes_read = e.localBytes;
+        for (auto &edge : e.edges)
+            data.comm_edges.add(edge.first, edge.second);
+    }
+    return tcxt;
+}
+
+auto checkThread(const std::string &data, size_t &pos, TID tid, std::vector<Entity> expected) -> void
+{
+    /* entities are written sorted by ID; edges in any order */
+    std::sort(expected.begin(), expected.end(),
+              [](const Entity &a, const Entity &b){ return a.eid < b.eid; });
+    size_t edges = 0;
+    for (auto &e : expected)
+        edges += e.edges.size();
+
+    REQUIRE(pos + sizeof(EntityBlockHeader) <= data.size());
+    EntityBlockHeader block;
+    memcpy(&block, data.data() + pos, sizeof(block));
+    pos += sizeof(block);
+    REQUIRE(block.type == EntityBlockHeader::THREAD);
+    REQUIRE(block.tid == tid);
+    REQUIRE(block.entities == expected.size());
+    REQUIRE(block.edges == edges);
+
+    /* seven 4-byte columns per entity, then two per edge */
+    const size_t n = expected.size();
+    REQUIRE(block.blockBytes == 7*4*n + 2*4*edges);
+    auto eid        = columnAt<int32_t>(data, pos, n);
+    auto function   = columnAt<uint32_t>(data, pos + 4*n, n);
+    auto caller     = columnAt<int32_t>(data, pos + 8*n, n);
+    auto iops       = columnAt<uint32_t>(data, pos + 12*n, n);
+    auto flops      = columnAt<uint32_t>(data, pos + 16*n, n);
+    auto localBytes = columnAt<uint32_t>(data, pos + 20*n, n);
+    auto edgeEnd    = columnAt<uint32_t>(data, pos + 24*n, n);
+    auto producer   = columnAt<int32_t>(data, pos + 28*n, edges);
+    auto bytes      = columnAt<uint32_t>(data, pos + 28*n + 4*edges, edges);
+    pos += block.blockBytes;
+
+    uint32_t start = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        REQUIRE(eid[i] == expected[i].eid);
+        REQUIRE(function[i] == expected[i].fn);
+        REQUIRE(caller[i] == expected[i].caller);
+        REQUIRE(iops[i] == expected[i].iops);
+        REQUIRE(flops[i] == expected[i].flops);
+        REQUIRE(localBytes[i] == expected[i].localBytes);
+
+        REQUIRE(edgeEnd[i] >= start);
+        REQUIRE(edgeEnd[i] <= edges);
+        std::map<Int, UInt> got;
+        for (uint32_t e = start; e < edgeEnd[i]; ++e)
+            got[producer[e]] += bytes[e];
+        REQUIRE(got.size() == edgeEnd[i] - start);
+        REQUIRE(got == expected[i].edges);
+        start = edgeEnd[i];
+    }
+    REQUIRE(start == edges);
+}
+
+}; //end namespace
+
+
+TEST_CASE("entity graphs read back column by column", "[EntityGraph]")
+{
+    std::vector<Entity> thread1 = {
+        {INVL_EID, INVL_FN, INVL_EID, 5, 0, 0, {}},
+        {7, 1, 2, 100, 3, 64, {{INVL_EID, 16}, {2, 8}}},
+        {2, 0, INVL_EID, 10, 1, 0, {{3, 4}, {4, 4}, {5, 4}, {6, 4}, {INVL_EID, 1}}},
+        {3, 2, 2, 0, 0, 8, {}},
+    };
+    std::vector<Entity> thread2 = {
+        {INVL_EID, INVL_FN, INVL_EID, 0, 0, 0, {{7, 12}}},
+        {20, 2, INVL_EID, 1, 1, 1, {{3, 100}, {7, 200}, {20, 300}}},
+    };
+    std::vector<Entity> thread3 = {};
+
+    std::string names[] = {"main", "foo", "bar::baz(int)"};
+    std::vector<const std::string*> namePtrs = {&names[0], &names[1], &names[2]};
+
+    auto path = tempPath();
+    {
+        EntityGraphWriter writer(path);
+        writer.write(1, makeContext(thread1));
+        writer.write(2, makeContext(thread2));
+        writer.write(3, makeContext(thread3));
+        writer.close(namePtrs);
+        REQUIRE(writer.threads() == 3);
+        REQUIRE(writer.entities() == thread1.size() + thread2.size());
+    }
+    auto data = readBack(path);
+
+    REQUIRE(data.size() >= sizeof(EntityGraphHeader));
+    EntityGraphHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    REQUIRE(std::string(header.magic, sizeof(header.magic)) == "SGLCLENT");
+    REQUIRE(header.version == entityGraphVersion);
+    REQUIRE(header.byteOrder == 0x0102);
+
+    /* one writer thread, so blocks are in the order written */
+    size_t pos = sizeof(header);
+    checkThread(data, pos, 1, thread1);
+    checkThread(data, pos, 2, thread2);
+    checkThread(data, pos, 3, thread3);
+
+    /* the NAMES block is last */
+    REQUIRE(pos + sizeof(EntityBlockHeader) <= data.size());
+    EntityBlockHeader block;
+    memcpy(&block, data.data() + pos, sizeof(block));
+    pos += sizeof(block);
+    REQUIRE(block.type == EntityBlockHeader::NAMES);
+    REQUIRE(block.tid == -1);
+    REQUIRE(block.entities == 3);
+    REQUIRE(block.edges == names[0].size() + names[1].size() + names[2].size());
+    REQUIRE(block.blockBytes == 4*block.entities + block.edges);
+
+    auto nameEnd = columnAt<uint32_t>(data, pos, block.entities);
+    const char *text = data.data() + pos + 4*block.entities;
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < block.entities; ++i)
+    {
+        REQUIRE(std::string(text + start, nameEnd[i] - start) == names[i]);
+        start = nameEnd[i];
+    }
+    REQUIRE(pos + block.blockBytes == data.size());
+}
@@ -0,0 +1,193 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SigilClassic/SCShadowMemory.hpp"
+
+using SigilClassic::SCShadowMemory;
+using SigilClassic::FID;
+using SigilClassic::SO_UNDEF;
+
+namespace
+{
+
+using Runs = std::vector<std::pair<FID, ByteCount>>;
+/* remote runs of a read, in order */
+
+struct Classified
+{
+    ByteCount local{0};
+    Runs remote;
+};
+
+auto classify(SCShadowMemory &sm, Addr addr, ByteCount bytes, FID fid) -> Classified
+{
+    Classified ret;
+    unsigned localCalls = 0;
+    sm.classifyRead(addr, bytes, fid,
+                    [&](ByteCount local){ ret.local += local; ++localCalls; },
+                    [&](FID writer, ByteCount count){ ret.remote.emplace_back(writer, count); });
+    REQUIRE(localCalls <= 1);
+    return ret;
+}
+
+class Reference
+{
+    /* the same state as the shadow memory, one byte at a time */
+  public:
+    auto write(Addr addr, ByteCount bytes, FID fid) -> void
+    {
+        for (Addr i = 0; i < bytes; ++i)
+            objs[addr + i] = {fid, SO_UNDEF};
+    }
+
+    auto read(Addr addr, ByteCount bytes, FID fid) -> void
+    {
+        for (Addr i = 0; i < bytes; ++i)
+            objs.emplace(addr + i, std::make_pair(SO_UNDEF, SO_UNDEF)).first->second.second = fid;
+    }
+
+    auto classify(Addr addr, ByteCount bytes, FID fid) -> Classified
+    {
+        /* Local bytes do not end a run of remote bytes,
+         * and bytes that were never written have the writer SO_UNDEF */
+        Classified ret;
+        FID runWriter = SO_UNDEF;
+        ByteCount runBytes = 0;
+        for (Addr i = 0; i < bytes; ++i)
+        {
+            auto it = objs.find(addr + i);
+            auto so = (it == objs.end()) ? std::make_pair(SO_UNDEF, SO_UNDEF) : it->second;
+            if (so.first == fid || so.second == fid)
+            {
+                ++ret.local;
+            }
+            else if (so.first == runWriter)
+            {
+                ++runBytes;
+            }
+            else
+            {
+                if (runBytes > 0)
+                    ret.remote.emplace_back(runWriter, runBytes);
+                runWriter = so.first;
+                runBytes = 1;
+            }
+        }
+        if (runBytes > 0)
+            ret.remote.emplace_back(runWriter, runBytes);
+        return ret;
+    }
+
+  private:
+    std::unordered_map<Addr, std::pair<FID, FID>> objs;
+    /* last writer, last reader */
+};
+
+}; //end namespace
+
+
+TEST_CASE("reads are split into local bytes and remote runs", "[ClassifyRead]")
+{
+    SCShadowMemory sm;
+    const Addr boundary = 3 * sm.sm.sm_size;
+    /* the start of a secondary map */
+
+    SECTION("unwritten bytes come from SO_UNDEF")
+    {
+        auto got = classify(sm, boundary - 8, 16, 1);
+        REQUIRE(got.local == 0);
+        REQUIRE(got.remote == (Runs{{SO_UNDEF, 16}}));
+    }
+
+    SECTION("a run from one writer continues across secondary maps")
+    {
+        sm.updateWriter(boundary - 100, 200, 2);
+        auto got = classify(sm, boundary - 100, 200, 1);
+        REQUIRE(got.local == 0);
+        REQUIRE(got.remote == (Runs{{2, 200}}));
+
+        got = classify(sm, boundary - 100, 200, 2);
+        REQUIRE(got.local == 200);
+        REQUIRE(got.remote.empty() == true);
+    }
+
+    SECTION("a new writer starts a new run at the boundary")
+    {
+        sm.updateWriter(boundary - 10, 10, 2);
+        sm.updateWriter(boundary, 10, 3);
+        auto got = classify(sm, boundary - 10, 20, 1);
+        REQUIRE(got.remote == (Runs{{2, 10}, {3, 10}}));
+    }
+
+    SECTION("local bytes do not end a remote run")
+    {
+        sm.updateWriter(boundary - 8, 16, 2);
+        sm.updateWriter(boundary - 2, 4, 1);
+        auto got = classify(sm, boundary - 8, 16, 1);
+        REQUIRE(got.local == 4);
+        REQUIRE(got.remote == (Runs{{2, 12}}));
+    }
+
+    SECTION("bytes last read by the reader are local")
+    {
+        sm.updateWriter(boundary - 8, 16, 2);
+        sm.updateReader(boundary, 4, 1);
+        auto got = classify(sm, boundary - 8, 16, 1);
+        REQUIRE(got.local == 4);
+        REQUIRE(got.remote == (Runs{{2, 12}}));
+
+        /* a new write clears the reader */
+        sm.updateWriter(boundary, 1, 3);
+        got = classify(sm, boundary - 8, 16, 1);
+        REQUIRE(got.local == 3);
+        REQUIRE(got.remote == (Runs{{2, 8}, {3, 1}, {2, 4}}));
+    }
+}
+
+
+TEST_CASE("reads match a byte-wise reference", "[ClassifyReadRandom]")
+{
+    srand(time(NULL));
+
+    SCShadowMemory sm;
+    Reference ref;
+
+    /* a small window around the start of a secondary map,
+     * so most accesses overlap earlier ones and many cross the boundary */
+    const Addr boundary = 5 * sm.sm.sm_size;
+    const Addr window = 2048;
+    const Addr base = boundary - window/2;
+
+    for (int op = 0; op < 200000; ++op)
+    {
+        ByteCount bytes = (rand() % 16 == 0) ? rand() % 512 + 1 : rand() % 16 + 1;
+        Addr addr = base + rand() % (window - bytes);
+        FID fid = rand() % 6;
+
+        switch (rand() % 3)
+        {
+        case 0:
+            sm.updateWriter(addr, bytes, fid);
+            ref.write(addr, bytes, fid);
+            break;
+        case 1:
+            sm.updateReader(addr, bytes, fid);
+            ref.read(addr, bytes, fid);
+            break;
+        default:
+        {
+            auto got = classify(sm, addr, bytes, fid);
+            auto expected = ref.classify(addr, bytes, fid);
+            REQUIRE(got.local == expected.local);
+            REQUIRE(got.remote == expected.remote);
+            break;
+        }
+        }
+    }
+}
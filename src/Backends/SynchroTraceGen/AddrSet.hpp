@@ -2,25 +2,30 @@
 #define STGEN_ADDRSET_H
 
 #include "STTypes.hpp" // Addr, TID, EID
-#include "MemoryPool.h"
-#include <set>
+#include "SmallVector.hpp"
+#include <algorithm>
 
 namespace STGen
 {
 
 struct AddrSet
 {
-    /* Helper class to track unique ranges of addresses */
+    /* Helper class to track unique ranges of addresses.
+     *
+     * Ranges are kept sorted, non-overlapping, and non-adjacent
+     * in a flat array. Most events only touch a handful of ranges,
+     * so the first few are stored inline */
 
     using AddrRange = std::pair<Addr, Addr>;
-    using Ranges = std::multiset<AddrRange, std::less<AddrRange>, MemoryPool<AddrRange>>;
+    using Ranges = SmallVector<AddrRange, 4>;
 
     AddrSet(){}
-    AddrSet(const AddrRange &range) { ms.insert(range); }
-    AddrSet(const AddrSet &other) { ms = other.ms; }
+    AddrSet(const AddrRange &range) { ranges.push_back(range); }
+    AddrSet(const AddrSet &other) = default;
+    AddrSet(AddrSet &&other) = default;
     AddrSet &operator=(const AddrSet &) = delete;
-    const Ranges &get() const { return ms; }
-    void clear() { ms.clear(); }
+    const Ranges &get() const { return ranges; }
+    void clear() { ranges.clear(); }
 
 
     void insert(const AddrRange &range)
@@ -28,101 +33,52 @@ struct AddrSet
         /* A range of addresses is specified by the pair.
          * This call inserts that range and merges existing ranges
          * in order to keep the set of addresses unique */
-        /* TODO(someday) Someone please clean up flow control */
 
         assert(range.first <= range.second);
 
-        /* insert if this is the first addr */
-        if (ms.empty() == true)
+        /* common case: addresses arrive in ascending order */
+        if (ranges.empty() || endsBefore(ranges.back(), range.first))
         {
-            ms.insert(range);
+            ranges.push_back(range);
             return;
         }
-
-        /* get the first addr pair that is not less than range */
-        /* see http://en.cppreference.com/w/cpp/utility/pair/operator_cmp */
-        auto it = ms.lower_bound(range);
-
-        if (it != ms.cbegin())
+        else if (ranges.back().first <= range.first)
         {
-            if (it == ms.cend())
-                /* if no address range starts at a higher address,
-                 * check the last element */
-            {
-                it = --ms.cend();
-            }
-            else
-                /* check if the previous addr pair overlaps with range */
-            {
-                --it;
-
-                if (range.first > it->second + 1)
-                {
-                    ++it;
-                }
-            }
+            /* only the last range can overlap or touch 'range' */
+            ranges.back().second = std::max(ranges.back().second, range.second);
+            return;
         }
 
-        if (range.first == it->second + 1)
-        {
-            /* extend 'it' by 'range'; recheck, may overrun other addresses */
-            auto tmp = std::make_pair(it->first, range.second);
-            ms.erase(it);
-            insert(tmp);
-        }
-        else if (range.second + 1 == it->first)
-        {
-            /* extend 'it' by 'range'; recheck, may overrun other addresses */
-            auto tmp = std::make_pair(range.first, it->second);
-            ms.erase(it);
-            insert(tmp);
-        }
-        else if (range.first > it->second)
-        {
-            /* can't merge, just insert (at end) */
-            ms.insert(range);
-        }
-        else if (range.first >= it->first)
+        /* merge all ranges that overlap or touch 'range', i.e. [first, last) */
+        auto first = std::partition_point(ranges.begin(), ranges.end(),
+                                          [&](const AddrRange &r)
+                                          { return endsBefore(r, range.first); });
+        auto last = std::partition_point(first, ranges.end(),
+                                         [&](const AddrRange &r)
+                                         { return endsBefore(range, r.first) == false; });
+
+        size_t firstIdx = first - ranges.begin();
+        size_t lastIdx = last - ranges.begin();
+        if (firstIdx == lastIdx)
         {
-            if (range.second > it->second)
-                /* extending 'it' to the end of 'range' */
-            {
-                /* merge, delete, and recheck, may overrun other addresses */
-                auto tmp = std::make_pair(it->first, range.second);
-                ms.erase(it);
-                insert(tmp);
-            }
-
-            /* else do not insert; 'it' encompasses 'range' */
+            ranges.insert(firstIdx, range);
         }
-        else /* if (range.first < it->first) */
+        else
         {
-            if (range.second < it->first)
-                /* no overlap */
-            {
-                /* nothing to merge */
-                ms.insert(range);
-            }
-            else if (range.second <= it->second)
-                /* begin address is extended */
-            {
-                /* merge, delete, and insert; no need to recheck */
-                Addr second = it->second;
-                ms.erase(it);
-                ms.emplace(range.first, second);
-            }
-            else /* if(range.second > it->second) */
-                /* 'range' encompasses 'it' */
-            {
-                /* delete old range and insert bigger range; recheck */
-                ms.erase(it);
-                insert(range);
-            }
+            ranges[firstIdx].first = std::min(ranges[firstIdx].first, range.first);
+            ranges[firstIdx].second = std::max(ranges[lastIdx-1].second, range.second);
+            ranges.erase(firstIdx + 1, lastIdx);
         }
     }
 
   private:
-    Ranges ms;
+    static bool endsBefore(const AddrRange &range, Addr addr)
+    {
+        /* 'range' ends before 'addr' with a gap, so they cannot merge */
+        return range.second < addr && range.second + 1 < addr;
+    }
+
+    Ranges ranges;
 };
 
 }; //end namespace STGen
@@ -2,6 +2,8 @@
 #define STGEN_BARRIER_MERGE_H
 
 #include "STTypes.hpp"
+#include <unordered_map>
+#include <vector>
 
 /*****************************************************************************
  * Merge per-barrier statistics across threads.
@@ -71,21 +73,16 @@ struct BarrierMerge
      */
 
     using BarrierIt = AllBarriersStats::iterator;
-    using ConstBarrierIt = AllBarriersStats::const_iterator;
+    using Position = std::pair<size_t, BarrierIt>;
 
-    struct FromState
+    struct Positions
     {
-        ConstBarrierIt begin;
-        ConstBarrierIt current;
-        ConstBarrierIt end;
-    };
-
-    struct ToState
-    {
-        BarrierIt current;
-        BarrierIt previous;
-        AllBarriersStats &mergedStats;
+        /* where one barrier appears in 'to', in order */
+        std::vector<Position> nodes;
+        size_t next{0};
+        /* the first node that can still be matched */
     };
+    using BarrierIndex = std::unordered_map<Addr, Positions>;
 
 
     static auto merge(const AllBarriersStats &from, AllBarriersStats &to) -> void
@@ -96,53 +93,56 @@ struct BarrierMerge
         if (to.empty())
             return (void)(to = from);
 
-        merge({from.begin(), from.begin(), from.end()},
-              {to.begin(), to.end(), to});
-    }
-
-    static auto merge(FromState from, ToState to) -> void
-    {
-        /* nothing left */
-        if (from.begin == from.end)
-            return;
-
-        /* no matches found previously */
-        if (from.current == from.end)
+        /* Only the original nodes of 'to' after the last match can be matched:
+         * new nodes are inserted before a match, or at the end.
+         * So the original nodes are indexed once, and the search for each
+         * barrier only moves forward, for linear time overall */
+        BarrierIndex index;
+        size_t position = 0;
+        for (auto it = to.begin(); it != to.end(); ++it)
+            index[it->first].nodes.emplace_back(position++, it);
+
+        size_t current = 0;
+        /* position of the first node in 'to' that can be matched */
+        auto previous = to.end();
+        /* unmatched barriers after the last match go here */
+        auto begin = from.begin();
+        /* first barrier in 'from' not yet merged or inserted */
+
+        for (auto it = from.begin(); it != from.end(); ++it)
         {
-            to.mergedStats.insert(to.previous, from.begin, from.end);
-            return;
-        }
+            auto match = findMatchTo(index, it->first, current);
+            if (match == nullptr)
+                continue;
 
-        auto match = findMatchTo(from.current, to.current, to.mergedStats.end());
-        if (match == to.mergedStats.end())
-        {
-            ++from.current;
-            merge(from, to);
-        }
-        else /* matched a barrier */
-        {
-            /* merge current and insert any previous barriers */
-            match->second += from.current->second;
-            if (from.begin != from.current)
-                to.mergedStats.insert(match, from.begin, from.current);
+            /* merge the match and insert any previous barriers */
+            match->second->second += it->second;
+            to.insert(match->second, begin, it);
 
             /* continue with the rest of the barriers */
-            assert(match != to.mergedStats.end());
-            to.previous = ++match;
-            to.current = to.previous;
-
-            ++from.current;
-            from.begin = from.current;
-            merge(from, to);
+            current = match->first + 1;
+            previous = std::next(match->second);
+            begin = std::next(it);
         }
+
+        /* no matches for the rest */
+        to.insert(previous, begin, from.end());
     }
 
-    static auto findMatchTo(ConstBarrierIt from, BarrierIt to, BarrierIt toEnd) -> BarrierIt
+    static auto findMatchTo(BarrierIndex &index, Addr barrier, size_t current) -> Position*
     {
-        if (from->first == to->first || to == toEnd)
-            return to;
-        else
-            return findMatchTo(from, ++to, toEnd);
+        auto found = index.find(barrier);
+        if (found == index.end())
+            return nullptr;
+
+        auto &positions = found->second;
+        while (positions.next < positions.nodes.size() &&
+               positions.nodes[positions.next].first < current)
+            ++positions.next;
+
+        if (positions.next == positions.nodes.size())
+            return nullptr;
+        return &positions.nodes[positions.next];
     }
 };
 
@@ -10,19 +10,17 @@ class GzOutputStream : public OutputStream
 {
     /* Based off of FdOutputStream in capnproto library */
   public:
-    explicit GzOutputStream(gzFile fz) : fz(fz) {}
+    explicit GzOutputStream(STGen::GzipWriter &gz) : gz(gz) {}
     KJ_DISALLOW_COPY(GzOutputStream);
     ~GzOutputStream() noexcept(false) {}
 
     void write(const void* buffer, size_t size) override
     {
-        int ret = gzwrite(fz, buffer, size);
-        if (ret == 0)
-            fatal("error writing gzipped capnproto serializaton");
+        gz.write(buffer, size);
     }
 
   private:
-    gzFile fz;
+    STGen::GzipWriter &gz;
 };
 
 }; //end namespace kj
@@ -31,11 +29,11 @@ class GzOutputStream : public OutputStream
 namespace capnp
 {
 
-inline void writePackedMessageToGz(gzFile fz, MessageBuilder &message)
+inline void writePackedMessageToGz(STGen::GzipWriter &gz, MessageBuilder &message)
 {
     /* Based off of writePackedMessageToFd in capnproto library */
 
-    kj::GzOutputStream output(fz);
+    kj::GzOutputStream output(gz);
     writePackedMessage(output, message.getSegmentsForOutput());
 }
 
@@ -51,12 +49,11 @@ namespace
 {
 /* Common between compressed/uncompressed */
 
-template <typename Event, typename OrphanagePtr, typename OrphanList>
+template <typename Event>
 auto flushSyncEvent(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
-                    OrphanagePtr &orphanage, OrphanList &orphans) -> void
+                    typename Event::Builder event) -> void
 {
-    auto orphan = orphanage->getOrphanage().template newOrphan<Event>();
-    auto syncBuilder = orphan.get().initSync();
+    auto syncBuilder = event.initSync();
 
     /* translate type to CapnProto enum */
     assert(numArgs > 0);
@@ -98,44 +95,47 @@ auto flushSyncEvent(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
     default:
         fatal("capnlogger encountered unhandled sync event");
     }
-
-    orphans.emplace_back(std::move(orphan));
 }
 
 
-template <typename Event, typename OrphanagePtr, typename OrphanList>
-auto flushInstrMarker(int limit, OrphanagePtr &orphanage, OrphanList &orphans) -> void
+template <typename Event>
+auto flushInstrMarker(int limit, typename Event::Builder event) -> void
 {
-    auto orphan = orphanage->getOrphanage().template newOrphan<Event>();
-    auto markerBuilder = orphan.get().initMarker();
+    auto markerBuilder = event.initMarker();
     markerBuilder.setCount(limit);
-
-    orphans.emplace_back(std::move(orphan));
 }
 
-template <typename EventStream, typename OrphanagePtr, typename OrphanList>
-auto flushOrphans(OrphanagePtr flushedOrphanage, OrphanList flushedOrphans, gzFile fz) -> bool
+
+template <typename EventStream, typename MessagePtr>
+auto startChunk(MessagePtr &chunk) -> typename ::capnp::List<typename EventStream::Event>::Builder
 {
-    /* need to keep the orphanage alive until it's flushed */
-    (void)flushedOrphanage;
+    /* the event list is the first allocation in the message,
+     * so size the first segment to hold it outright */
+    using Event = typename EventStream::Event;
+    constexpr unsigned eventWords = (Event::_capnpPrivate::dataWordSize +
+                                     Event::_capnpPrivate::pointerCount);
+    chunk = std::make_unique<::capnp::MallocMessageBuilder>(
+        capnpEventsPerChunk * eventWords + 3 /* root pointer, root, list tag */);
+    return chunk->template initRoot<EventStream>().initEvents(capnpEventsPerChunk);
+}
 
-    /* create the message now that we have a fixed length */
-    ::capnp::MallocMessageBuilder message;
-    auto eventStreamBuilder = message.initRoot<EventStream>();
-    auto eventsBuilder = eventStreamBuilder.initEvents(flushedOrphans.size());
 
-    for (unsigned i=0; i<flushedOrphans.size(); ++i)
+template <typename EventStream, typename MessagePtr>
+auto writeChunk(MessagePtr chunk, unsigned events, TracePosition next, GzipWriter *gz) -> bool
+{
+    assert(events > 0 && events <= capnpEventsPerChunk);
+    if (events < capnpEventsPerChunk)
     {
-        auto reader = flushedOrphans[i].getReader();
-        eventsBuilder.setWithCaveats(i, reader);
+        /* shrink the list in place to the logged events;
+         * the unused tail is zeroed and packs to almost nothing */
+        auto eventStreamBuilder = chunk->template getRoot<EventStream>();
+        auto eventsOrphan = eventStreamBuilder.disownEvents();
+        eventsOrphan.truncate(events);
+        eventStreamBuilder.adoptEvents(kj::mv(eventsOrphan));
     }
 
-    ::capnp::writePackedMessageToGz(fz, message);
-
-    /* burn down the orphanage and orphans */
-    flushedOrphans.clear(); /* kill orphans first,
-                               otherwise we die when we run into the burning orphanage
-                               to kill the orphans */
+    ::capnp::writePackedMessageToGz(*gz, *chunk);
+    gz->mark(next);
     return true;
 }
 
@@ -148,36 +148,29 @@ CapnLoggerCompressed::CapnLoggerCompressed(TID tid, std::string outputPath)
 {
     assert(tid >= 1);
 
-    /* initialize orphanage */
-    orphanage = std::make_unique<::capnp::MallocMessageBuilder>();
+    chunkEvents = startChunk<EventStream>(chunk);
 
-    /* nothing being copied yet */
-    doneCopying = std::async([]{return true;});
+    /* nothing being written yet */
+    doneWriting = std::async([]{return true;});
 
     auto filePath = (outputPath + "/sigil.events.out-" + std::to_string(tid) +
                      ".compressed.capn.bin.gz");
-    fz = gzopen(filePath.c_str(), "wb");
-    if (fz == NULL)
-        fatal(std::string("opening gzfile: ") + strerror(errno));
+    gz = std::make_unique<GzipWriter>(filePath, true);
 }
 
 
 CapnLoggerCompressed::~CapnLoggerCompressed()
 {
-    flushOrphansNow();
-    int ret = gzclose(fz);
-    if (ret != Z_OK)
-        fatal(std::string("closing gzfile: ") + strerror(errno));
+    flushChunkNow();
+    gz.reset();
 }
 
 
 auto CapnLoggerCompressed::flush(const STCompEventCompressed& ev, EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    auto orphan = orphanage->getOrphanage().newOrphan<Event>();
-    auto comp = orphan.get().initComp();
+    auto comp = nextEvent().initComp();
     comp.setIops(ev.iops);
     comp.setFlops(ev.flops);
     comp.setReads(ev.reads);
@@ -194,7 +187,7 @@ auto CapnLoggerCompressed::flush(const STCompEventCompressed& ev, EID eid, TID t
         rangeBuilder.setEnd(p.second);
     }
 
-    auto &readsRange = ev.uniqueWriteAddrs.get();
+    auto &readsRange = ev.uniqueReadAddrs.get();
     auto numReadRanges = readsRange.size();
     auto readAddrBuilder = comp.initReadAddrs(numReadRanges);
     size_t j = 0;
@@ -204,24 +197,21 @@ auto CapnLoggerCompressed::flush(const STCompEventCompressed& ev, EID eid, TID t
         rangeBuilder.setStart(p.first);
         rangeBuilder.setEnd(p.second);
     }
-
-    orphans.emplace_back(std::move(orphan));
-    flushOrphansOnMaxEvents();
+    pos.onEvent(eid);
 }
 
 
 auto CapnLoggerCompressed::flush(const STCommEventCompressed& ev, EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    auto orphan = orphanage->getOrphanage().newOrphan<Event>();
-    auto commEdgesBuilder = orphan.get().initComm().initEdges(ev.comms.size());;
+    auto commEdgesBuilder = nextEvent().initComm().initEdges(ev.comms.size());
     for (size_t i=0; i<ev.comms.size(); ++i)
     {
         auto &edge = ev.comms[i];
         commEdgesBuilder[i].setProducerThread(std::get<0>(edge));
         commEdgesBuilder[i].setProducerEvent(std::get<1>(edge));
+        commEdgesBuilder[i].setProducerEventHi(std::get<1>(edge) >> 32);
 
         auto &ranges = std::get<2>(edge).get();
         auto edgesBuilder = commEdgesBuilder[i].initAddrs(ranges.size());
@@ -233,64 +223,70 @@ auto CapnLoggerCompressed::flush(const STCommEventCompressed& ev, EID eid, TID t
             rangeBuilder.setEnd(p.second);
         }
     }
-
-    orphans.emplace_back(std::move(orphan));
-    flushOrphansOnMaxEvents();
+    pos.onEvent(eid);
 }
 
 
 auto CapnLoggerCompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                                  EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    flushSyncEvent<Event>(syncType, numArgs, syncArgs, orphanage, orphans);
-    flushOrphansOnMaxEvents();
+    flushSyncEvent<Event>(syncType, numArgs, syncArgs, nextEvent());
+    pos.onSync(syncType, eid);
 }
 
 
 auto CapnLoggerCompressed::instrMarker(int limit) -> void
 {
-    flushInstrMarker<Event>(limit, orphanage, orphans);
-    flushOrphansOnMaxEvents();
+    flushInstrMarker<Event>(limit, nextEvent());
+    pos.onMarker(limit);
 }
 
 
-auto CapnLoggerCompressed::flushOrphansOnMaxEvents() -> void
+auto CapnLoggerCompressed::repeat(unsigned events, unsigned period, int64_t stride,
+                                  EID eid, TID tid) -> void
 {
-    assert(events <= maxEventsPerMessage);
-    if (++events == maxEventsPerMessage)
-    {
-        flushOrphansAsync();
-        events = 0;
-    }
+    (void)tid;
+    assert(events > 0 && period > 0);
+
+    auto rep = nextEvent().initRepeat();
+    rep.setStride(stride);
+    rep.setEvents(events);
+    rep.setPeriod(period);
+    pos.onEvent(eid + events - 1);
 }
 
 
-auto CapnLoggerCompressed::flushOrphansNow() -> void
+auto CapnLoggerCompressed::nextEvent() -> Event::Builder
+{
+    assert(events <= capnpEventsPerChunk);
+    if (events == capnpEventsPerChunk)
+        flushChunkAsync();
+    return chunkEvents[events++];
+}
+
+
+auto CapnLoggerCompressed::flushChunkNow() -> void
 {
-    assert(events <= maxEventsPerMessage);
     if (events > 0)
-    {
-        flushOrphansAsync();
-        doneCopying.get(); // blocking flush
-        events = 0;
-    }
+        flushChunkAsync();
+    doneWriting.get(); // blocking flush
 }
 
 
-auto CapnLoggerCompressed::flushOrphansAsync() -> void
+auto CapnLoggerCompressed::flushChunkAsync() -> void
 {
-    /* asynchronously copy orphans and flush */
-    assert(doneCopying.valid());
-    doneCopying.get();
-    doneCopying = std::async(std::launch::async,
-                             flushOrphans<EventStream, OrphanagePtr, OrphanList>,
-                             std::move(orphanage), std::move(orphans), fz);
-    /* start a new orphanage */
-    orphans.clear();
-    orphanage = std::make_unique<::capnp::MallocMessageBuilder>();
+    /* asynchronously pack the full chunk and write it out,
+     * while events are built in the next one */
+    assert(doneWriting.valid());
+    doneWriting.get();
+    doneWriting = std::async(std::launch::async,
+                             writeChunk<EventStream, MessagePtr>,
+                             std::move(chunk), events, pos, gz.get());
+
+    chunkEvents = startChunk<EventStream>(chunk);
+    events = 0;
 }
 
 
@@ -300,26 +296,21 @@ CapnLoggerUncompressed::CapnLoggerUncompressed(TID tid, std::string outputPath)
 {
     assert(tid >= 1);
 
-    /* initialize orphanage */
-    orphanage = std::make_unique<::capnp::MallocMessageBuilder>();
+    chunkEvents = startChunk<EventStream>(chunk);
 
-    /* nothing being copied yet */
-    doneCopying = std::async([]{return true;});
+    /* nothing being written yet */
+    doneWriting = std::async([]{return true;});
 
     auto filePath = (outputPath + "/sigil.events.out-" + std::to_string(tid) +
                      ".uncompressed.capn.bin.gz");
-    fz = gzopen(filePath.c_str(), "wb");
-    if (fz == NULL)
-        fatal(std::string("opening gzfile: ") + strerror(errno));
+    gz = std::make_unique<GzipWriter>(filePath, true);
 }
 
 
 CapnLoggerUncompressed::~CapnLoggerUncompressed()
 {
-    flushOrphansNow();
-    int ret = gzclose(fz);
-    if (ret != Z_OK)
-        fatal(std::string("closing gzfile: ") + strerror(errno));
+    flushChunkNow();
+    gz.reset();
 }
 
 
@@ -327,93 +318,79 @@ auto CapnLoggerUncompressed::flush(StatCounter iops, StatCounter flops,
                                    Event::MemType type, Addr start, Addr end,
                                    EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    auto orphan = orphanage->getOrphanage().newOrphan<Event>();
-    auto compBuilder = orphan.get().initComp();
+    auto compBuilder = nextEvent().initComp();
     compBuilder.setIops(iops);
     compBuilder.setFlops(flops);
     compBuilder.setMem(type);
     compBuilder.setStartAddr(start);
     compBuilder.setEndAddr(end);
-
-    orphans.emplace_back(std::move(orphan));
-    flushOrphansOnMaxEvents();
+    pos.onEvent(eid);
 }
 
 
 auto CapnLoggerUncompressed::flush(EID producerEID, TID producerTID, Addr start, Addr end,
                                    EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    auto orphan = orphanage->getOrphanage().newOrphan<Event>();
-    auto commBuilder = orphan.get().initComm();
+    auto commBuilder = nextEvent().initComm();
     commBuilder.setProducerEvent(producerEID);
+    commBuilder.setProducerEventHi(producerEID >> 32);
     commBuilder.setProducerThread(producerTID);
     commBuilder.setStartAddr(start);
     commBuilder.setEndAddr(end);
-
-    orphans.emplace_back(std::move(orphan));
-    flushOrphansOnMaxEvents();
+    pos.onEvent(eid);
 }
 
 
 auto CapnLoggerUncompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                                    EID eid, TID tid) -> void
 {
-    (void)eid;
     (void)tid;
 
-    flushSyncEvent<Event>(syncType, numArgs, syncArgs, orphanage, orphans);
-    flushOrphansOnMaxEvents();
+    flushSyncEvent<Event>(syncType, numArgs, syncArgs, nextEvent());
+    pos.onSync(syncType, eid);
 }
 
 
 auto CapnLoggerUncompressed::instrMarker(int limit) -> void
 {
-    flushInstrMarker<Event>(limit, orphanage, orphans);
-    flushOrphansOnMaxEvents();
+    flushInstrMarker<Event>(limit, nextEvent());
+    pos.onMarker(limit);
 }
 
 
-auto CapnLoggerUncompressed::flushOrphansOnMaxEvents() -> void
+auto CapnLoggerUncompressed::nextEvent() -> Event::Builder
 {
-    assert(events <= maxEventsPerMessage);
-    if (++events == maxEventsPerMessage)
-    {
-        flushOrphansAsync();
-        events = 0;
-    }
+    assert(events <= capnpEventsPerChunk);
+    if (events == capnpEventsPerChunk)
+        flushChunkAsync();
+    return chunkEvents[events++];
 }
 
 
-auto CapnLoggerUncompressed::flushOrphansNow() -> void
+auto CapnLoggerUncompressed::flushChunkNow() -> void
 {
-    assert(events <= maxEventsPerMessage);
     if (events > 0)
-    {
-        flushOrphansAsync();
-        doneCopying.get(); // blocking flush
-        events = 0;
-    }
+        flushChunkAsync();
+    doneWriting.get(); // blocking flush
 }
 
 
-auto CapnLoggerUncompressed::flushOrphansAsync() -> void
+auto CapnLoggerUncompressed::flushChunkAsync() -> void
 {
-    /* asynchronously copy orphans and flush */
-    assert(doneCopying.valid());
-    doneCopying.get();
-    doneCopying = std::async(std::launch::async,
-                             flushOrphans<EventStream, OrphanagePtr, OrphanList>,
-                             std::move(orphanage), std::move(orphans), fz);
-
-    /* start a new orphanage */
-    orphans.clear();
-    orphanage = std::make_unique<::capnp::MallocMessageBuilder>();
+    /* asynchronously pack the full chunk and write it out,
+     * while events are built in the next one */
+    assert(doneWriting.valid());
+    doneWriting.get();
+    doneWriting = std::async(std::launch::async,
+                             writeChunk<EventStream, MessagePtr>,
+                             std::move(chunk), events, pos, gz.get());
+
+    chunkEvents = startChunk<EventStream>(chunk);
+    events = 0;
 }
 
 }; //end namespace STGen
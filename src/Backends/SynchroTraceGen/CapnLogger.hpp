@@ -3,11 +3,11 @@
 
 #include "Core/SigiLog.hpp"
 #include "STLogger.hpp"
+#include "ParallelGzip.hpp"
 #include "STEventTraceCompressed.capnp.h"
 #include "STEventTraceUncompressed.capnp.h"
 #include <capnp/message.h>
 #include <capnp/serialize-packed.h>
-#include <zlib.h>
 #include <future>
 
 /* Uses CapnProto library (https://capnproto.org)
@@ -20,12 +20,15 @@ using SigiLog::fatal;
 namespace STGen
 {
 
+constexpr unsigned capnpEventsPerChunk = 1 << 16;
+/* Events per capnproto message.
+ * Each message is a standalone EventStream, back to back in the file */
+
 class CapnLoggerCompressed : public STLoggerCompressed
 {
     using EventStream = EventStreamCompressed;
     using Event = EventStream::Event;
-    using OrphanagePtr = std::unique_ptr<::capnp::MallocMessageBuilder>;
-    using OrphanList = std::vector<::capnp::Orphan<Event>>;
+    using MessagePtr = std::unique_ptr<::capnp::MallocMessageBuilder>;
   public:
     CapnLoggerCompressed(TID tid, std::string outputPath);
     CapnLoggerCompressed(const CapnLoggerCompressed &other) = delete;
@@ -36,24 +39,28 @@ class CapnLoggerCompressed : public STLoggerCompressed
     auto flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                EID eid, TID tid) -> void override final;
     auto instrMarker(int limit) -> void override final;
+    auto repeat(unsigned events, unsigned period, int64_t stride,
+                EID eid, TID tid) -> void override final;
 
   private:
-    auto flushOrphansOnMaxEvents() -> void;
-    auto flushOrphansNow() -> void;
-    auto flushOrphansAsync() -> void;
-
-    static constexpr unsigned maxEventsPerMessage = 100000;
+    auto nextEvent() -> Event::Builder;
+    /* the next free event in the current chunk */
+    auto flushChunkAsync() -> void;
+    auto flushChunkNow() -> void;
 
-    OrphanagePtr orphanage;
-    OrphanList orphans;
-    /* use an orphanage because we don't know the event count ahead of time */
-
-    gzFile fz;
+    MessagePtr chunk;
+    ::capnp::List<Event>::Builder chunkEvents{nullptr};
     unsigned events{0};
+    /* Events are built in place, in a list sized for a full chunk.
+     * The last chunk is cut short to the events actually logged */
+
+    TracePosition pos;
+    std::unique_ptr<GzipWriter> gz;
+    /* indexed at chunk boundaries */
 
-    std::future<bool> doneCopying;
+    std::future<bool> doneWriting;
     /* Use as a barrier to ensure one capnproto
-     * message gets copied at a time */
+     * message gets written at a time */
 };
 
 
@@ -61,8 +68,7 @@ class CapnLoggerUncompressed : public STLoggerUncompressed
 {
     using EventStream = EventStreamUncompressed;
     using Event = EventStream::Event;
-    using OrphanagePtr = std::unique_ptr<::capnp::MallocMessageBuilder>;
-    using OrphanList = std::vector<::capnp::Orphan<Event>>;
+    using MessagePtr = std::unique_ptr<::capnp::MallocMessageBuilder>;
   public:
     CapnLoggerUncompressed(TID tid, std::string outputPath);
     CapnLoggerUncompressed(const CapnLoggerUncompressed &other) = delete;
@@ -78,22 +84,24 @@ class CapnLoggerUncompressed : public STLoggerUncompressed
     auto instrMarker(int limit) -> void override final;
 
   private:
-    auto flushOrphansOnMaxEvents() -> void;
-    auto flushOrphansNow() -> void;
-    auto flushOrphansAsync() -> void;
+    auto nextEvent() -> Event::Builder;
+    /* the next free event in the current chunk */
+    auto flushChunkAsync() -> void;
+    auto flushChunkNow() -> void;
 
-    static constexpr unsigned maxEventsPerMessage = 500000;
-
-    OrphanagePtr orphanage;
-    OrphanList orphans;
-    /* use an orphanage because we don't know the event count ahead of time */
-
-    gzFile fz;
+    MessagePtr chunk;
+    ::capnp::List<Event>::Builder chunkEvents{nullptr};
     unsigned events{0};
+    /* Events are built in place, in a list sized for a full chunk.
+     * The last chunk is cut short to the events actually logged */
+
+    TracePosition pos;
+    std::unique_ptr<GzipWriter> gz;
+    /* indexed at chunk boundaries */
 
-    std::future<bool> doneCopying;
+    std::future<bool> doneWriting;
     /* Use as a barrier to ensure one capnproto
-     * message gets copied at a time */
+     * message gets written at a time */
 };
 
 }; //end namespace STGen
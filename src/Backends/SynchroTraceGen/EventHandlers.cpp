@@ -1,7 +1,20 @@
 #include "EventHandlers.hpp"
 #include "STTypes.hpp"
 #include "TextLogger.hpp"
+#include "ParallelGzip.hpp"
+#include "TraceOutput.hpp"
+#include "RepeatLogger.hpp"
+#include "TraceShards.hpp"
 #include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unordered_set>
+#include <limits>
+#include <atomic>
+#include <future>
+#include <thread>
 
 using namespace SigiLog; // console logging
 namespace STGen
@@ -24,14 +37,27 @@ namespace
 {
 std::string outputPath{"."};
 unsigned primsPerStCompEv{100};
+std::vector<unsigned> compressionLevels;
+/* more than one level generates each level in the same pass */
+constexpr int maxRepeatPeriod = 64;
 std::string loggerType;
 TCxtGenerator genTCxt;
+uint64_t shadowMemLimit{0};
 
 std::mutex gMtx;
-ThreadStatMap allThreadsStats;
+unsigned handlers{0};
+/* one per backend thread */
+std::vector<ThreadStatMap> levelStats;
+/* one per compression level, in the order given */
+std::vector<std::unique_ptr<ThreadContext>> finishedTCxts;
+/* closed in parallel at exit */
+constexpr unsigned maxCloseWorkers = 16;
 SpawnList threadSpawns;
 ThreadList newThreadsInOrder;
+std::unordered_set<TID> seenThreads;
 BarrierList barrierParticipants;
+std::unordered_map<Addr, size_t> barrierIdx;
+/* index of each barrier in barrierParticipants */
 }; //end namespace
 
 
@@ -44,7 +70,11 @@ auto EventHandlers::onSyncEv(const sigil2::SyncEvent &ev) -> void
 
     /* Update global state */
     if (syncType == SyncTypeEnum::SGLPRIM_SYNC_SWAP)
+    {
+        if (syncID <= 0 || syncID > std::numeric_limits<TID>::max())
+            fatal("SynchroTraceGen thread ID out of range: " + std::to_string(syncID));
         return onSwapTCxt(syncID);
+    }
     else if (syncType == SyncTypeEnum::SGLPRIM_SYNC_CREATE)
         onCreate(syncID);
     else if (syncType == SyncTypeEnum::SGLPRIM_SYNC_BARRIER)
@@ -85,23 +115,95 @@ auto EventHandlers::onCxtEv(const sigil2::CxtEvent &ev) -> void
 }
 
 
+//-----------------------------------------------------------------------------
+EventHandlers::EventHandlers()
+{
+    /* Evicting a secondary map frees it while another backend thread
+     * may still be updating it, so a shadow memory limit needs a single
+     * backend thread. Handlers are created before their thread's first event */
+    std::lock_guard<std::mutex> lock(gMtx);
+    if (++handlers > 1 && shadowMemLimit > 0)
+        fatal("SynchroTraceGen shadow memory limit (-m) requires a single backend thread");
+}
+
+
 //-----------------------------------------------------------------------------
 /** Flush final stats and data **/
 EventHandlers::~EventHandlers()
 {
+    /* Each thread's trace is flushed and closed at exit,
+     * instead of one after another here */
     std::lock_guard<std::mutex> lock(gMtx);
-    for (auto& p : tcxts)
-        allThreadsStats.emplace(p.first, p.second->getStats());
+    for (size_t tid = 0; tid < tcxts.size(); ++tid)
+    {
+        if (tcxts[tid] != nullptr)
+        {
+            auto stats = tcxts[tid]->getLevelStats();
+            for (size_t level = 0; level < stats.size(); ++level)
+                levelStats[level].emplace(tid, std::move(stats[level]));
+            finishedTCxts.push_back(std::move(tcxts[tid]));
+        }
+    }
 }
 
 
-auto onExit() -> void
+auto closeInParallel(std::vector<std::unique_ptr<ThreadContext>> &tcxts) -> void
+{
+    /* Destroying a context flushes its last events and closes its trace.
+     * Traces are independent, so they are closed by a bounded pool of threads */
+    size_t workers = std::min<size_t>({tcxts.size(),
+                                       std::max(1u, std::thread::hardware_concurrency()),
+                                       maxCloseWorkers});
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < workers; ++i)
+        pool.emplace_back([&]
+        {
+            for (size_t idx = next++; idx < tcxts.size(); idx = next++)
+                tcxts[idx].reset();
+        });
+    for (auto &worker : pool)
+        worker.join();
+    tcxts.clear();
+}
+
+
+auto flushMetadata() -> void
 {
-    std::lock_guard<std::mutex> lock(gMtx);
-    spdlog::set_sync_mode();
     flushPthread(outputPath + "/sigil.pthread.out", newThreadsInOrder,
                  threadSpawns, barrierParticipants);
-    flushStats(outputPath + "/sigil.stats.out", allThreadsStats);
+    flushStats(outputPath + "/sigil.stats.out", levelStats.front(),
+               ThreadContext::getShadowMemoryStats());
+    flushCommMatrix(outputPath + "/sigil.comm.out.csv", levelStats.front());
+
+    /* each level's directory is a complete trace, with that level's stats;
+     * the top level's stats are the first level's */
+    if (compressionLevels.size() > 1)
+    {
+        for (size_t i = 0; i < compressionLevels.size(); ++i)
+        {
+            std::string levelPath = ThreadContextMultiLevel::levelPath(outputPath,
+                                                                       compressionLevels[i]);
+            flushPthread(levelPath + "/sigil.pthread.out", newThreadsInOrder,
+                         threadSpawns, barrierParticipants);
+            flushStats(levelPath + "/sigil.stats.out", levelStats[i],
+                       ThreadContext::getShadowMemoryStats());
+            flushCommMatrix(levelPath + "/sigil.comm.out.csv", levelStats[i]);
+        }
+    }
+}
+
+
+auto onExit() -> void
+{
+    std::lock_guard<std::mutex> lock(gMtx);
+
+    /* thread metadata and statistics are already complete,
+     * so they are written while the traces are closed */
+    auto metadata = std::async(std::launch::async, flushMetadata);
+    closeInParallel(finishedTCxts);
+    TraceShards::close();
+    metadata.get();
 }
 
 
@@ -113,30 +215,41 @@ auto EventHandlers::onSwapTCxt(TID newTID) -> void
 
     if (currentTID != newTID)
     {
-        std::lock_guard<std::mutex> lock(gMtx);
-        if (std::find(newThreadsInOrder.cbegin(),
-                      newThreadsInOrder.cend(),
-                      newTID) == newThreadsInOrder.cend())
+        /* Each event stream only ever sees its own threads,
+         * so only a newly seen thread needs the global registry */
+        if (static_cast<size_t>(newTID) >= tcxts.size())
+            tcxts.resize(newTID + 1);
+
+        auto &tcxt = tcxts[newTID];
+        if (tcxt == nullptr)
         {
-            newThreadsInOrder.push_back(newTID);
-            tcxts.emplace(std::piecewise_construct,
-                          std::forward_as_tuple(newTID),
-                          std::forward_as_tuple(genTCxt(newTID, primsPerStCompEv,
-                                                        outputPath, loggerType)));
+            if (registerThread(newTID) == false)
+                fatal("SynchroTraceGen thread " + std::to_string(newTID) +
+                      " seen in multiple event streams");
+            tcxt = genTCxt(newTID, primsPerStCompEv, outputPath, loggerType);
         }
 
         if (cachedTCxt != nullptr)
             cachedTCxt->flushAll();
 
         currentTID = newTID;
-        assert(tcxts.find(currentTID) != tcxts.cend());
-        cachedTCxt = tcxts.at(currentTID).get();
+        cachedTCxt = tcxt.get();
     }
 
-    assert(currentTID = newTID);
+    assert(currentTID == newTID);
     assert(cachedTCxt != nullptr);
 }
 
+auto EventHandlers::registerThread(TID newTID) -> bool
+{
+    std::lock_guard<std::mutex> lock(gMtx);
+    if (seenThreads.insert(newTID).second == false)
+        return false;
+
+    newThreadsInOrder.push_back(newTID);
+    return true;
+}
+
 auto EventHandlers::onCreate(Addr data) -> void
 {
     std::lock_guard<std::mutex> lock(gMtx);
@@ -147,18 +260,12 @@ auto EventHandlers::onBarrier(Addr data) -> void
 {
     std::lock_guard<std::mutex> lock(gMtx);
 
-    unsigned idx = 0;
-    for (auto &p : barrierParticipants)
-    {
-        if (p.first == data)
-            break;
-        ++idx;
-    }
-
-    if (idx == barrierParticipants.size())
+    /* keep barriers in the order they were first seen */
+    auto p = barrierIdx.emplace(data, barrierParticipants.size());
+    if (p.second == true)
         barrierParticipants.push_back(std::make_pair(data, std::set<TID>{currentTID}));
     else
-        barrierParticipants[idx].second.insert(currentTID);
+        barrierParticipants[p.first->second].second.insert(currentTID);
 }
 
 auto EventHandlers::convertAndFlush(const sigil2::SyncEvent &ev) -> void
@@ -292,6 +399,8 @@ auto parseLogger(std::string loggerArg) -> std::string
     std::transform(loggerArg.begin(), loggerArg.end(), loggerArg.begin(), ::tolower);
     if (loggerArg != "text" &&
         loggerArg != "capnp" &&
+        loggerArg != "raw" &&
+        loggerArg != "rawgz" &&
         loggerArg != "null")
         fatal("unexpected synchrotracegen options: -l " + loggerArg);
 
@@ -299,11 +408,8 @@ auto parseLogger(std::string loggerArg) -> std::string
 }
 
 
-auto parseCompression(std::string compression) -> int
+auto parseCompressionLevel(std::string compression) -> int
 {
-    if (compression.empty() == true)
-        return 100; // default
-
     try
     {
         int ret = std::stoi(compression);
@@ -326,6 +432,160 @@ auto parseCompression(std::string compression) -> int
 }
 
 
+auto parseCompression(std::string compression) -> std::vector<unsigned>
+{
+    /* one level, or a comma separated list, e.g. '1,10,100' */
+    if (compression.empty() == true)
+        return {100}; // default
+
+    std::vector<unsigned> levels;
+    size_t begin = 0;
+    while (true)
+    {
+        size_t end = compression.find(',', begin);
+        unsigned level = parseCompressionLevel(compression.substr(begin, end - begin));
+        if (std::find(levels.begin(), levels.end(), level) != levels.end())
+            fatal("SynchroTraceGen compression level: duplicate level " + std::to_string(level));
+        levels.push_back(level);
+
+        if (end == std::string::npos)
+            break;
+        begin = end + 1;
+    }
+
+    if (levels.size() > maxCompressionLevels)
+        fatal("SynchroTraceGen compression level: at most " +
+              std::to_string(maxCompressionLevels) + " levels");
+
+    return levels;
+}
+
+
+auto makeLevelDirectory(std::string path) -> void
+{
+    if (mkdir(path.c_str(), 0777) != 0 && errno != EEXIST)
+        fatal("creating output directory: " + path + ": " + strerror(errno));
+}
+
+
+auto parseSize(std::string size, std::string what, uint64_t defaultSize) -> uint64_t
+{
+    /* size in MB, or with a K/M/G suffix */
+    if (size.empty() == true)
+        return defaultSize;
+
+    try
+    {
+        size_t pos = 0;
+        uint64_t ret = std::stoull(size, &pos);
+        uint64_t unit = 1ULL << 20;
+        if (pos + 1 == size.length())
+        {
+            switch (::tolower(size.back()))
+            {
+            case 'k': unit = 1ULL << 10; break;
+            case 'm': unit = 1ULL << 20; break;
+            case 'g': unit = 1ULL << 30; break;
+            default: fatal("SynchroTraceGen " + what + ": invalid suffix");
+            }
+        }
+        else if (pos != size.length())
+        {
+            fatal("SynchroTraceGen " + what + ": invalid argument");
+        }
+        return ret * unit;
+    }
+    catch (std::invalid_argument &e)
+    {
+        fatal("SynchroTraceGen " + what + ": invalid argument");
+    }
+    catch (std::out_of_range &e)
+    {
+        fatal("SynchroTraceGen " + what + ": out_of_range");
+    }
+}
+
+
+auto parseShadowMemLimit(std::string limit) -> uint64_t
+{
+    return parseSize(limit, "shadow memory limit", 0); // default, no limit
+}
+
+
+auto parseGzipWorkers(std::string workers) -> unsigned
+{
+    if (workers.empty() == true)
+        return GzipWriter::defaultWorkers();
+
+    try
+    {
+        size_t pos = 0;
+        int ret = std::stoi(workers, &pos);
+        if (ret < 0 || pos != workers.length())
+            fatal("SynchroTraceGen gzip workers: invalid argument");
+        return ret;
+    }
+    catch (std::invalid_argument &e)
+    {
+        fatal("SynchroTraceGen gzip workers: invalid argument");
+    }
+    catch (std::out_of_range &e)
+    {
+        fatal("SynchroTraceGen gzip workers: out_of_range");
+    }
+}
+
+
+auto parseRepeatPeriod(std::string period) -> unsigned
+{
+    /* the most recent compute events checked for repeats */
+    if (period.empty() == true)
+        return 0; // default, off
+
+    try
+    {
+        size_t pos = 0;
+        int ret = std::stoi(period, &pos);
+        if (ret < 0 || ret > maxRepeatPeriod || pos != period.length())
+            fatal("SynchroTraceGen repeat period: expected 0 to " +
+                  std::to_string(maxRepeatPeriod));
+        return ret;
+    }
+    catch (std::invalid_argument &e)
+    {
+        fatal("SynchroTraceGen repeat period: invalid argument");
+    }
+    catch (std::out_of_range &e)
+    {
+        fatal("SynchroTraceGen repeat period: out_of_range");
+    }
+}
+
+
+auto parseCommMatrix(std::string comm) -> bool
+{
+    /* whether to also record the matrix for each barrier region */
+    if (comm.empty() == true || comm == "total")
+        return false; // default
+    else if (comm == "barrier")
+        return true;
+    else
+        fatal("unexpected synchrotracegen options: -p " + comm);
+}
+
+
+auto parseShards(std::string shards) -> bool
+{
+    /* whether to split traces at barriers */
+    if (shards.empty() == true || shards == "none")
+        return false; // default
+    else if (shards == "barrier")
+        return true;
+    else
+        fatal("unexpected synchrotracegen options: -t " + shards);
+}
+
+
 auto parseOutputPath(std::string outputPath) -> std::string
 {
     if (outputPath.empty() == true)
@@ -340,15 +600,61 @@ auto onParse(Args args) -> void
     /* only accept short options */
     std::set<char> options;
     options.insert('o'); // -o OUTPUT_DIRECTORY
-    options.insert('c'); // -c COMPRESSION_VALUE
-    options.insert('l'); // -l {text,capnp}
+    options.insert('c'); // -c COMPRESSION_VALUE[,COMPRESSION_VALUE...]
+    options.insert('l'); // -l {text,capnp,raw,rawgz,null}
+    options.insert('m'); // -m SHADOW_MEMORY_LIMIT
+    options.insert('z'); // -z GZIP_WORKERS
+    options.insert('b'); // -b GZIP_BLOCK_SIZE
+    options.insert('s'); // -s STREAM_SOCKET
+    options.insert('r'); // -r REPEAT_PERIOD
+    options.insert('p'); // -p {total,barrier}
+    options.insert('t'); // -t {none,barrier}
     auto matches = parseAll(args, options);
 
     outputPath = parseOutputPath(matches['o']);
     loggerType = parseLogger(matches['l']);
-    primsPerStCompEv = parseCompression(matches['c']);
+    compressionLevels = parseCompression(matches['c']);
+    primsPerStCompEv = compressionLevels.front();
+    ThreadContext::setCompressionLevels(compressionLevels.size());
+    levelStats.resize(compressionLevels.size());
+    shadowMemLimit = parseShadowMemLimit(matches['m']);
+    ThreadContext::setShadowMemoryLimit(shadowMemLimit, outputPath);
+    GzipWriter::configure(parseGzipWorkers(matches['z']),
+                          parseSize(matches['b'], "gzip block size", GzipWriter::defaultBlockSize));
+    TraceOutput::configure(matches['s']);
+    RepeatLoggerCompressed::configure(parseRepeatPeriod(matches['r']));
+    PerCommStats::configure(parseCommMatrix(matches['p']));
+
+    bool sharded = parseShards(matches['t']);
+    if (sharded == true && TraceOutput::streaming() == true)
+        fatal("SynchroTraceGen: traces split at barriers cannot be streamed");
+    TraceShards::configure(sharded, outputPath);
+
+    if ((loggerType == "raw" || loggerType == "rawgz") &&
+        (compressionLevels.size() > 1 || primsPerStCompEv != 1))
+        fatal("SynchroTraceGen: the " + loggerType + " logger requires -c 1");
+
+    if (RepeatLoggerCompressed::maxPeriod() > 0 &&
+        std::all_of(compressionLevels.begin(), compressionLevels.end(),
+                    [](unsigned level){ return level == 1; }))
+        fatal("SynchroTraceGen: -r only folds compressed events, with -c greater than 1");
+
+    if (compressionLevels.size() > 1)
+    {
+        if (TraceOutput::streaming() == true)
+            fatal("SynchroTraceGen: streaming supports a single compression level");
 
-    if (primsPerStCompEv == 1)
+        for (auto level : compressionLevels)
+            makeLevelDirectory(ThreadContextMultiLevel::levelPath(outputPath, level));
+
+        genTCxt = [](TID tid, unsigned, std::string outputPath, std::string loggerType)
+            -> std::unique_ptr<ThreadContext>
+        {
+            return std::make_unique<ThreadContextMultiLevel>(tid, compressionLevels,
+                                                             outputPath, loggerType);
+        };
+    }
+    else if (primsPerStCompEv == 1)
         genTCxt = ThreadContextGenerator<ThreadContextUncompressed>;
     else if (primsPerStCompEv > 1)
         genTCxt = ThreadContextGenerator<ThreadContextCompressed>;
@@ -15,7 +15,7 @@ auto requirements() -> sigil2::capabilities;
 class EventHandlers : public BackendIface
 {
   public:
-    EventHandlers() {}
+    EventHandlers();
     EventHandlers(const EventHandlers &) = delete;
     EventHandlers &operator=(const EventHandlers &) = delete;
     virtual ~EventHandlers() override;
@@ -28,12 +28,14 @@ class EventHandlers : public BackendIface
 
   private:
     auto onSwapTCxt(TID newTID) -> void;
+    auto registerThread(TID newTID) -> bool;
     auto onCreate(Addr data) -> void;
     auto onBarrier(Addr data) -> void;
     auto convertAndFlush(const sigil2::SyncEvent &ev) -> void;
     /* helpers */
 
-    std::unordered_map<TID, std::unique_ptr<ThreadContext>> tcxts;
+    std::vector<std::unique_ptr<ThreadContext>> tcxts;
+    /* indexed by thread ID */
     TID currentTID{SO_UNDEF};
     ThreadContext *cachedTCxt{nullptr};
 };
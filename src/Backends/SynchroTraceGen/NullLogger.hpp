@@ -69,6 +69,16 @@ class NullLogger : public STLoggerCompressed, public STLoggerUncompressed
     {
         (void)limit;
     }
+
+    auto repeat(unsigned events, unsigned period, int64_t stride,
+                EID eid, TID tid) -> void override final
+    {
+        (void)events;
+        (void)period;
+        (void)stride;
+        (void)eid;
+        (void)tid;
+    }
 };
 
 }; //end namespace STGen
@@ -0,0 +1,301 @@
+#include "ParallelGzip.hpp"
+#include "Core/SigiLog.hpp"
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <zlib.h>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+namespace
+{
+
+auto deflateBlock(GzipWriter::Block &block) -> void
+{
+    /* each block is a standalone gzip member */
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     15 + 16 /* gzip wrapper */, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        fatal("initializing gzip block compression");
+
+    block.out.resize(deflateBound(&strm, block.in.size()));
+    strm.next_in = reinterpret_cast<Bytef*>(block.in.data());
+    strm.avail_in = block.in.size();
+    strm.next_out = block.out.data();
+    strm.avail_out = block.out.size();
+
+    if (deflate(&strm, Z_FINISH) != Z_STREAM_END)
+        fatal("compressing gzip block");
+    block.out.resize(strm.total_out);
+    deflateEnd(&strm);
+}
+
+}; //end namespace
+
+
+class GzipPool
+{
+    /* Worker threads shared by all gzip writers */
+  public:
+    static auto get() -> GzipPool&
+    {
+        static GzipPool pool;
+        return pool;
+    }
+
+    auto configure(unsigned numWorkers, size_t newBlockSize) -> void
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (workers.empty() == false)
+            fatal("gzip workers configured after output started");
+        maxWorkers = numWorkers;
+        blockSize = newBlockSize;
+    }
+
+    auto getBlockSize() -> size_t
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return blockSize;
+    }
+
+    auto getMaxWorkers() -> unsigned
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return maxWorkers;
+    }
+
+    auto submit(GzipWriter::Block &block) -> void
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (maxWorkers > 0)
+            {
+                /* start workers on first use */
+                while (workers.size() < maxWorkers)
+                    workers.emplace_back(&GzipPool::work, this);
+                jobs.push_back(&block);
+                cv.notify_one();
+                return;
+            }
+        }
+
+        deflateBlock(block);
+        block.owner->finished(block);
+    }
+
+    ~GzipPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+  private:
+    GzipPool() : maxWorkers(GzipWriter::defaultWorkers()) {}
+
+    auto work() -> void
+    {
+        while (true)
+        {
+            GzipWriter::Block *block;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this]{ return stop == true || jobs.empty() == false; });
+                if (jobs.empty() == true)
+                    return;
+                block = jobs.front();
+                jobs.pop_front();
+            }
+
+            deflateBlock(*block);
+            block->owner->finished(*block);
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<GzipWriter::Block*> jobs;
+    std::vector<std::thread> workers;
+    bool stop{false};
+
+    unsigned maxWorkers;
+    size_t blockSize{GzipWriter::defaultBlockSize};
+    /* configuration */
+};
+
+
+auto GzipWriter::configure(unsigned workers, size_t blockSize) -> void
+{
+    if (blockSize < minBlockSize || blockSize > maxBlockSize)
+        fatal("gzip block size must be between " + std::to_string(minBlockSize) +
+              " and " + std::to_string(maxBlockSize) + " bytes");
+    GzipPool::get().configure(workers, blockSize);
+}
+
+
+auto GzipWriter::defaultWorkers() -> unsigned
+{
+    unsigned hw = std::thread::hardware_concurrency();
+    return std::max(1U, std::min(hw, 4U));
+}
+
+
+GzipWriter::GzipWriter(std::string filePath, bool indexed)
+    : filePath(filePath)
+    , out(filePath)
+    , blockSize(GzipPool::get().getBlockSize())
+    , current(std::make_unique<Block>())
+{
+    current->owner = this;
+    current->in.reserve(blockSize);
+
+    /* a live stream can't be seeked, so it isn't indexed */
+    if (indexed == true && TraceOutput::streaming() == false)
+    {
+        std::string indexPath = filePath + ".idx";
+        indexFile = fopen(indexPath.c_str(), "wb");
+        if (indexFile == NULL)
+            fatal("opening trace index: " + indexPath + ": " + strerror(errno));
+
+        IndexHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "STGENIDX", sizeof(header.magic));
+        header.version = traceIndexVersion;
+        header.entryBytes = sizeof(IndexEntry);
+        if (fwrite(&header, sizeof(header), 1, indexFile) != 1)
+            fatal("writing trace index: " + indexPath + ": " + strerror(errno));
+    }
+}
+
+
+GzipWriter::~GzipWriter()
+{
+    /* an empty file still gets one (empty) gzip member */
+    if (current->in.empty() == false || wroteAny == false)
+        submit();
+    writeDone(0);
+
+    if (indexFile != nullptr && fclose(indexFile) != 0)
+        fatal("closing trace index: " + filePath + ".idx: " + strerror(errno));
+}
+
+
+auto GzipWriter::write(const void *data, size_t bytes) -> void
+{
+    const char *src = static_cast<const char*>(data);
+    if (indexFile != nullptr)
+    {
+        /* blocks are only cut at marks */
+        current->in.insert(current->in.end(), src, src + bytes);
+        return;
+    }
+
+    while (bytes > 0)
+    {
+        size_t room = blockSize - current->in.size();
+        size_t chunk = std::min(room, bytes);
+        current->in.insert(current->in.end(), src, src + chunk);
+        src += chunk;
+        bytes -= chunk;
+
+        if (current->in.size() == blockSize)
+            submit();
+    }
+}
+
+
+auto GzipWriter::mark(const TracePosition &pos) -> void
+{
+    if (indexFile == nullptr || current->in.size() < blockSize)
+        return;
+
+    submit();
+    current->entry.inOffset = inBytes;
+    current->entry.eid = pos.eid;
+    current->entry.instrs = pos.instrs;
+    current->entry.barriers = pos.barriers;
+}
+
+
+auto GzipWriter::submit() -> void
+{
+    wroteAny = true;
+    inBytes += current->in.size();
+
+    Block &block = *current;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        inFlight.push_back(std::move(current));
+        if (spare.empty() == false)
+        {
+            current = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    if (current == nullptr)
+    {
+        current = std::make_unique<Block>();
+        current->owner = this;
+        current->in.reserve(blockSize);
+    }
+
+    GzipPool::get().submit(block);
+
+    /* bound the memory held by blocks waiting on workers */
+    writeDone(2 * std::max(1U, GzipPool::get().getMaxWorkers()));
+}
+
+
+auto GzipWriter::finished(Block &block) -> void
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    block.done = true;
+    cv.notify_all();
+}
+
+
+auto GzipWriter::writeDone(size_t maxInFlight) -> void
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (inFlight.empty() == false)
+    {
+        if (inFlight.front()->done == false)
+        {
+            if (inFlight.size() <= maxInFlight)
+                return;
+            cv.wait(lock, [this]{ return inFlight.front()->done == true; });
+        }
+
+        std::unique_ptr<Block> block = std::move(inFlight.front());
+        inFlight.pop_front();
+
+        /* only this thread touches finished blocks */
+        lock.unlock();
+        out.write(block->out.data(), block->out.size());
+        if (indexFile != nullptr)
+        {
+            block->entry.offset = outBytes;
+            if (fwrite(&block->entry, sizeof(block->entry), 1, indexFile) != 1)
+                fatal("writing trace index: " + filePath + ".idx: " + strerror(errno));
+        }
+        outBytes += block->out.size();
+        block->in.clear();
+        block->out.clear();
+        block->done = false;
+        lock.lock();
+
+        spare.push_back(std::move(block));
+    }
+}
+
+}; //end namespace STGen
@@ -0,0 +1,97 @@
+#ifndef STGEN_PARALLEL_GZIP_H
+#define STGEN_PARALLEL_GZIP_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include "TraceIndex.hpp"
+#include "TraceOutput.hpp"
+
+namespace STGen
+{
+
+class GzipWriter
+{
+    /* Writes a gzip file as a series of independently deflated blocks,
+     * in the style of pigz.
+     *
+     * Each block is a complete gzip member, and concatenated members
+     * are a valid gzip file for zlib's gzread, gunzip, and similar readers.
+     * Blocks are deflated by a pool of workers shared by all writers,
+     * and written to the file (or stream, see TraceOutput.hpp) in order.
+     *
+     * An indexed writer only cuts blocks at a mark(), which callers place
+     * between events, and writes a side index of the blocks to 'filePath.idx'.
+     * See TraceIndex.hpp. Streamed output is never indexed, and ignores marks.
+     *
+     * A single writer is not thread safe; calls must be serialized */
+  public:
+    static auto configure(unsigned workers, size_t blockSize) -> void;
+    /* Must be called before any writer is created.
+     * With 0 workers, blocks are deflated by the writing thread */
+
+    static auto defaultWorkers() -> unsigned;
+    /* up to 4, depending on the hardware threads available */
+
+    static constexpr size_t defaultBlockSize = 1 << 20;
+    static constexpr size_t minBlockSize = 1 << 12;
+    static constexpr size_t maxBlockSize = 1 << 30;
+
+    GzipWriter(std::string filePath, bool indexed = false);
+    GzipWriter(const GzipWriter &) = delete;
+    GzipWriter &operator=(const GzipWriter &) = delete;
+    ~GzipWriter();
+
+    auto write(const void *data, size_t bytes) -> void;
+
+    auto mark(const TracePosition &pos) -> void;
+    /* The data written so far ends between events,
+     * and 'pos' is the trace position there.
+     * Indexed writers start a new block here once the current one is full;
+     * otherwise this is ignored */
+
+    struct Block
+    {
+        std::vector<char> in;
+        std::vector<unsigned char> out;
+        bool done{false};
+        GzipWriter *owner{nullptr};
+        IndexEntry entry{};
+    };
+    /* Implementation */
+
+  private:
+    auto submit() -> void;
+    auto writeDone(size_t maxInFlight) -> void;
+    /* write finished blocks in order,
+     * waiting until no more than 'maxInFlight' are left */
+
+    friend class GzipPool;
+    auto finished(Block &block) -> void;
+
+    const std::string filePath;
+    TraceOutput out;
+    const size_t blockSize;
+    bool wroteAny{false};
+
+    FILE *indexFile{nullptr};
+    uint64_t inBytes{0};
+    uint64_t outBytes{0};
+    /* indexed output */
+
+    std::unique_ptr<Block> current;
+    std::deque<std::unique_ptr<Block>> inFlight;
+    std::vector<std::unique_ptr<Block>> spare;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    /* signals finished blocks */
+};
+
+}; //end namespace STGen
+
+#endif
@@ -0,0 +1,91 @@
+#include "RawLogger.hpp"
+#include "Core/SigiLog.hpp"
+#include <limits>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+namespace
+{
+
+auto saturate32(StatCounter count) -> uint32_t
+{
+    constexpr uint32_t max = std::numeric_limits<uint32_t>::max();
+    return count > max ? max : count;
+}
+
+auto rawFilePath(TID tid, std::string outputPath, bool gzip) -> std::string
+{
+    return (outputPath + "/sigil.events.out-" + std::to_string(tid) +
+            (gzip == true ? ".raw.gz" : ".raw"));
+}
+
+}; //end namespace
+
+
+RawLoggerUncompressed::RawLoggerUncompressed(TID tid, std::string outputPath, bool gzip)
+    : out(rawFilePath(tid, outputPath, gzip), tid, gzip, &pos)
+{
+    assert(tid >= 1);
+}
+
+
+RawLoggerUncompressed::~RawLoggerUncompressed()
+{
+    /* RawWriter destructor finishes the file */
+}
+
+
+auto RawLoggerUncompressed::flush(StatCounter iops, StatCounter flops,
+                                  STCompEventUncompressed::MemType type, Addr start, Addr end,
+                                  EID eid, TID tid) -> void
+{
+    (void)tid;
+
+    out.put({RawEvent::COMP, static_cast<uint8_t>(type), 0,
+             saturate32(iops), saturate32(flops), 0,
+             start, end});
+    pos.onEvent(eid);
+}
+
+
+auto RawLoggerUncompressed::flush(EID producerEID, TID producerTID, Addr start, Addr end,
+                                  EID eid, TID tid) -> void
+{
+    (void)tid;
+
+    out.put({RawEvent::COMM, 0, 0,
+             static_cast<uint32_t>(producerTID),
+             static_cast<uint32_t>(producerEID),
+             static_cast<uint32_t>(producerEID >> 32),
+             start, end});
+    pos.onEvent(eid);
+}
+
+
+auto RawLoggerUncompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
+                                  EID eid, TID tid) -> void
+{
+    (void)tid;
+
+    /* Only the first two arguments are kept;
+     * condition waits are the only sync events that use a second */
+    assert(numArgs > 0);
+    out.put({RawEvent::SYNC, syncType, 0,
+             numArgs, 0, 0,
+             syncArgs[0], numArgs > 1 ? syncArgs[1] : 0});
+    pos.onSync(syncType, eid);
+}
+
+
+auto RawLoggerUncompressed::instrMarker(int limit) -> void
+{
+    out.put({RawEvent::MARKER, 0, 0,
+             static_cast<uint32_t>(limit), 0, 0,
+             0, 0});
+    pos.onMarker(limit);
+}
+
+}; //end namespace STGen
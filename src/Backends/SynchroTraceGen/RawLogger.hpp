@@ -0,0 +1,37 @@
+#ifndef STGEN_RAW_LOGGER_H
+#define STGEN_RAW_LOGGER_H
+
+#include "STLogger.hpp"
+#include "RawTrace.hpp"
+
+namespace STGen
+{
+
+class RawLoggerUncompressed : public STLoggerUncompressed
+{
+    /* Writes each event as a fixed-width binary record.
+     * See RawTrace.hpp for the layout.
+     * Each new logger writes to a new file */
+  public:
+    RawLoggerUncompressed(TID tid, std::string outputPath, bool gzip);
+    RawLoggerUncompressed(const RawLoggerUncompressed& other) = delete;
+    ~RawLoggerUncompressed() override final;
+
+    auto flush(StatCounter iops, StatCounter flops,
+               STCompEventUncompressed::MemType type, Addr start, Addr end,
+               EID eid, TID tid) -> void override final;
+    auto flush(EID producerEID, TID producerTID, Addr start, Addr end,
+               EID eid, TID tid) -> void override final;
+    auto flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
+               EID eid, TID tid) -> void override final;
+    auto instrMarker(int limit) -> void override final;
+
+  private:
+    TracePosition pos;
+    RawWriter out;
+    /* gzipped traces are indexed */
+};
+
+}; //end namespace STGen
+
+#endif
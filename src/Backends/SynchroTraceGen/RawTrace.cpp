@@ -0,0 +1,129 @@
+#include "RawTrace.hpp"
+#include "Core/SigiLog.hpp"
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+RawWriter::RawWriter(std::string filePath, uint32_t tid, bool gzip,
+                     const TracePosition *pos)
+    : filePath(filePath)
+    , pos(pos)
+{
+    static_assert(windowBytes % sizeof(RawEvent) == 0, "partial event in window");
+    static_assert(bufferBytes % sizeof(RawEvent) == 0, "partial event in buffer");
+
+    if (gzip == true || TraceOutput::streaming() == true)
+    {
+        if (gzip == true)
+            gz = std::make_unique<GzipWriter>(filePath, pos != nullptr);
+        else
+            stream = std::make_unique<TraceOutput>(filePath);
+        buffer.reset(new RawEvent[bufferBytes / sizeof(RawEvent)]);
+        begin = cur = buffer.get();
+        end = begin + bufferBytes / sizeof(RawEvent);
+    }
+    else
+    {
+        fd = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            fatal("opening raw trace: " + filePath + ": " + strerror(errno));
+        map();
+    }
+
+    RawHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "STGENRAW", sizeof(header.magic));
+    header.version = rawTraceVersion;
+    header.headerBytes = sizeof(RawHeader);
+    header.eventBytes = sizeof(RawEvent);
+    header.byteOrder = 0x0102;
+    header.tid = tid;
+
+    /* the header takes the first event slot */
+    memcpy(cur++, &header, sizeof(header));
+}
+
+
+RawWriter::~RawWriter()
+{
+    if (gz != nullptr)
+    {
+        gz->write(begin, (cur - begin) * sizeof(RawEvent));
+        gz.reset();
+        return;
+    }
+    if (stream != nullptr)
+    {
+        stream->write(begin, (cur - begin) * sizeof(RawEvent));
+        stream.reset();
+        return;
+    }
+
+    /* cut the file back to the events actually written */
+    uint64_t fileBytes = windowOffset + (cur - begin) * sizeof(RawEvent);
+    unmap();
+    if (ftruncate(fd, fileBytes) != 0)
+        fatal("truncating raw trace: " + filePath + ": " + strerror(errno));
+    if (close(fd) != 0)
+        fatal("closing raw trace: " + filePath + ": " + strerror(errno));
+}
+
+
+auto RawWriter::advance() -> void
+{
+    assert(cur == end);
+    if (gz != nullptr)
+    {
+        gz->write(begin, (cur - begin) * sizeof(RawEvent));
+        if (pos != nullptr)
+            gz->mark(*pos);
+        cur = begin;
+    }
+    else if (stream != nullptr)
+    {
+        stream->write(begin, (cur - begin) * sizeof(RawEvent));
+        cur = begin;
+    }
+    else
+    {
+        unmap();
+        windowOffset += windowBytes;
+        map();
+    }
+}
+
+
+auto RawWriter::map() -> void
+{
+    /* extend the file to cover the window; the new pages read as zero
+     * and are only backed once written */
+    if (ftruncate(fd, windowOffset + windowBytes) != 0)
+        fatal("extending raw trace: " + filePath + ": " + strerror(errno));
+
+    void *window = mmap(nullptr, windowBytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, windowOffset);
+    if (window == MAP_FAILED)
+        fatal("mapping raw trace: " + filePath + ": " + strerror(errno));
+
+    begin = cur = static_cast<RawEvent*>(window);
+    end = begin + windowBytes / sizeof(RawEvent);
+}
+
+
+auto RawWriter::unmap() -> void
+{
+    /* dirty pages are written back by the kernel */
+    if (munmap(begin, windowBytes) != 0)
+        fatal("unmapping raw trace: " + filePath + ": " + strerror(errno));
+    begin = cur = end = nullptr;
+}
+
+}; //end namespace STGen
@@ -0,0 +1,128 @@
+#ifndef STGEN_RAW_TRACE_H
+#define STGEN_RAW_TRACE_H
+
+#include "ParallelGzip.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/* Raw SynchroTraceGen trace format, for uncompressed (-c 1) traces.
+ *
+ * A raw trace is a RawHeader, followed by one fixed-width RawEvent per
+ * event, in the writing machine's byte order. Both are 32 bytes, so a
+ * trace can be mapped and indexed directly as an array of RawEvents,
+ * with the header at index 0.
+ *
+ * Event IDs are implicit: every event except MARKER takes the next
+ * event ID, starting from 0.
+ *
+ * Simulators can include this header directly to read the layout */
+
+namespace STGen
+{
+
+constexpr uint16_t rawTraceVersion = 1;
+
+struct RawHeader
+{
+    char magic[8];          /* "STGENRAW" */
+    uint16_t version;       /* rawTraceVersion */
+    uint16_t headerBytes;   /* sizeof(RawHeader) */
+    uint16_t eventBytes;    /* sizeof(RawEvent) */
+    uint16_t byteOrder;     /* 0x0102, in the writer's byte order */
+    uint32_t tid;
+    uint32_t reserved[3];
+};
+
+
+struct RawEvent
+{
+    enum Type : uint8_t
+    {
+        COMP   = 0,
+        COMM   = 1,
+        SYNC   = 2,
+        MARKER = 3,
+    };
+
+    uint8_t type;
+    uint8_t subtype;
+    /* COMP:   memory access type; 0 none, 1 read, 2 write
+     * SYNC:   SynchroTrace sync type (pth_ty) */
+
+    uint16_t reserved;
+
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+    /* COMP:   iops, flops (saturated to 32 bits)
+     * COMM:   producer thread, producer event bits 0-31, bits 32-47
+     * SYNC:   number of sync arguments
+     * MARKER: instructions since the last marker */
+
+    uint64_t start;
+    uint64_t end;
+    /* COMP/COMM: address range, inclusive
+     * SYNC:      first and second sync argument */
+};
+
+static_assert(sizeof(RawHeader) == 32, "raw trace header layout changed");
+static_assert(sizeof(RawEvent) == 32, "raw trace event layout changed");
+
+
+class RawWriter
+{
+    /* Writes a raw trace.
+     *
+     * Uncompressed traces are written straight into a window of the
+     * output file mapped into memory; no intermediate copy is made.
+     * With 'gzip', events are staged in a buffer and compressed in
+     * blocks by a GzipWriter instead. Given a trace position, the gzipped
+     * trace is indexed; 'pos' must hold the position of the next event.
+     * When streaming (see TraceOutput.hpp), uncompressed events are staged
+     * in the same buffer and sent to the stream.
+     *
+     * A single writer is not thread safe; calls must be serialized */
+  public:
+    static constexpr size_t windowBytes = 64 << 20;
+    static constexpr size_t bufferBytes = 1 << 20;
+
+    RawWriter(std::string filePath, uint32_t tid, bool gzip,
+              const TracePosition *pos = nullptr);
+    RawWriter(const RawWriter &) = delete;
+    RawWriter &operator=(const RawWriter &) = delete;
+    ~RawWriter();
+
+    auto put(const RawEvent &ev) -> void
+    {
+        if (cur == end)
+            advance();
+        *cur++ = ev;
+    }
+
+  private:
+    auto advance() -> void;
+    /* the current window or buffer is full */
+    auto map() -> void;
+    auto unmap() -> void;
+
+    const std::string filePath;
+
+    std::unique_ptr<GzipWriter> gz;
+    std::unique_ptr<TraceOutput> stream;
+    std::unique_ptr<RawEvent[]> buffer;
+    const TracePosition *pos;
+    /* compressed or streamed output */
+
+    int fd{-1};
+    uint64_t windowOffset{0};
+    /* mapped output */
+
+    RawEvent *begin{nullptr};
+    RawEvent *cur{nullptr};
+    RawEvent *end{nullptr};
+};
+
+}; //end namespace STGen
+
+#endif
@@ -0,0 +1,185 @@
+#include "RepeatLogger.hpp"
+#include <limits>
+
+namespace STGen
+{
+
+namespace
+{
+
+unsigned maxRepeatPeriod{0};
+/* set once, before any threads log events */
+
+constexpr unsigned maxRunEvents = std::numeric_limits<uint32_t>::max();
+
+
+auto movedRanges(const AddrSet::Ranges &ranges, const AddrSet::Ranges &from,
+                 bool &strideKnown, int64_t &stride) -> bool
+{
+    /* Address arithmetic wraps, so any pair of ranges has an exact stride */
+    if (ranges.size() != from.size())
+        return false;
+
+    for (size_t i=0; i<ranges.size(); ++i)
+    {
+        uint64_t moved = ranges[i].first - from[i].first;
+        if (ranges[i].second - from[i].second != moved)
+            return false;
+        if (strideKnown == true && static_cast<uint64_t>(stride) != moved)
+            return false;
+        strideKnown = true;
+        stride = static_cast<int64_t>(moved);
+    }
+    return true;
+}
+
+
+auto isRepeat(const STCompEventCompressed &ev, const STCompEventCompressed &from,
+              bool &strideKnown, int64_t &stride) -> bool
+{
+    /* Only updates the stride on a match */
+    if (ev.iops != from.iops || ev.flops != from.flops ||
+        ev.reads != from.reads || ev.writes != from.writes)
+        return false;
+
+    bool known = strideKnown;
+    int64_t moved = stride;
+    if (movedRanges(ev.uniqueWriteAddrs.get(), from.uniqueWriteAddrs.get(), known, moved) == false ||
+        movedRanges(ev.uniqueReadAddrs.get(), from.uniqueReadAddrs.get(), known, moved) == false)
+        return false;
+
+    strideKnown = known;
+    stride = moved;
+    return true;
+}
+
+}; //end namespace
+
+
+auto RepeatLoggerCompressed::configure(unsigned maxPeriod) -> void
+{
+    maxRepeatPeriod = maxPeriod;
+}
+
+
+auto RepeatLoggerCompressed::maxPeriod() -> unsigned
+{
+    return maxRepeatPeriod;
+}
+
+
+RepeatLoggerCompressed::RepeatLoggerCompressed(std::unique_ptr<STLoggerCompressed> logger)
+    : logger(std::move(logger))
+{
+    assert(maxRepeatPeriod > 0);
+}
+
+
+RepeatLoggerCompressed::~RepeatLoggerCompressed()
+{
+    endRun();
+}
+
+
+auto RepeatLoggerCompressed::flush(const STCompEventCompressed& ev, EID eid, TID tid) -> void
+{
+    runTID = tid;
+
+    if (period > 0)
+    {
+        if (runEvents < maxRunEvents && eid == runStart + runEvents &&
+            isRepeat(ev, history[history.size() - period], strideKnown, stride) == true)
+        {
+            ++runEvents;
+            remember(ev);
+            return;
+        }
+        endRun();
+    }
+
+    if (startRun(ev, eid) == false)
+        logger->flush(ev, eid, tid);
+    remember(ev);
+}
+
+
+auto RepeatLoggerCompressed::flush(const STCommEventCompressed& ev, EID eid, TID tid) -> void
+{
+    endRun();
+    history.clear();
+    logger->flush(ev, eid, tid);
+}
+
+
+auto RepeatLoggerCompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
+                                   EID eid, TID tid) -> void
+{
+    endRun();
+    history.clear();
+    logger->flush(syncType, numArgs, syncArgs, eid, tid);
+}
+
+
+auto RepeatLoggerCompressed::instrMarker(int limit) -> void
+{
+    /* the marker must stay between the events on either side of it */
+    endRun();
+    logger->instrMarker(limit);
+}
+
+
+auto RepeatLoggerCompressed::repeat(unsigned events, unsigned period, int64_t stride,
+                                    EID eid, TID tid) -> void
+{
+    /* already folded upstream; nothing to fold it against */
+    endRun();
+    history.clear();
+    logger->repeat(events, period, stride, eid, tid);
+}
+
+
+auto RepeatLoggerCompressed::startRun(const STCompEventCompressed& ev, EID eid) -> bool
+{
+    /* prefer the shortest period */
+    for (unsigned p=1; p<=history.size(); ++p)
+    {
+        bool known = false;
+        int64_t moved = 0;
+        if (isRepeat(ev, history[history.size() - p], known, moved) == true)
+        {
+            period = p;
+            runEvents = 1;
+            strideKnown = known;
+            stride = moved;
+            runStart = eid;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+auto RepeatLoggerCompressed::endRun() -> void
+{
+    if (period == 0)
+        return;
+
+    /* a lone repeat is no smaller than the event itself */
+    if (runEvents == 1)
+        logger->flush(history.back(), runStart, runTID);
+    else
+        logger->repeat(runEvents, period, strideKnown == true ? stride : 0, runStart, runTID);
+
+    period = 0;
+    runEvents = 0;
+}
+
+
+auto RepeatLoggerCompressed::remember(const STCompEventCompressed& ev) -> void
+{
+    history.push_back(ev);
+    if (history.size() > maxRepeatPeriod)
+        history.pop_front();
+}
+
+}; //end namespace STGen
@@ -0,0 +1,67 @@
+#ifndef STGEN_REPEAT_LOGGER_H
+#define STGEN_REPEAT_LOGGER_H
+
+#include "STLogger.hpp"
+#include <deque>
+#include <memory>
+
+namespace STGen
+{
+
+class RepeatLoggerCompressed : public STLoggerCompressed
+{
+    /* Folds repeated Compute Events into repeat records before they
+     * reach the wrapped logger.
+     *
+     * A Compute Event repeats the one 'period' events before it when
+     * the counts match and every address range is moved by the same
+     * stride, e.g. each iteration of a loop walking an array.
+     * A run of such events is logged as a single repeat record,
+     * which expands back to exactly the same events.
+     *
+     * Only Compute Events are folded. Communication and Synchronization
+     * Events end a run and are never repeated across. Markers end a run,
+     * but later events can still repeat the ones before the marker */
+  public:
+    static auto configure(unsigned maxPeriod) -> void;
+    /* Look for repeats of up to the last 'maxPeriod' Compute Events.
+     * Must be called before any loggers are created.
+     * Zero turns folding off */
+
+    static auto maxPeriod() -> unsigned;
+
+    RepeatLoggerCompressed(std::unique_ptr<STLoggerCompressed> logger);
+    RepeatLoggerCompressed(const RepeatLoggerCompressed& other) = delete;
+    ~RepeatLoggerCompressed() override final;
+
+    auto flush(const STCompEventCompressed& ev, EID eid, TID tid) -> void override final;
+    auto flush(const STCommEventCompressed& ev, EID eid, TID tid) -> void override final;
+    auto flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
+               EID eid, TID tid) -> void override final;
+    auto instrMarker(int limit) -> void override final;
+    auto repeat(unsigned events, unsigned period, int64_t stride,
+                EID eid, TID tid) -> void override final;
+
+  private:
+    auto startRun(const STCompEventCompressed& ev, EID eid) -> bool;
+    auto endRun() -> void;
+    auto remember(const STCompEventCompressed& ev) -> void;
+
+    std::unique_ptr<STLoggerCompressed> logger;
+
+    std::deque<STCompEventCompressed> history;
+    /* the last Compute Events, as they expand, oldest first */
+
+    unsigned period{0};
+    unsigned runEvents{0};
+    bool strideKnown{false};
+    int64_t stride{0};
+    EID runStart{0};
+    TID runTID{0};
+    /* The current run, if 'period' is non-zero.
+     * The stride is unknown until an event with addresses joins the run */
+};
+
+}; //end namespace STGen
+
+#endif
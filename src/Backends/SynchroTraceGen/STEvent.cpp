@@ -77,27 +77,46 @@ auto STCompEventUncompressed::reset() -> void
 //-----------------------------------------------------------------------------
 /** Communication Event **/
 auto STCommEventCompressed::addEdge(const TID writer, const EID writer_event,
-                                    const Addr addr) -> void
+                                    const Addr begin, const Addr end) -> void
 {
     isActive = true;
 
-    if (comms.empty())
+    /* reads usually continue with the most recent producer */
+    if (comms.empty() == false &&
+        std::get<0>(comms.back()) == writer && std::get<1>(comms.back()) == writer_event)
     {
-        comms.push_back(std::make_tuple(writer, writer_event, AddrSet(std::make_pair(addr, addr))));
+        std::get<2>(comms.back()).insert(std::make_pair(begin, end));
+        return;
     }
-    else
+
+    if (comms.size() < maxLinearScanEdges)
     {
         for (auto &edge : comms)
         {
             if (std::get<0>(edge) == writer && std::get<1>(edge) == writer_event)
             {
-                std::get<2>(edge).insert(std::make_pair(addr, addr));
+                std::get<2>(edge).insert(std::make_pair(begin, end));
                 return;
             }
         }
+    }
+    else
+    {
+        if (edgeIdx.empty() == true)
+        {
+            for (size_t i = 0; i < comms.size(); ++i)
+                edgeIdx.emplace(std::make_pair(std::get<0>(comms[i]), std::get<1>(comms[i])), i);
+        }
 
-        comms.push_back(std::make_tuple(writer, writer_event, AddrSet(std::make_pair(addr, addr))));
+        auto p = edgeIdx.emplace(std::make_pair(writer, writer_event), comms.size());
+        if (p.second == false)
+        {
+            std::get<2>(comms[p.first->second]).insert(std::make_pair(begin, end));
+            return;
+        }
     }
+
+    comms.emplace_back(writer, writer_event, AddrSet(std::make_pair(begin, end)));
 }
 
 
@@ -105,6 +124,7 @@ auto STCommEventCompressed::reset() -> void
 {
     isActive = false;
     comms.clear();
+    edgeIdx.clear();
 }
 
 }; //end namespace STGen
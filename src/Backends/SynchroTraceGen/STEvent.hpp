@@ -6,6 +6,7 @@
 #include "STEventTraceUncompressed.capnp.h"
 #include "spdlog/spdlog.h"
 #include <vector>
+#include <unordered_map>
 
 /******************************************************************************
  * SynchroTrace Events
@@ -94,15 +95,13 @@ struct STCommEventCompressed
      * Adds communication edges originated from a single load/read primitive.
      * Use this function when reading data that was written by a different thread.
      *
-     * Expected to by called byte-by-byte.
-     * That is, successive calls to this function imply a continuity
-     * between addresses. If the first call specifies address 0x0000,
-     * and the next call specifies address 0x0008, then it implies
-     * addresses 0x0000-0x0008 were all read, instead of non-consecutively read.
+     * Expected to be called once per run of consecutive bytes [begin, end]
+     * that were all last written by the same producer thread and event,
+     * rather than byte-by-byte.
      *
      * Use STEvent::flush() between different read primitives.
      */
-    auto addEdge(TID writer, EID writer_event, Addr addr) -> void;
+    auto addEdge(TID writer, EID writer_event, Addr begin, Addr end) -> void;
     auto reset() -> void;
 
     /**
@@ -116,6 +115,20 @@ struct STCommEventCompressed
     LoadEdges comms;
 
     bool isActive{false};
+
+  private:
+    struct EdgeKeyHash
+    {
+        auto operator()(const std::pair<TID, EID> &key) const -> size_t
+        {
+            return std::hash<EID>()(key.second) * 31 + std::hash<TID>()(key.first);
+        }
+    };
+
+    std::unordered_map<std::pair<TID, EID>, size_t, EdgeKeyHash> edgeIdx;
+    /* Index into 'comms' for events with many producers.
+     * Only built once 'comms' outgrows a linear scan */
+    static constexpr size_t maxLinearScanEdges = 8;
 };
 
 }; //end namespace STGen
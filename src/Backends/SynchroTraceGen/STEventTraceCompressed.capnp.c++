@@ -62,17 +62,17 @@ const ::capnp::_::RawSchema s_e57f0f2c60992cf5 = {
   1, 1, i_e57f0f2c60992cf5, nullptr, nullptr, { &s_e57f0f2c60992cf5, nullptr, nullptr, 0, 0, nullptr }
 };
 #endif  // !CAPNP_LITE
-static const ::capnp::_::AlignedData<66> b_a549639de263753a = {
+static const ::capnp::_::AlignedData<74> b_a549639de263753a = {
   {   0,   0,   0,   0,   5,   0,   6,   0,
      58, 117,  99, 226, 157,  99,  73, 165,
      51,   0,   0,   0,   1,   0,   2,   0,
     245,  44, 153,  96,  44,  15, 127, 229,
-      2,   0,   7,   0,   0,   0,   4,   0,
+      2,   0,   7,   0,   0,   0,   5,   0,
       4,   0,   0,   0,   0,   0,   0,   0,
      21,   0,   0,   0, 202,   1,   0,   0,
      49,   0,   0,   0,  55,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     93,   0,   0,   0, 231,   0,   0,   0,
+     93,   0,   0,   0,  31,   1,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
      83,  84,  69, 118, 101, 110, 116,  84,
@@ -96,39 +96,47 @@ static const ::capnp::_::AlignedData<66> b_a549639de263753a = {
       0,   0,   0,   0,   0,   0,   0,   0,
      83, 121, 110,  99,  84, 121, 112, 101,
       0,   0,   0,   0,   0,   0,   0,   0,
-     16,   0,   0,   0,   3,   0,   4,   0,
+     20,   0,   0,   0,   3,   0,   4,   0,
       0,   0, 255, 255,   0,   0,   0,   0,
       1,   0,   0,   0,   0,   0,   0,   0,
      35, 220, 208, 232, 250,  49, 191, 210,
-     97,   0,   0,   0,  42,   0,   0,   0,
+    125,   0,   0,   0,  42,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       1,   0, 254, 255,   0,   0,   0,   0,
       1,   0,   0,   0,   0,   0,   0,   0,
      27, 115, 226,  99, 194, 149, 116, 149,
-     73,   0,   0,   0,  42,   0,   0,   0,
+    101,   0,   0,   0,  42,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       2,   0, 253, 255,   0,   0,   0,   0,
       1,   0,   0,   0,   0,   0,   0,   0,
      11,  74,  11, 206, 159,  10, 155, 141,
-     49,   0,   0,   0,  42,   0,   0,   0,
+     77,   0,   0,   0,  42,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       3,   0, 252, 255,   0,   0,   0,   0,
       1,   0,   0,   0,   0,   0,   0,   0,
     232, 217,  49, 200, 135,  63,  69, 134,
-     25,   0,   0,   0,  58,   0,   0,   0,
+     53,   0,   0,   0,  58,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      4,   0, 251, 255,   0,   0,   0,   0,
+      1,   0,   0,   0,   0,   0,   0,   0,
+    203, 105,  76, 145, 247,  94, 143, 222,
+     29,   0,   0,   0,  58,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
      99, 111, 109, 112,   0,   0,   0,   0,
      99, 111, 109, 109,   0,   0,   0,   0,
     115, 121, 110,  99,   0,   0,   0,   0,
-    109,  97, 114, 107, 101, 114,   0,   0, }
+    109,  97, 114, 107, 101, 114,   0,   0,
+    114, 101, 112, 101,  97, 116,   0,   0, }
 };
 ::capnp::word const* const bp_a549639de263753a = b_a549639de263753a.words;
 #if !CAPNP_LITE
@@ -137,12 +145,13 @@ static const ::capnp::_::RawSchema* const d_a549639de263753a[] = {
   &s_8d9b0a9fce0b4a0b,
   &s_957495c263e2731b,
   &s_d2bf31fae8d0dc23,
+  &s_de8f5ef7914c69cb,
 };
-static const uint16_t m_a549639de263753a[] = {1, 0, 3, 2};
-static const uint16_t i_a549639de263753a[] = {0, 1, 2, 3};
+static const uint16_t m_a549639de263753a[] = {1, 0, 3, 4, 2};
+static const uint16_t i_a549639de263753a[] = {0, 1, 2, 3, 4};
 const ::capnp::_::RawSchema s_a549639de263753a = {
-  0xa549639de263753a, b_a549639de263753a.words, 66, d_a549639de263753a, m_a549639de263753a,
-  4, 4, i_a549639de263753a, nullptr, nullptr, { &s_a549639de263753a, nullptr, nullptr, 0, 0, nullptr }
+  0xa549639de263753a, b_a549639de263753a.words, 74, d_a549639de263753a, m_a549639de263753a,
+  5, 5, i_a549639de263753a, nullptr, nullptr, { &s_a549639de263753a, nullptr, nullptr, 0, 0, nullptr }
 };
 #endif  // !CAPNP_LITE
 static const ::capnp::_::AlignedData<53> b_de81bb8c1098c164 = {
@@ -209,7 +218,7 @@ const ::capnp::_::RawSchema s_de81bb8c1098c164 = {
   0, 2, i_de81bb8c1098c164, nullptr, nullptr, { &s_de81bb8c1098c164, nullptr, nullptr, 0, 0, nullptr }
 };
 #endif  // !CAPNP_LITE
-static const ::capnp::_::AlignedData<74> b_87e1459470df7904 = {
+static const ::capnp::_::AlignedData<90> b_87e1459470df7904 = {
   {   0,   0,   0,   0,   5,   0,   6,   0,
       4, 121, 223, 112, 148,  69, 225, 135,
      57,   0,   0,   0,   1,   0,   1,   0,
@@ -219,7 +228,7 @@ static const ::capnp::_::AlignedData<74> b_87e1459470df7904 = {
      21,   0,   0,   0,  18,   2,   0,   0,
      53,   0,   0,   0,   7,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     49,   0,   0,   0, 175,   0,   0,   0,
+     49,   0,   0,   0, 231,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
      83,  84,  69, 118, 101, 110, 116,  84,
@@ -232,28 +241,35 @@ static const ::capnp::_::AlignedData<74> b_87e1459470df7904 = {
      46,  67, 111, 109, 109,  69, 100, 103,
     101,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   1,   0,   1,   0,
-     12,   0,   0,   0,   3,   0,   4,   0,
+     16,   0,   0,   0,   3,   0,   4,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   1,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     69,   0,   0,   0, 122,   0,   0,   0,
+     97,   0,   0,   0, 122,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     68,   0,   0,   0,   3,   0,   1,   0,
-     80,   0,   0,   0,   2,   0,   1,   0,
+     96,   0,   0,   0,   3,   0,   1,   0,
+    108,   0,   0,   0,   2,   0,   1,   0,
       1,   0,   0,   0,   1,   0,   0,   0,
       0,   0,   1,   0,   1,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     77,   0,   0,   0, 114,   0,   0,   0,
+    105,   0,   0,   0, 114,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     76,   0,   0,   0,   3,   0,   1,   0,
-     88,   0,   0,   0,   2,   0,   1,   0,
+    104,   0,   0,   0,   3,   0,   1,   0,
+    116,   0,   0,   0,   2,   0,   1,   0,
       2,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   1,   0,   2,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     85,   0,   0,   0,  50,   0,   0,   0,
+    113,   0,   0,   0,  50,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
-     80,   0,   0,   0,   3,   0,   1,   0,
-    108,   0,   0,   0,   2,   0,   1,   0,
+    108,   0,   0,   0,   3,   0,   1,   0,
+    136,   0,   0,   0,   2,   0,   1,   0,
+      3,   0,   0,   0,   1,   0,   0,   0,
+      0,   0,   1,   0,   3,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+    133,   0,   0,   0, 130,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+    132,   0,   0,   0,   3,   0,   1,   0,
+    144,   0,   0,   0,   2,   0,   1,   0,
     112, 114, 111, 100, 117,  99, 101, 114,
      84, 104, 114, 101,  97, 100,   0,   0,
       7,   0,   0,   0,   0,   0,   0,   0,
@@ -282,6 +298,15 @@ static const ::capnp::_::AlignedData<74> b_87e1459470df7904 = {
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
      14,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+    112, 114, 111, 100, 117,  99, 101, 114,
+     69, 118, 101, 110, 116,  72, 105,   0,
+      7,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      7,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0, }
 };
@@ -290,11 +315,11 @@ static const ::capnp::_::AlignedData<74> b_87e1459470df7904 = {
 static const ::capnp::_::RawSchema* const d_87e1459470df7904[] = {
   &s_de81bb8c1098c164,
 };
-static const uint16_t m_87e1459470df7904[] = {2, 1, 0};
-static const uint16_t i_87e1459470df7904[] = {0, 1, 2};
+static const uint16_t m_87e1459470df7904[] = {2, 1, 3, 0};
+static const uint16_t i_87e1459470df7904[] = {0, 1, 2, 3};
 const ::capnp::_::RawSchema s_87e1459470df7904 = {
-  0x87e1459470df7904, b_87e1459470df7904.words, 74, d_87e1459470df7904, m_87e1459470df7904,
-  1, 3, i_87e1459470df7904, nullptr, nullptr, { &s_87e1459470df7904, nullptr, nullptr, 0, 0, nullptr }
+  0x87e1459470df7904, b_87e1459470df7904.words, 90, d_87e1459470df7904, m_87e1459470df7904,
+  1, 4, i_87e1459470df7904, nullptr, nullptr, { &s_87e1459470df7904, nullptr, nullptr, 0, 0, nullptr }
 };
 #endif  // !CAPNP_LITE
 static const ::capnp::_::AlignedData<72> b_f39ea1239dd73c82 = {
@@ -691,6 +716,86 @@ const ::capnp::_::RawSchema s_86453f87c831d9e8 = {
   1, 1, i_86453f87c831d9e8, nullptr, nullptr, { &s_86453f87c831d9e8, nullptr, nullptr, 0, 0, nullptr }
 };
 #endif  // !CAPNP_LITE
+static const ::capnp::_::AlignedData<66> b_de8f5ef7914c69cb = {
+  {   0,   0,   0,   0,   5,   0,   6,   0,
+    203, 105,  76, 145, 247,  94, 143, 222,
+     57,   0,   0,   0,   1,   0,   2,   0,
+     58, 117,  99, 226, 157,  99,  73, 165,
+      2,   0,   7,   0,   1,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     21,   0,   0,   0,   2,   2,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     41,   0,   0,   0, 175,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     83,  84,  69, 118, 101, 110, 116,  84,
+    114,  97,  99, 101,  67, 111, 109, 112,
+    114, 101, 115, 115, 101, 100,  46,  99,
+     97, 112, 110, 112,  58,  69, 118, 101,
+    110, 116,  83, 116, 114, 101,  97, 109,
+     67, 111, 109, 112, 114, 101, 115, 115,
+    101, 100,  46,  69, 118, 101, 110, 116,
+     46, 114, 101, 112, 101,  97, 116,   0,
+     12,   0,   0,   0,   3,   0,   4,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   1,   0,  10,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     69,   0,   0,   0,  58,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     64,   0,   0,   0,   3,   0,   1,   0,
+     76,   0,   0,   0,   2,   0,   1,   0,
+      1,   0,   0,   0,   3,   0,   0,   0,
+      0,   0,   1,   0,  11,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     73,   0,   0,   0,  58,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     68,   0,   0,   0,   3,   0,   1,   0,
+     80,   0,   0,   0,   2,   0,   1,   0,
+      2,   0,   0,   0,   5,   0,   0,   0,
+      0,   0,   1,   0,  12,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     77,   0,   0,   0,  58,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+     72,   0,   0,   0,   3,   0,   1,   0,
+     84,   0,   0,   0,   2,   0,   1,   0,
+    115, 116, 114, 105, 100, 101,   0,   0,
+      5,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+    101, 118, 101, 110, 116, 115,   0,   0,
+      8,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      8,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+    112, 101, 114, 105, 111, 100,   0,   0,
+      7,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      7,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0, }
+};
+::capnp::word const* const bp_de8f5ef7914c69cb = b_de8f5ef7914c69cb.words;
+#if !CAPNP_LITE
+static const ::capnp::_::RawSchema* const d_de8f5ef7914c69cb[] = {
+  &s_a549639de263753a,
+};
+static const uint16_t m_de8f5ef7914c69cb[] = {1, 2, 0};
+static const uint16_t i_de8f5ef7914c69cb[] = {0, 1, 2};
+const ::capnp::_::RawSchema s_de8f5ef7914c69cb = {
+  0xde8f5ef7914c69cb, b_de8f5ef7914c69cb.words, 66, d_de8f5ef7914c69cb, m_de8f5ef7914c69cb,
+  1, 3, i_de8f5ef7914c69cb, nullptr, nullptr, { &s_de8f5ef7914c69cb, nullptr, nullptr, 0, 0, nullptr }
+};
+#endif  // !CAPNP_LITE
 }  // namespace schemas
 }  // namespace capnp
 
@@ -761,5 +866,13 @@ constexpr ::capnp::Kind EventStreamCompressed::Event::Marker::_capnpPrivate::kin
 constexpr ::capnp::_::RawSchema const* EventStreamCompressed::Event::Marker::_capnpPrivate::schema;
 #endif  // !CAPNP_LITE
 
+// EventStreamCompressed::Event::Repeat
+constexpr uint16_t EventStreamCompressed::Event::Repeat::_capnpPrivate::dataWordSize;
+constexpr uint16_t EventStreamCompressed::Event::Repeat::_capnpPrivate::pointerCount;
+#if !CAPNP_LITE
+constexpr ::capnp::Kind EventStreamCompressed::Event::Repeat::_capnpPrivate::kind;
+constexpr ::capnp::_::RawSchema const* EventStreamCompressed::Event::Repeat::_capnpPrivate::schema;
+#endif  // !CAPNP_LITE
+
 
 
@@ -37,6 +37,7 @@ CAPNP_DECLARE_SCHEMA(d2bf31fae8d0dc23);
 CAPNP_DECLARE_SCHEMA(957495c263e2731b);
 CAPNP_DECLARE_SCHEMA(8d9b0a9fce0b4a0b);
 CAPNP_DECLARE_SCHEMA(86453f87c831d9e8);
+CAPNP_DECLARE_SCHEMA(de8f5ef7914c69cb);
 
 }  // namespace schemas
 }  // namespace capnp
@@ -69,6 +70,7 @@ struct EventStreamCompressed::Event {
     COMM,
     SYNC,
     MARKER,
+    REPEAT,
   };
   struct AddrRange;
   struct CommEdge;
@@ -78,6 +80,7 @@ struct EventStreamCompressed::Event {
   struct Comm;
   struct Sync;
   struct Marker;
+  struct Repeat;
 
   struct _capnpPrivate {
     CAPNP_DECLARE_STRUCT_HEADER(a549639de263753a, 2, 2)
@@ -177,6 +180,21 @@ struct EventStreamCompressed::Event::Marker {
   };
 };
 
+struct EventStreamCompressed::Event::Repeat {
+  Repeat() = delete;
+
+  class Reader;
+  class Builder;
+  class Pipeline;
+
+  struct _capnpPrivate {
+    CAPNP_DECLARE_STRUCT_HEADER(de8f5ef7914c69cb, 2, 2)
+    #if !CAPNP_LITE
+    static constexpr ::capnp::_::RawBrandedSchema const* brand() { return &schema->defaultBrand; }
+    #endif  // !CAPNP_LITE
+  };
+};
+
 // =======================================================================================
 
 class EventStreamCompressed::Reader {
@@ -290,6 +308,9 @@ public:
   inline bool isMarker() const;
   inline typename Marker::Reader getMarker() const;
 
+  inline bool isRepeat() const;
+  inline typename Repeat::Reader getRepeat() const;
+
 private:
   ::capnp::_::StructReader _reader;
   template <typename, ::capnp::Kind>
@@ -335,6 +356,10 @@ public:
   inline typename Marker::Builder getMarker();
   inline typename Marker::Builder initMarker();
 
+  inline bool isRepeat();
+  inline typename Repeat::Builder getRepeat();
+  inline typename Repeat::Builder initRepeat();
+
 private:
   ::capnp::_::StructBuilder _builder;
   template <typename, ::capnp::Kind>
@@ -466,6 +491,8 @@ public:
   inline bool hasAddrs() const;
   inline  ::capnp::List< ::EventStreamCompressed::Event::AddrRange>::Reader getAddrs() const;
 
+  inline  ::uint16_t getProducerEventHi() const;
+
 private:
   ::capnp::_::StructReader _reader;
   template <typename, ::capnp::Kind>
@@ -507,6 +534,9 @@ public:
   inline void adoptAddrs(::capnp::Orphan< ::capnp::List< ::EventStreamCompressed::Event::AddrRange>>&& value);
   inline ::capnp::Orphan< ::capnp::List< ::EventStreamCompressed::Event::AddrRange>> disownAddrs();
 
+  inline  ::uint16_t getProducerEventHi();
+  inline void setProducerEventHi( ::uint16_t value);
+
 private:
   ::capnp::_::StructBuilder _builder;
   template <typename, ::capnp::Kind>
@@ -888,6 +918,92 @@ private:
 };
 #endif  // !CAPNP_LITE
 
+class EventStreamCompressed::Event::Repeat::Reader {
+public:
+  typedef Repeat Reads;
+
+  Reader() = default;
+  inline explicit Reader(::capnp::_::StructReader base): _reader(base) {}
+
+  inline ::capnp::MessageSize totalSize() const {
+    return _reader.totalSize().asPublic();
+  }
+
+#if !CAPNP_LITE
+  inline ::kj::StringTree toString() const {
+    return ::capnp::_::structString(_reader, *_capnpPrivate::brand());
+  }
+#endif  // !CAPNP_LITE
+
+  inline  ::int64_t getStride() const;
+
+  inline  ::uint32_t getEvents() const;
+
+  inline  ::uint16_t getPeriod() const;
+
+private:
+  ::capnp::_::StructReader _reader;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::ToDynamic_;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::_::PointerHelpers;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::List;
+  friend class ::capnp::MessageBuilder;
+  friend class ::capnp::Orphanage;
+};
+
+class EventStreamCompressed::Event::Repeat::Builder {
+public:
+  typedef Repeat Builds;
+
+  Builder() = delete;  // Deleted to discourage incorrect usage.
+                       // You can explicitly initialize to nullptr instead.
+  inline Builder(decltype(nullptr)) {}
+  inline explicit Builder(::capnp::_::StructBuilder base): _builder(base) {}
+  inline operator Reader() const { return Reader(_builder.asReader()); }
+  inline Reader asReader() const { return *this; }
+
+  inline ::capnp::MessageSize totalSize() const { return asReader().totalSize(); }
+#if !CAPNP_LITE
+  inline ::kj::StringTree toString() const { return asReader().toString(); }
+#endif  // !CAPNP_LITE
+
+  inline  ::int64_t getStride();
+  inline void setStride( ::int64_t value);
+
+  inline  ::uint32_t getEvents();
+  inline void setEvents( ::uint32_t value);
+
+  inline  ::uint16_t getPeriod();
+  inline void setPeriod( ::uint16_t value);
+
+private:
+  ::capnp::_::StructBuilder _builder;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::ToDynamic_;
+  friend class ::capnp::Orphanage;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::_::PointerHelpers;
+};
+
+#if !CAPNP_LITE
+class EventStreamCompressed::Event::Repeat::Pipeline {
+public:
+  typedef Repeat Pipelines;
+
+  inline Pipeline(decltype(nullptr)): _typeless(nullptr) {}
+  inline explicit Pipeline(::capnp::AnyPointer::Pipeline&& typeless)
+      : _typeless(kj::mv(typeless)) {}
+
+private:
+  ::capnp::AnyPointer::Pipeline _typeless;
+  friend class ::capnp::PipelineHook;
+  template <typename, ::capnp::Kind>
+  friend struct ::capnp::ToDynamic_;
+};
+#endif  // !CAPNP_LITE
+
 // =======================================================================================
 
 inline bool EventStreamCompressed::Reader::hasEvents() const {
@@ -1027,6 +1143,30 @@ inline typename EventStreamCompressed::Event::Marker::Builder EventStreamCompres
   _builder.setDataField< ::uint16_t>(::capnp::bounded<0>() * ::capnp::ELEMENTS, 0);
   return typename EventStreamCompressed::Event::Marker::Builder(_builder);
 }
+inline bool EventStreamCompressed::Event::Reader::isRepeat() const {
+  return which() == EventStreamCompressed::Event::REPEAT;
+}
+inline bool EventStreamCompressed::Event::Builder::isRepeat() {
+  return which() == EventStreamCompressed::Event::REPEAT;
+}
+inline typename EventStreamCompressed::Event::Repeat::Reader EventStreamCompressed::Event::Reader::getRepeat() const {
+  KJ_IREQUIRE((which() == EventStreamCompressed::Event::REPEAT),
+              "Must check which() before get()ing a union member.");
+  return typename EventStreamCompressed::Event::Repeat::Reader(_reader);
+}
+inline typename EventStreamCompressed::Event::Repeat::Builder EventStreamCompressed::Event::Builder::getRepeat() {
+  KJ_IREQUIRE((which() == EventStreamCompressed::Event::REPEAT),
+              "Must check which() before get()ing a union member.");
+  return typename EventStreamCompressed::Event::Repeat::Builder(_builder);
+}
+inline typename EventStreamCompressed::Event::Repeat::Builder EventStreamCompressed::Event::Builder::initRepeat() {
+  _builder.setDataField<EventStreamCompressed::Event::Which>(
+      ::capnp::bounded<4>() * ::capnp::ELEMENTS, EventStreamCompressed::Event::REPEAT);
+  _builder.setDataField< ::int64_t>(::capnp::bounded<0>() * ::capnp::ELEMENTS, 0);
+  _builder.setDataField< ::uint32_t>(::capnp::bounded<3>() * ::capnp::ELEMENTS, 0);
+  _builder.setDataField< ::uint16_t>(::capnp::bounded<5>() * ::capnp::ELEMENTS, 0);
+  return typename EventStreamCompressed::Event::Repeat::Builder(_builder);
+}
 inline  ::uint64_t EventStreamCompressed::Event::AddrRange::Reader::getStart() const {
   return _reader.getDataField< ::uint64_t>(
       ::capnp::bounded<0>() * ::capnp::ELEMENTS);
@@ -1117,6 +1257,20 @@ inline ::capnp::Orphan< ::capnp::List< ::EventStreamCompressed::Event::AddrRange
       ::capnp::bounded<0>() * ::capnp::POINTERS));
 }
 
+inline  ::uint16_t EventStreamCompressed::Event::CommEdge::Reader::getProducerEventHi() const {
+  return _reader.getDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS);
+}
+
+inline  ::uint16_t EventStreamCompressed::Event::CommEdge::Builder::getProducerEventHi() {
+  return _builder.getDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS);
+}
+inline void EventStreamCompressed::Event::CommEdge::Builder::setProducerEventHi( ::uint16_t value) {
+  _builder.setDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS, value);
+}
+
 inline  ::uint16_t EventStreamCompressed::Event::Comp::Reader::getIops() const {
   return _reader.getDataField< ::uint16_t>(
       ::capnp::bounded<0>() * ::capnp::ELEMENTS);
@@ -1341,5 +1495,47 @@ inline void EventStreamCompressed::Event::Marker::Builder::setCount( ::uint16_t
       ::capnp::bounded<0>() * ::capnp::ELEMENTS, value);
 }
 
+inline  ::int64_t EventStreamCompressed::Event::Repeat::Reader::getStride() const {
+  return _reader.getDataField< ::int64_t>(
+      ::capnp::bounded<0>() * ::capnp::ELEMENTS);
+}
+
+inline  ::int64_t EventStreamCompressed::Event::Repeat::Builder::getStride() {
+  return _builder.getDataField< ::int64_t>(
+      ::capnp::bounded<0>() * ::capnp::ELEMENTS);
+}
+inline void EventStreamCompressed::Event::Repeat::Builder::setStride( ::int64_t value) {
+  _builder.setDataField< ::int64_t>(
+      ::capnp::bounded<0>() * ::capnp::ELEMENTS, value);
+}
+
+inline  ::uint32_t EventStreamCompressed::Event::Repeat::Reader::getEvents() const {
+  return _reader.getDataField< ::uint32_t>(
+      ::capnp::bounded<3>() * ::capnp::ELEMENTS);
+}
+
+inline  ::uint32_t EventStreamCompressed::Event::Repeat::Builder::getEvents() {
+  return _builder.getDataField< ::uint32_t>(
+      ::capnp::bounded<3>() * ::capnp::ELEMENTS);
+}
+inline void EventStreamCompressed::Event::Repeat::Builder::setEvents( ::uint32_t value) {
+  _builder.setDataField< ::uint32_t>(
+      ::capnp::bounded<3>() * ::capnp::ELEMENTS, value);
+}
+
+inline  ::uint16_t EventStreamCompressed::Event::Repeat::Reader::getPeriod() const {
+  return _reader.getDataField< ::uint16_t>(
+      ::capnp::bounded<5>() * ::capnp::ELEMENTS);
+}
+
+inline  ::uint16_t EventStreamCompressed::Event::Repeat::Builder::getPeriod() {
+  return _builder.getDataField< ::uint16_t>(
+      ::capnp::bounded<5>() * ::capnp::ELEMENTS);
+}
+inline void EventStreamCompressed::Event::Repeat::Builder::setPeriod( ::uint16_t value) {
+  _builder.setDataField< ::uint16_t>(
+      ::capnp::bounded<5>() * ::capnp::ELEMENTS, value);
+}
+
 
 #endif  // CAPNP_INCLUDED_9274197a8c1bd9a8_
@@ -457,6 +457,8 @@ public:
 
   inline  ::uint64_t getEndAddr() const;
 
+  inline  ::uint16_t getProducerEventHi() const;
+
 private:
   ::capnp::_::StructReader _reader;
   template <typename, ::capnp::Kind>
@@ -497,6 +499,9 @@ public:
   inline  ::uint64_t getEndAddr();
   inline void setEndAddr( ::uint64_t value);
 
+  inline  ::uint16_t getProducerEventHi();
+  inline void setProducerEventHi( ::uint16_t value);
+
 private:
   ::capnp::_::StructBuilder _builder;
   template <typename, ::capnp::Kind>
@@ -780,6 +785,7 @@ inline typename EventStreamUncompressed::Event::Comm::Builder EventStreamUncompr
   _builder.setDataField< ::uint32_t>(::capnp::bounded<1>() * ::capnp::ELEMENTS, 0);
   _builder.setDataField< ::uint64_t>(::capnp::bounded<1>() * ::capnp::ELEMENTS, 0);
   _builder.setDataField< ::uint64_t>(::capnp::bounded<2>() * ::capnp::ELEMENTS, 0);
+  _builder.setDataField< ::uint16_t>(::capnp::bounded<1>() * ::capnp::ELEMENTS, 0);
   return typename EventStreamUncompressed::Event::Comm::Builder(_builder);
 }
 inline bool EventStreamUncompressed::Event::Reader::isSync() const {
@@ -953,6 +959,20 @@ inline void EventStreamUncompressed::Event::Comm::Builder::setEndAddr( ::uint64_
       ::capnp::bounded<2>() * ::capnp::ELEMENTS, value);
 }
 
+inline  ::uint16_t EventStreamUncompressed::Event::Comm::Reader::getProducerEventHi() const {
+  return _reader.getDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS);
+}
+
+inline  ::uint16_t EventStreamUncompressed::Event::Comm::Builder::getProducerEventHi() {
+  return _builder.getDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS);
+}
+inline void EventStreamUncompressed::Event::Comm::Builder::setProducerEventHi( ::uint16_t value) {
+  _builder.setDataField< ::uint16_t>(
+      ::capnp::bounded<1>() * ::capnp::ELEMENTS, value);
+}
+
 inline  ::EventStreamUncompressed::Event::SyncType EventStreamUncompressed::Event::Sync::Reader::getType() const {
   return _reader.getDataField< ::EventStreamUncompressed::Event::SyncType>(
       ::capnp::bounded<0>() * ::capnp::ELEMENTS);
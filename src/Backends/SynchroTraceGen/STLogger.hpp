@@ -30,6 +30,12 @@ class STLoggerCompressed
 
     virtual auto instrMarker(int limit) -> void = 0;
     /* Place a marker in the trace after 'limit' instructions */
+
+    virtual auto repeat(unsigned events, unsigned period, int64_t stride,
+                        EID eid, TID tid) -> void = 0;
+    /* Log 'events' Compute Events, numbered from 'eid', each a copy of the
+     * Compute Event 'period' events before it, with its address ranges
+     * moved by 'stride' bytes */
 };
 
 class STLoggerUncompressed
@@ -5,16 +5,151 @@
 #include "STTypes.hpp"
 
 #include <cstdint>
-#include <bitset>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
 
 
 namespace STGen
 {
 
 constexpr TID SO_UNDEF = -1;
-constexpr TID MAX_THREADS = 128;
-static_assert((MAX_THREADS > 0) && !(MAX_THREADS & (MAX_THREADS-1)),
-              "MAX_THREADS must be a power of 2");
+
+constexpr unsigned maxCompressionLevels = 4;
+/* compression levels generated in a single pass */
+
+class ReaderSets
+{
+    /* Each address can have multiple readers.
+     * Instead of a bitfield of every possible thread per address,
+     * each address refers to an immutable, interned set of reader threads.
+     *
+     * A set is a node in a trie of ascending thread IDs: its largest reader,
+     * and the set of its other readers. Each set costs one node, however many
+     * readers it has, and sets with the same smaller readers share nodes.
+     *
+     * Sets are reference counted by the addresses and the larger sets that
+     * refer to them, and reclaimed once unreferenced. IDs are reused, so each
+     * node has a generation; results cached per backend thread, so the common
+     * case does not take a lock, are only used while their generations hold. */
+  public:
+    using ID = uint32_t;
+    static constexpr ID EMPTY = 0;
+    /* never reclaimed, so not reference counted */
+
+    ReaderSets()
+        : instance(nextInstance())
+        , chunks(new std::atomic<Node*>[1ULL << (32 - chunkBits)]())
+    {
+        newNode(EMPTY, -1);
+    }
+    ReaderSets(const ReaderSets &) = delete;
+    ReaderSets &operator=(const ReaderSets &) = delete;
+
+    auto add(ID set, TID tid, uint32_t refs) -> ID;
+    /* Returns the set with 'tid' added. If that is a different set,
+     * the caller now holds 'refs' references to it. The caller must
+     * hold a reference to 'set' */
+    auto release(ID set, uint32_t refs) -> void;
+
+    auto contains(ID set, TID tid) -> bool;
+    /* does not create a set */
+    auto members(ID set) -> std::vector<TID>;
+
+    auto count() -> size_t
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return live;
+    }
+    auto peak() -> size_t
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return livePeak;
+    }
+    /* sets in use, including EMPTY */
+
+  private:
+    struct Node
+    {
+        ID parent;
+        TID tid;
+        /* the largest reader, and the set of the others */
+        std::atomic<uint32_t> refs;
+        std::atomic<uint32_t> gen;
+        /* bumped each time the ID is reclaimed */
+    };
+
+    auto node(ID set) -> Node&
+    {
+        return chunks[set >> chunkBits].load(std::memory_order_acquire)[set & ((1U << chunkBits) - 1)];
+    }
+
+    static auto childKey(ID parent, TID tid) -> uint64_t
+    {
+        return static_cast<uint64_t>(parent) << 32 | static_cast<uint32_t>(tid);
+    }
+
+    static auto acquireIfLive(Node &n, uint32_t refs) -> bool
+    {
+        /* a set without references may be reclaimed at any time */
+        uint32_t cur = n.refs.load();
+        while (cur != 0)
+            if (n.refs.compare_exchange_weak(cur, cur + refs))
+                return true;
+        return false;
+    }
+
+    auto newNode(ID parent, TID tid) -> ID;
+    auto child(ID parent, TID tid) -> ID;
+    auto addLocked(ID set, TID tid) -> ID;
+    auto reclaim(ID set, uint32_t gen) -> void;
+    /* with the mutex held */
+
+    static auto nextInstance() -> uint32_t
+    {
+        static std::atomic<uint32_t> instances{0};
+        return ++instances;
+    }
+
+    struct AddEntry
+    {
+        uint32_t instance;
+        uint32_t setGen;
+        uint64_t key;
+        ID result;
+        uint32_t resultGen;
+    };
+    struct ContainsEntry
+    {
+        uint32_t instance;
+        uint32_t setGen;
+        uint64_t key;
+        bool result;
+    };
+    static constexpr unsigned cacheBits = 12;
+
+    const uint32_t instance;
+    /* distinguishes cache entries of different ReaderSets */
+
+    static constexpr unsigned chunkBits = 16;
+    std::unique_ptr<std::atomic<Node*>[]> chunks;
+    /* nodes never move, so they are read without the lock */
+
+    std::mutex mtx;
+    std::vector<std::unique_ptr<Node[]>> owned;
+    std::vector<ID> freeIDs;
+    uint64_t nextID{0};
+    std::unordered_map<uint64_t, ID> children;
+    /* (set, larger reader) -> set */
+    std::vector<TID> larger;
+    size_t live{0};
+    size_t livePeak{0};
+};
+
 
 class STShadowMemory
 {
@@ -27,51 +162,276 @@ class STShadowMemory
     auto getWriterEID(Addr addr) -> EID;
     auto isReaderTID(Addr addr, TID tid) -> bool;
 
+    auto setLevels(unsigned levels) -> void;
+    /* Track the writer's event ID at each of 'levels' compression levels.
+     * Each level numbers its events independently.
+     * Level 0 is kept with the writer thread; the others are kept
+     * in a separate shadow memory, only allocated for more than one level */
+    auto updateWriter(Addr addr, ByteCount bytes, TID tid, const EID *eids) -> void;
+    auto getWriterEIDs(Addr addr, EID *eids) -> void;
+    /* one event ID per level */
+    auto getLevels() const -> unsigned { return levels; }
+
+    auto setLimit(uint64_t bytes, std::string spillDir) -> void;
+    auto getStats() -> ShadowMemoryStats;
+    /* across all levels; the limit applies to each shadow memory */
+
     struct ShadowObject
     {
         TID last_writer{SO_UNDEF};
-        EID last_writer_event{0};
-        /* Last thread/event to read/write to addr */
-    
-        std::bitset<MAX_THREADS> last_readers;
-        /* A bitfield -- each bit represents a thread
-         * each address can have multiple readers */
+        uint16_t last_writer_event_hi{0};
+        uint32_t last_writer_event_lo{0};
+        /* Last thread/event to read/write to addr.
+         * The event ID is split to fit the padding after the thread ID */
+
+        ReaderSets::ID last_readers{ReaderSets::EMPTY};
+        /* Threads that read addr since the last write */
     };
 
     ShadowMemory<ShadowObject, 38, 20> sm;
     /* ADDR_BITS = 48, PM_BITS = 28 is more appropriate for DynamoRIO */
+
+    struct LevelEvents
+    {
+        uint16_t last_writer_event_hi[maxCompressionLevels-1];
+        uint32_t last_writer_event_lo[maxCompressionLevels-1];
+        /* Last event to write to addr, for levels 1 and up */
+    };
+
+    std::unique_ptr<ShadowMemory<LevelEvents, 38, 20>> levelEvents;
+
+    ReaderSets readers;
+
+  private:
+    unsigned levels{1};
 };
 
 
+inline auto ReaderSets::add(ID set, TID tid, uint32_t refs) -> ID
+{
+    assert(tid >= 0);
+    uint64_t key = childKey(set, tid);
+
+    static thread_local AddEntry cache[1 << cacheBits];
+    auto &entry = cache[(key * 0x9E3779B97F4A7C15ULL) >> (64 - cacheBits)];
+    if (entry.instance == instance && entry.key == key &&
+        entry.setGen == node(set).gen.load(std::memory_order_acquire))
+    {
+        if (entry.result == set)
+            return set;
+
+        /* the result may have been reclaimed, and its ID reused, since */
+        Node &result = node(entry.result);
+        if (acquireIfLive(result, refs) == true)
+        {
+            if (result.gen.load(std::memory_order_acquire) == entry.resultGen)
+                return entry.result;
+            release(entry.result, refs);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    ID result = addLocked(set, tid);
+    if (result != set)
+        node(result).refs.fetch_add(refs);
+    entry = {instance, node(set).gen.load(), key, result, node(result).gen.load()};
+    return result;
+}
+
+
+inline auto ReaderSets::release(ID set, uint32_t refs) -> void
+{
+    if (set == EMPTY || refs == 0)
+        return;
+
+    Node &n = node(set);
+    uint32_t gen = n.gen.load(std::memory_order_acquire);
+    if (n.refs.fetch_sub(refs) == refs)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        reclaim(set, gen);
+    }
+}
+
+
+inline auto ReaderSets::contains(ID set, TID tid) -> bool
+{
+    assert(tid >= 0);
+    uint64_t key = childKey(set, tid);
+    uint32_t gen = node(set).gen.load(std::memory_order_acquire);
+
+    static thread_local ContainsEntry cache[1 << cacheBits];
+    auto &entry = cache[(key * 0x9E3779B97F4A7C15ULL) >> (64 - cacheBits)];
+    if (entry.instance == instance && entry.key == key && entry.setGen == gen)
+        return entry.result;
+
+    /* readers ascend towards the leaves */
+    ID cur = set;
+    while (cur != EMPTY && node(cur).tid > tid)
+        cur = node(cur).parent;
+    bool result = (cur != EMPTY && node(cur).tid == tid);
+
+    entry = {instance, gen, key, result};
+    return result;
+}
+
+
+inline auto ReaderSets::members(ID set) -> std::vector<TID>
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<TID> tids;
+    for (ID cur = set; cur != EMPTY; cur = node(cur).parent)
+        tids.push_back(node(cur).tid);
+    std::reverse(tids.begin(), tids.end());
+    return tids;
+}
+
+
+inline auto ReaderSets::newNode(ID parent, TID tid) -> ID
+{
+    ID set;
+    if (freeIDs.empty() == false)
+    {
+        set = freeIDs.back();
+        freeIDs.pop_back();
+    }
+    else
+    {
+        if (nextID > std::numeric_limits<ID>::max())
+            fatal("SynchroTraceGen ran out of shadow memory reader sets");
+        set = nextID++;
+        if ((set & ((1U << chunkBits) - 1)) == 0)
+        {
+            owned.emplace_back(new Node[1U << chunkBits]());
+            chunks[set >> chunkBits].store(owned.back().get(), std::memory_order_release);
+        }
+    }
+
+    Node &n = node(set);
+    n.parent = parent;
+    n.tid = tid;
+    n.refs.store(0);
+    if (set != EMPTY)
+    {
+        children.emplace(childKey(parent, tid), set);
+        if (parent != EMPTY)
+            node(parent).refs.fetch_add(1);
+    }
+
+    livePeak = std::max(++live, livePeak);
+    return set;
+}
+
+
+inline auto ReaderSets::child(ID parent, TID tid) -> ID
+{
+    auto it = children.find(childKey(parent, tid));
+    return it != children.end() ? it->second : newNode(parent, tid);
+}
+
+
+inline auto ReaderSets::addLocked(ID set, TID tid) -> ID
+{
+    /* readers larger than 'tid' are added back on top of it */
+    larger.clear();
+    ID base = set;
+    while (base != EMPTY && node(base).tid > tid)
+    {
+        larger.push_back(node(base).tid);
+        base = node(base).parent;
+    }
+    if (base != EMPTY && node(base).tid == tid)
+        return set;
+
+    ID result = child(base, tid);
+    for (auto it = larger.rbegin(); it != larger.rend(); ++it)
+        result = child(result, *it);
+    return result;
+}
+
+
+inline auto ReaderSets::reclaim(ID set, uint32_t gen) -> void
+{
+    /* Only if nothing took a reference, or reclaimed it first,
+     * since its count reached zero; then its parent loses a reference */
+    while (set != EMPTY)
+    {
+        Node &n = node(set);
+        if (n.gen.load() != gen || n.refs.load() != 0)
+            return;
+
+        n.gen.fetch_add(1);
+        children.erase(childKey(n.parent, n.tid));
+        freeIDs.push_back(set);
+        --live;
+
+        set = n.parent;
+        if (set == EMPTY)
+            return;
+        gen = node(set).gen.load();
+        if (node(set).refs.fetch_sub(1) != 1)
+            return;
+    }
+}
+
+
 inline auto STShadowMemory::updateWriter(Addr addr, ByteCount bytes, TID tid, EID eid) -> void
 {
-    assert(tid < MAX_THREADS);
+    assert(tid >= 0);
+    assert(eid <= MAX_EID);
+
+    /* readers are released a run of bytes at a time */
+    ReaderSets::ID run = ReaderSets::EMPTY;
+    uint32_t runBytes = 0;
     for (ByteCount i = 0; i < bytes; ++i)
     {
         ShadowObject &so = sm[addr + i];
         so.last_writer = tid;
-        so.last_writer_event = eid;
-        so.last_readers.reset();
+        so.last_writer_event_hi = eid >> 32;
+        so.last_writer_event_lo = eid;
+        if (so.last_readers != run)
+        {
+            readers.release(run, runBytes);
+            run = so.last_readers;
+            runBytes = 0;
+        }
+        ++runBytes;
+        so.last_readers = ReaderSets::EMPTY;
     }
+    readers.release(run, runBytes);
 }
 
 
 inline auto STShadowMemory::updateReader(Addr addr, ByteCount bytes, TID tid) -> void
 {
-    assert(tid < MAX_THREADS);
-    for (ByteCount i = 0; i < bytes; ++i)
+    assert(tid >= 0);
+
+    /* consecutive bytes with the same readers move to the new set together */
+    ByteCount i = 0;
+    while (i < bytes)
     {
-        ShadowObject &so = sm[addr + i];
-        so.last_readers.set(tid);
+        ReaderSets::ID old = sm[addr + i].last_readers;
+        ByteCount run = 1;
+        while (i + run < bytes && sm[addr + i + run].last_readers == old)
+            ++run;
+
+        ReaderSets::ID added = readers.add(old, tid, run);
+        if (added != old)
+        {
+            for (ByteCount j = i; j < i + run; ++j)
+                sm[addr + j].last_readers = added;
+            readers.release(old, run);
+        }
+        i += run;
     }
 }
 
 
 inline auto STShadowMemory::isReaderTID(Addr addr, TID tid) -> bool
 {
-    assert(tid < MAX_THREADS);
+    assert(tid >= 0);
     ShadowObject &so = sm[addr];
-    return so.last_readers.test(tid);
+    return readers.contains(so.last_readers, tid);
 }
 
 
@@ -83,7 +443,77 @@ inline auto STShadowMemory::getWriterTID(Addr addr) -> TID
 
 inline auto STShadowMemory::getWriterEID(Addr addr) -> EID
 {
-    return sm[addr].last_writer_event;
+    ShadowObject &so = sm[addr];
+    return static_cast<EID>(so.last_writer_event_hi) << 32 | so.last_writer_event_lo;
+}
+
+
+inline auto STShadowMemory::setLevels(unsigned levels) -> void
+{
+    assert(levels > 0 && levels <= maxCompressionLevels);
+    this->levels = levels;
+    if (levels > 1 && levelEvents == nullptr)
+        levelEvents = std::make_unique<ShadowMemory<LevelEvents, 38, 20>>();
+}
+
+
+inline auto STShadowMemory::updateWriter(Addr addr, ByteCount bytes, TID tid, const EID *eids) -> void
+{
+    updateWriter(addr, bytes, tid, eids[0]);
+    if (levels == 1)
+        return;
+
+    for (ByteCount i = 0; i < bytes; ++i)
+    {
+        LevelEvents &le = (*levelEvents)[addr + i];
+        for (unsigned level = 1; level < levels; ++level)
+        {
+            assert(eids[level] <= MAX_EID);
+            le.last_writer_event_hi[level-1] = eids[level] >> 32;
+            le.last_writer_event_lo[level-1] = eids[level];
+        }
+    }
+}
+
+
+inline auto STShadowMemory::getWriterEIDs(Addr addr, EID *eids) -> void
+{
+    eids[0] = getWriterEID(addr);
+    if (levels > 1)
+    {
+        LevelEvents &le = (*levelEvents)[addr];
+        for (unsigned level = 1; level < levels; ++level)
+            eids[level] = (static_cast<EID>(le.last_writer_event_hi[level-1]) << 32 |
+                           le.last_writer_event_lo[level-1]);
+    }
+}
+
+
+inline auto STShadowMemory::setLimit(uint64_t bytes, std::string spillDir) -> void
+{
+    sm.setLimit(bytes, spillDir);
+    if (levelEvents != nullptr)
+        levelEvents->setLimit(bytes, spillDir);
+}
+
+
+inline auto STShadowMemory::getStats() -> ShadowMemoryStats
+{
+    ShadowMemoryStats stats = sm.getStats();
+    if (levelEvents != nullptr)
+    {
+        ShadowMemoryStats levelStats = levelEvents->getStats();
+        stats.smAllocated += levelStats.smAllocated;
+        stats.smResident += levelStats.smResident;
+        stats.bytesResident += levelStats.bytesResident;
+        stats.bytesPeak += levelStats.bytesPeak;
+        stats.smEvicted += levelStats.smEvicted;
+        stats.smFaulted += levelStats.smFaulted;
+        stats.spillFileBytes += levelStats.spillFileBytes;
+    }
+    stats.readerSets = readers.count();
+    stats.readerSetsPeak = readers.peak();
+    return stats;
 }
 
 }; //end namespace STGen
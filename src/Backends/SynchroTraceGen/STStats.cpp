@@ -0,0 +1,130 @@
+#include "STStats.hpp"
+#include "Core/SigiLog.hpp"
+#include <cstring>
+#include <cerrno>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+namespace
+{
+
+const char barrierStatsHeader[] = "barrier,iops,flops,instrs,memAccesses,communication,locks\n";
+const char commRegionsHeader[] = "region,barrier,producer,bytes,edges\n";
+
+bool commPerBarrier{false};
+/* set once, before any threads create stats */
+
+}; //end namespace
+
+
+BarrierStatsFile::BarrierStatsFile(std::string path)
+    : path(path)
+{
+    file = fopen(path.c_str(), "w");
+    if (file == NULL)
+        fatal("opening barrier statistics: " + path + ": " + strerror(errno));
+    if (fputs(barrierStatsHeader, file) == EOF)
+        fatal("writing barrier statistics: " + path + ": " + strerror(errno));
+}
+
+
+BarrierStatsFile::~BarrierStatsFile()
+{
+    if (fclose(file) != 0)
+        fatal("closing barrier statistics: " + path + ": " + strerror(errno));
+}
+
+
+auto BarrierStatsFile::append(Addr id, const BarrierStats &stats) -> void
+{
+    if (fprintf(file, "%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                static_cast<unsigned long long>(id),
+                stats.iops, stats.flops, stats.instrs,
+                stats.memAccesses, stats.communication, stats.locks) < 0)
+        fatal("writing barrier statistics: " + path + ": " + strerror(errno));
+}
+
+
+auto BarrierStatsFile::read(std::function<void(Addr, const BarrierStats&)> onBarrier) -> void
+{
+    if (fflush(file) != 0)
+        fatal("writing barrier statistics: " + path + ": " + strerror(errno));
+
+    FILE *in = fopen(path.c_str(), "r");
+    if (in == NULL)
+        fatal("reading barrier statistics: " + path + ": " + strerror(errno));
+
+    char header[sizeof(barrierStatsHeader)];
+    if (fgets(header, sizeof(header), in) == NULL ||
+        strcmp(header, barrierStatsHeader) != 0)
+        fatal("reading barrier statistics: " + path + ": bad header");
+
+    unsigned long long id;
+    BarrierStats stats;
+    int fields;
+    while ((fields = fscanf(in, "%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                            &id, &stats.iops, &stats.flops, &stats.instrs,
+                            &stats.memAccesses, &stats.communication, &stats.locks)) == 7)
+        onBarrier(id, stats);
+
+    if (fields != EOF || ferror(in) != 0)
+        fatal("reading barrier statistics: " + path + ": malformed record");
+    fclose(in);
+}
+
+
+auto PerCommStats::configure(bool perBarrier) -> void
+{
+    commPerBarrier = perBarrier;
+}
+
+
+auto PerCommStats::perBarrier() -> bool
+{
+    return commPerBarrier;
+}
+
+
+PerCommStats::PerCommStats(std::string regionsPath)
+{
+    if (commPerBarrier == false)
+        return;
+
+    FILE *file = fopen(regionsPath.c_str(), "w");
+    if (file == NULL)
+        fatal("opening communication statistics: " + regionsPath + ": " + strerror(errno));
+    regionsFile.reset(file, [regionsPath](FILE *f)
+    {
+        if (fclose(f) != 0)
+            fatal("closing communication statistics: " + regionsPath + ": " + strerror(errno));
+    });
+
+    if (fputs(commRegionsHeader, file) == EOF)
+        fatal("writing communication statistics: " + regionsPath + ": " + strerror(errno));
+}
+
+
+auto PerCommStats::barrier(Addr id) -> void
+{
+    if (regionsFile == nullptr)
+        return;
+
+    /* only producers this region read from */
+    for (size_t producer = 0; producer < region.size(); ++producer)
+    {
+        if (region[producer].edges == 0)
+            continue;
+        if (fprintf(regionsFile.get(), "%llu,%llu,%zu,%llu,%llu\n",
+                    completedRegions, static_cast<unsigned long long>(id), producer,
+                    region[producer].bytes, region[producer].edges) < 0)
+            fatal("writing communication statistics: " + std::string(strerror(errno)));
+    }
+
+    ++completedRegions;
+    region.assign(region.size(), CommCounts{});
+}
+
+}; //end namespace STGen
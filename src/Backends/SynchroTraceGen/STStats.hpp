@@ -2,8 +2,17 @@
 #define STGEN_STATS_H
 
 #include "ShadowMemory.hpp" //Addr
-#include <tuple>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <limits>
 #include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
 
 /* TODO(someday) these names are confusing; change them */
 
@@ -25,9 +34,9 @@ struct BarrierStats
     StatCounter communication{0};
     StatCounter memAccesses{0};
     StatCounter locks{0};
-    auto iopsPerMemAccess() -> float { return static_cast<float>(iops)/memAccesses; }
-    auto flopsPerMemAccess() -> float { return static_cast<float>(flops)/memAccesses; }
-    auto locksPerIopsPlusFlops() -> float { return static_cast<float>(locks)/(iops + flops); }
+    auto iopsPerMemAccess() const -> float { return static_cast<float>(iops)/memAccesses; }
+    auto flopsPerMemAccess() const -> float { return static_cast<float>(flops)/memAccesses; }
+    auto locksPerIopsPlusFlops() const -> float { return static_cast<float>(locks)/(iops + flops); }
 
     BarrierStats& operator+=(const BarrierStats &rhs)
     {
@@ -59,10 +68,75 @@ struct LockStats
     StatCounter communication{0};
 };
 
+struct StatSummary
+{
+    /* Distribution of one statistic over many regions */
+
+    StatCounter sum{0};
+    StatCounter min{std::numeric_limits<StatCounter>::max()};
+    StatCounter max{0};
+    std::array<StatCounter, 65> log2Buckets{};
+    /* bucket 0 counts zeros, bucket N counts values in [2^(N-1), 2^N) */
+
+    auto add(StatCounter val) -> void
+    {
+        sum += val;
+        min = std::min(min, val);
+        max = std::max(max, val);
+        ++log2Buckets[val == 0 ? 0 : 64 - __builtin_clzll(val)];
+    }
+};
+
+struct LockSummary
+{
+    /* Statistics of every lock/unlock region of one lock */
+
+    StatCounter count{0};
+    StatSummary iops;
+    StatSummary flops;
+    StatSummary instrs;
+    StatSummary memAccesses;
+    StatSummary communication;
+
+    auto add(const LockStats &region) -> void
+    {
+        ++count;
+        iops.add(region.iops);
+        flops.add(region.flops);
+        instrs.add(region.instrs);
+        memAccesses.add(region.memAccesses);
+        communication.add(region.communication);
+    }
+};
+
 using AllBarriersStats = std::list<std::pair<Addr, BarrierStats>>;
+class BarrierStatsFile
+{
+    /* Statistics for each barrier region, streamed to a file as the region
+     * completes, so memory does not grow with the number of barriers.
+     * The file is CSV, one line per region, in the order the thread
+     * reached each barrier */
+  public:
+    BarrierStatsFile(std::string path);
+    BarrierStatsFile(const BarrierStatsFile &) = delete;
+    BarrierStatsFile &operator=(const BarrierStatsFile &) = delete;
+    ~BarrierStatsFile();
+
+    auto append(Addr id, const BarrierStats &stats) -> void;
+    auto read(std::function<void(Addr, const BarrierStats&)> onBarrier) -> void;
+    /* every region appended so far, in order */
+
+  private:
+    const std::string path;
+    FILE *file;
+};
+
 class PerBarrierStats
 {
   public:
+    PerBarrierStats(std::string path)
+        : records(std::make_shared<BarrierStatsFile>(path)) {}
+
     auto incIOPs() -> void { ++current.iops; }
     auto incFLOPs() -> void { ++current.flops; }
     auto incInstrs() -> void { ++current.instrs; }
@@ -71,17 +145,28 @@ class PerBarrierStats
     auto incLocks() -> void { ++current.locks; }
     auto barrier(Addr id) -> void
     {
-        barriers.push_back(std::make_pair(id, current));
+        records->append(id, current);
         current = BarrierStats{};
     }
-    auto getAllBarriersStats() const -> AllBarriersStats { return barriers; }
+    auto forEachBarrier(std::function<void(Addr, const BarrierStats&)> onBarrier) const -> void
+    {
+        records->read(onBarrier);
+    }
+    auto getAllBarriersStats() const -> AllBarriersStats
+    {
+        AllBarriersStats barriers;
+        records->read([&](Addr id, const BarrierStats &stats)
+                      { barriers.push_back(std::make_pair(id, stats)); });
+        return barriers;
+    }
 
   private:
-    AllBarriersStats barriers;
+    std::shared_ptr<BarrierStatsFile> records;
+    /* copies of these stats share the thread's file */
     BarrierStats current;
 };
 
-using AllLocksStats = std::list<std::pair<Addr, LockStats>>;
+using AllLocksStats = std::map<Addr, LockSummary>;
 class PerLockStats
 {
     /* XXX Assumes common case of only one lock held at a time */
@@ -94,7 +179,7 @@ class PerLockStats
     auto lock() -> void { active = true; }
     auto unlock(Addr id) -> void
     {
-        locks.push_back(std::make_pair(id, current));
+        locks[id].add(current);
         current = LockStats{};
         active = false;
     }
@@ -102,13 +187,71 @@ class PerLockStats
 
   private:
     AllLocksStats locks;
+    /* aggregated per lock, so memory does not grow with the number of unlocks */
     LockStats current;
     bool active{false};
 };
 
+struct CommCounts
+{
+    /* Communication from one producer thread */
+
+    StatCounter bytes{0};
+    StatCounter edges{0};
+};
+
+using CommRow = std::vector<CommCounts>;
+/* indexed by producer thread ID */
+
+class PerCommStats
+{
+    /* A thread's row of the thread to thread communication matrix:
+     * the bytes it read that were last written by each other thread,
+     * and the number of communication edges they were read in.
+     *
+     * Optionally, the row for each barrier region is also streamed to a
+     * CSV file as the region completes */
+  public:
+    static auto configure(bool perBarrier) -> void;
+    /* Must be called before any stats are created */
+
+    static auto perBarrier() -> bool;
+
+    PerCommStats(std::string regionsPath);
+    /* 'regionsPath' is only opened when recording barrier regions */
+
+    auto edge(unsigned producer, StatCounter bytes) -> void
+    {
+        add(total, producer, bytes);
+        if (regionsFile != nullptr)
+            add(region, producer, bytes);
+    }
+    auto barrier(Addr id) -> void;
+    auto getRow() const -> const CommRow& { return total; }
+
+  private:
+    static auto add(CommRow &row, unsigned producer, StatCounter bytes) -> void
+    {
+        if (producer >= row.size())
+            row.resize(producer + 1);
+        row[producer].bytes += bytes;
+        ++row[producer].edges;
+    }
+
+    CommRow total;
+    CommRow region;
+    StatCounter completedRegions{0};
+    std::shared_ptr<FILE> regionsFile;
+    /* copies of these stats share the thread's file */
+};
+
 class PerThreadStats
 {
   public:
+    PerThreadStats(std::string barrierStatsPath, std::string commRegionsPath)
+        : barrierStats(barrierStatsPath)
+        , commStats(commRegionsPath) {}
+
     auto incIOPs() -> void
     {
         ++std::get<IOP>(stats);
@@ -155,6 +298,11 @@ class PerThreadStats
         lockStats.incComm();
     }
 
+    auto incCommEdge(unsigned producer, StatCounter bytes) -> void
+    {
+        commStats.edge(producer, bytes);
+    }
+
     auto incSyncs(unsigned char type, unsigned numArgs, Addr *args) -> void
     {
         assert(numArgs > 0);
@@ -174,6 +322,7 @@ class PerThreadStats
         else if (type == 5)
         {
             barrierStats.barrier(args[0]);
+            commStats.barrier(args[0]);
         }
     }
 
@@ -187,15 +336,26 @@ class PerThreadStats
         return barrierStats.getAllBarriersStats();
     }
 
+    auto forEachBarrier(std::function<void(Addr, const BarrierStats&)> onBarrier) -> void
+    {
+        barrierStats.forEachBarrier(onBarrier);
+    }
+
     auto getLockStats() -> AllLocksStats
     {
         return lockStats.getAllLocksStats();
     }
 
+    auto getCommRow() const -> const CommRow&
+    {
+        return commStats.getRow();
+    }
+
   private:
     Stats stats{0,0,0,0,0};
     PerBarrierStats barrierStats;
     PerLockStats lockStats;
+    PerCommStats commStats;
 };
 
 }; //end namespace STGen
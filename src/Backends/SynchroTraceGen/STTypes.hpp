@@ -10,10 +10,13 @@ namespace STGen
 {
 
 using TID = int16_t;
-using EID = uint32_t;
-/* XXX Thread ID (TID) and Event ID (EID)
- * set to 16-bits and 32-bits for memory usage considerations.
- * Increasing the sizes may be required in the future. */
+using EID = uint64_t;
+/* XXX Thread ID (TID) set to 16-bits for memory usage considerations.
+ * Thread IDs from the frontend must be below 2^15.
+ * Increasing the size may be required in the future. */
+
+constexpr EID MAX_EID = (1ULL << 48) - 1;
+/* Shadow memory and the capnproto traces keep 48 bits of each event ID */
 
 //-----------------------------------------------------------------------------
 /** Synchronization **/
@@ -7,7 +7,14 @@
 #include <limits>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <type_traits>
 #include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <zlib.h>
 
 /**
  * Shadow Memory tracks 'shadow state' for an address.
@@ -20,6 +27,21 @@ using Addr = PtrVal;
 using SigiLog::fatal;
 using SigiLog::warn;
 
+struct ShadowMemoryStats
+{
+    /* Footprint of the shadow memory, in secondary maps and bytes */
+
+    uint64_t smAllocated{0};    // secondary maps created during the run
+    uint64_t smResident{0};     // secondary maps currently in memory
+    uint64_t bytesResident{0};  // includes the primary map
+    uint64_t bytesPeak{0};
+    uint64_t smEvicted{0};      // secondary maps written to the spill file
+    uint64_t smFaulted{0};      // secondary maps read back from the spill file
+    uint64_t spillFileBytes{0};
+    uint64_t readerSets{0};     // distinct sets of readers in use
+    uint64_t readerSetsPeak{0};
+};
+
 /* XXX: Setting {addr, pm} bits too large can cause bad_alloc errors */
 template <typename SO, unsigned ADDR_BITS = 38, unsigned PM_BITS = 20>
 class ShadowMemory
@@ -27,6 +49,8 @@ class ShadowMemory
     static_assert(ADDR_BITS > 0 && ADDR_BITS < 64, "Invalid address range");
     static_assert(PM_BITS > 0, "Invalid offset for primary map");
     static_assert(sizeof(Addr)*CHAR_BIT >= ADDR_BITS, "Max address is too large for the platform");
+    static_assert(std::is_trivially_copyable<SO>::value,
+                  "Shadow objects are spilled to disk as raw bytes");
 
   public:
     ShadowMemory()
@@ -35,19 +59,35 @@ class ShadowMemory
         , sm_bits(addr_bits - pm_bits)
         , pm_size(1ULL << pm_bits)
         , sm_size(1ULL << sm_bits)
+        , sm_bytes(sizeof(SecondaryMap) + sm_size*sizeof(SO))
         , pm(pm_size)
-    {}
+    {
+        stats.bytesResident = pm_size * sizeof(typename PrimaryMap::value_type);
+        stats.bytesPeak = stats.bytesResident;
+    }
     ShadowMemory(const ShadowMemory &) = delete;
     ShadowMemory &operator=(const ShadowMemory &) = delete;
+    ~ShadowMemory()
+    {
+        if (spillFd >= 0)
+            close(spillFd);
+    }
 
     const Addr addr_bits;
     const Addr pm_bits;
     const Addr sm_bits;
     const Addr pm_size;
     const Addr sm_size;
+    const Addr sm_bytes;
     /* Configuration */
 
-    using SecondaryMap = std::vector<SO>;
+    struct SecondaryMap
+    {
+        SecondaryMap(Addr size) : objs(size) {}
+        std::vector<SO> objs;
+        bool referenced{true};
+        /* cleared by the eviction clock hand, set on every access */
+    };
     using PrimaryMap = std::vector<std::unique_ptr<SecondaryMap>>;
     /* Implementation */
 
@@ -57,9 +97,11 @@ class ShadowMemory
         {
             auto &ptr = pm[addr >> sm_bits]; /* PM offset */
             if (ptr == nullptr)
-                ptr = std::make_unique<SecondaryMap>(sm_size);
+                fill(addr >> sm_bits);
+            else if (limitBytes > 0)
+                ptr->referenced = true;
 
-            return (*ptr)[addr & ((1ULL << sm_bits) - 1)]; /* SM offset */
+            return ptr->objs[addr & ((1ULL << sm_bits) - 1)]; /* SM offset */
         }
         else
         {
@@ -75,9 +117,166 @@ class ShadowMemory
         }
     }
 
+    auto setLimit(uint64_t bytes, std::string spillDir) -> void
+    {
+        /* Once the resident footprint would exceed 'bytes',
+         * the least recently touched secondary maps are compressed
+         * into a spill file in 'spillDir', and read back on access.
+         * A limit of 0 disables spilling.
+         *
+         * References returned by operator[] are only valid until
+         * the next access that allocates a secondary map, so spilling
+         * is only safe with a single thread accessing shadow memory.
+         * SynchroTraceGen rejects a limit with more than one backend thread */
+        std::lock_guard<std::mutex> lock(slowPathMtx);
+        limitBytes = bytes;
+        spillPath = spillDir + "/sigil.shadow.spill.XXXXXX";
+    }
+
+    auto getStats() -> ShadowMemoryStats
+    {
+        std::lock_guard<std::mutex> lock(slowPathMtx);
+        return stats;
+    }
+
   private:
+    struct SpillSlot
+    {
+        off_t offset;
+        uLong capacity;
+        uLong length;
+        bool valid;
+    };
+
+    auto fill(Addr pmIdx) -> void
+    {
+        /* Allocate a secondary map, or fault it back in from the spill file.
+         * Evict cold maps first if the new map would exceed the limit. */
+        std::lock_guard<std::mutex> lock(slowPathMtx);
+        auto &ptr = pm[pmIdx];
+        if (ptr != nullptr)
+            return;
+
+        while (limitBytes > 0 &&
+               stats.bytesResident + sm_bytes > limitBytes &&
+               resident.empty() == false)
+            evictOne();
+
+        ptr = std::make_unique<SecondaryMap>(sm_size);
+
+        auto slot = spilled.find(pmIdx);
+        if (slot != spilled.end() && slot->second.valid == true)
+        {
+            readSpilled(slot->second, *ptr);
+            slot->second.valid = false; /* keep the slot for re-eviction */
+            ++stats.smFaulted;
+        }
+        else
+        {
+            ++stats.smAllocated;
+        }
+
+        resident.push_back(pmIdx);
+        ++stats.smResident;
+        stats.bytesResident += sm_bytes;
+        if (stats.bytesResident > stats.bytesPeak)
+            stats.bytesPeak = stats.bytesResident;
+    }
+
+    auto evictOne() -> void
+    {
+        /* CLOCK approximation of least-recently-touched:
+         * skip maps touched since the hand last passed them */
+        assert(resident.empty() == false);
+        while (true)
+        {
+            if (clockHand >= resident.size())
+                clockHand = 0;
+
+            Addr pmIdx = resident[clockHand];
+            auto &ptr = pm[pmIdx];
+            if (ptr->referenced == true)
+            {
+                ptr->referenced = false;
+                ++clockHand;
+                continue;
+            }
+
+            writeSpilled(pmIdx, *ptr);
+            ptr.reset();
+            resident[clockHand] = resident.back();
+            resident.pop_back();
+
+            ++stats.smEvicted;
+            --stats.smResident;
+            stats.bytesResident -= sm_bytes;
+            return;
+        }
+    }
+
+    auto writeSpilled(Addr pmIdx, const SecondaryMap &sm) -> void
+    {
+        if (spillFd < 0)
+        {
+            warn("shadow memory limit reached, spilling to: " + spillPath);
+            std::vector<char> path(spillPath.begin(), spillPath.end());
+            path.push_back('\0');
+            spillFd = mkstemp(path.data());
+            if (spillFd < 0)
+                fatal(std::string("opening shadow memory spill file: ") + strerror(errno));
+            unlink(path.data()); /* removed once closed */
+        }
+
+        uLong rawBytes = sm_size * sizeof(SO);
+        uLongf length = compressBound(rawBytes);
+        scratch.resize(length);
+        if (compress2(scratch.data(), &length,
+                      reinterpret_cast<const Bytef*>(sm.objs.data()), rawBytes,
+                      Z_BEST_SPEED) != Z_OK)
+            fatal("compressing shadow memory secondary map");
+
+        auto slot = spilled.find(pmIdx);
+        if (slot == spilled.end() || slot->second.capacity < length)
+        {
+            /* append; the old slot, if any, is too small to reuse */
+            SpillSlot newSlot{static_cast<off_t>(stats.spillFileBytes), length, length, true};
+            stats.spillFileBytes += length;
+            slot = spilled.emplace(pmIdx, newSlot).first;
+            slot->second = newSlot;
+        }
+        slot->second.length = length;
+        slot->second.valid = true;
+
+        if (pwrite(spillFd, scratch.data(), length, slot->second.offset) != static_cast<ssize_t>(length))
+            fatal(std::string("writing shadow memory spill file: ") + strerror(errno));
+    }
+
+    auto readSpilled(const SpillSlot &slot, SecondaryMap &sm) -> void
+    {
+        scratch.resize(slot.length);
+        if (pread(spillFd, scratch.data(), slot.length, slot.offset) != static_cast<ssize_t>(slot.length))
+            fatal(std::string("reading shadow memory spill file: ") + strerror(errno));
+
+        uLongf rawBytes = sm_size * sizeof(SO);
+        if (uncompress(reinterpret_cast<Bytef*>(sm.objs.data()), &rawBytes,
+                       scratch.data(), slot.length) != Z_OK ||
+            rawBytes != sm_size * sizeof(SO))
+            fatal("decompressing shadow memory secondary map");
+    }
+
     PrimaryMap pm;
 
+    std::mutex slowPathMtx;
+    ShadowMemoryStats stats;
+    /* guarded by the mutex; only touched when a secondary map is missing */
+
+    uint64_t limitBytes{0};
+    std::string spillPath;
+    int spillFd{-1};
+    std::unordered_map<Addr, SpillSlot> spilled;
+    std::vector<Addr> resident;
+    size_t clockHand{0};
+    std::vector<Bytef> scratch;
 };
 
 #endif
@@ -0,0 +1,109 @@
+#ifndef STGEN_SMALLVECTOR_H
+#define STGEN_SMALLVECTOR_H
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+#include <cstddef>
+
+namespace STGen
+{
+
+template <typename T, unsigned N>
+class SmallVector
+{
+    /* A vector that keeps up to N elements inline, without touching the heap.
+     * Once more than N elements are stored, all elements move to the heap
+     * and stay there, so a cleared and reused vector does not reallocate.
+     *
+     * Only meant for small, trivially destructible values */
+    static_assert(N > 0, "SmallVector needs inline storage");
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "SmallVector elements are never destroyed");
+
+  public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() {}
+    SmallVector(const SmallVector &other) = default;
+    SmallVector &operator=(const SmallVector &other) = default;
+    SmallVector(SmallVector &&other) noexcept
+        : count(other.count), heap(std::move(other.heap))
+    {
+        std::copy(other.inlineData, other.inlineData + N, inlineData);
+        other.count = 0;
+        other.heap.clear();
+    }
+    SmallVector &operator=(SmallVector &&other) noexcept
+    {
+        count = other.count;
+        heap = std::move(other.heap);
+        std::copy(other.inlineData, other.inlineData + N, inlineData);
+        other.count = 0;
+        other.heap.clear();
+        return *this;
+    }
+
+    auto data() -> T* { return heap.empty() ? inlineData : heap.data(); }
+    auto data() const -> const T* { return heap.empty() ? inlineData : heap.data(); }
+    auto begin() -> iterator { return data(); }
+    auto end() -> iterator { return data() + count; }
+    auto begin() const -> const_iterator { return data(); }
+    auto end() const -> const_iterator { return data() + count; }
+    auto size() const -> size_t { return count; }
+    auto empty() const -> bool { return count == 0; }
+    auto capacity() const -> size_t { return heap.empty() ? N : heap.size(); }
+    auto clear() -> void { count = 0; }
+
+    auto operator[](size_t i) -> T& { assert(i < count); return data()[i]; }
+    auto operator[](size_t i) const -> const T& { assert(i < count); return data()[i]; }
+    auto back() -> T& { assert(count > 0); return data()[count-1]; }
+    auto back() const -> const T& { assert(count > 0); return data()[count-1]; }
+
+    auto push_back(const T &val) -> void
+    {
+        if (count == capacity())
+            grow();
+        data()[count++] = val;
+    }
+
+    auto insert(size_t pos, const T &val) -> void
+    {
+        assert(pos <= count);
+        if (count == capacity())
+            grow();
+        T *d = data();
+        std::copy_backward(d + pos, d + count, d + count + 1);
+        d[pos] = val;
+        ++count;
+    }
+
+    auto erase(size_t first, size_t last) -> void
+    {
+        /* erase [first, last) */
+        assert(first <= last && last <= count);
+        T *d = data();
+        std::copy(d + last, d + count, d + first);
+        count -= last - first;
+    }
+
+  private:
+    auto grow() -> void
+    {
+        std::vector<T> bigger(capacity() * 2);
+        std::copy(begin(), end(), bigger.begin());
+        heap.swap(bigger);
+    }
+
+    size_t count{0};
+    T inlineData[N];
+    std::vector<T> heap;
+    /* sized to the full capacity once in use */
+};
+
+}; //end namespace STGen
+
+#endif
@@ -1,4 +1,6 @@
 #include "TextLogger.hpp"
+#include <cstring>
+#include <cerrno>
 
 namespace STGen
 {
@@ -6,192 +8,174 @@ namespace STGen
 namespace
 {
 
-template <typename I>
-inline auto n2hexstr(char (&hexStr)[sizeof(I)*2+3], const I &w) -> const char*
-{
-    /* For speed, adapted from http://stackoverflow.com/a/33447587
-     * hexStr MUST be at least (sizeof(I) * 2 + 3)
-     * Returns the beginning location of the hex string,
-     * since the supplied char* will be truncated:
-     *     8BADF00D0xDEADBEEF\0
-     *             |
-     *             +----- the hex string starts here at 0x */
-    static constexpr int hexLen = sizeof(I) * 2;
-    static const char *digits = "0123456789abcdef";
-
-    bool hexMSBfound = false;
-    int hexMSB = 2;
-
-    for (size_t i=2, j=(hexLen-1) * 4; i<hexLen+2; ++i, j-=4)
-    {
-        hexStr[i] = digits[(w >> j) & 0x0f];
-
-        if (hexMSBfound == false && hexStr[i] != '0')
-        {
-            hexMSBfound = true;
-            hexMSB = i;
-        }
-    }
-
-    /* TODO MDL20170309
-     * If 'w' is '0' then this returns the full size hex string instead of just "0x0".
-     * We can truncate the string to "0x0" to save space, but afaik this is very rare */
-    hexStr[hexMSB - 2] = '0';
-    hexStr[hexMSB - 1] = 'x';
-    hexStr[hexLen + 2] = '\0';
-    return hexStr + (hexMSB-2);
-}
+constexpr size_t decLen = TextWriter::maxDecLen + 1;
+constexpr size_t hexLen = TextWriter::maxHexLen + 1;
+/* Upper bounds on each formatted field, with a separator */
 
 
 auto flushSyncEvent(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
-                    EID eid, TID tid,
-                    std::shared_ptr<spdlog::logger> &logger) -> void
+                    EID eid, TID tid, TextWriter &out) -> void
 {
     assert(numArgs > 0);
-    char hexStr[sizeof(Addr)*2+3];
-    std::string logMsg;
-    logMsg += std::to_string(eid);
-    logMsg += ",";
-    logMsg += std::to_string(tid);
-    logMsg += ",pth_ty:";
-    logMsg += std::to_string(syncType);
-    logMsg += "^";
-    logMsg += n2hexstr(hexStr, syncArgs[0]);
+    out.reserve(3*decLen + 8 + numArgs*hexLen + 1);
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
+    out.put(",pth_ty:");
+    out.dec(syncType);
+    out.put('^');
+    out.hex(syncArgs[0]);
     for (unsigned i=1; i<numArgs; ++i)
     {
-        logMsg += "&";
-        logMsg += n2hexstr(hexStr, syncArgs[i]);
+        out.put('&');
+        out.hex(syncArgs[i]);
     }
-    logger->info(logMsg);
+    out.put('\n');
 }
 
 
-auto flushInstrMarker(int limit, std::shared_ptr<spdlog::logger> &logger) -> void
+auto flushInstrMarker(int limit, TextWriter &out) -> void
 {
-    logger->info("! " + std::to_string(limit));
+    out.reserve(2 + decLen + 1);
+    out.put("! ");
+    out.dec(limit);
+    out.put('\n');
 }
 
 }; //end namespace
 
 
 TextLoggerCompressed::TextLoggerCompressed(TID tid, std::string outputPath)
+    : out(outputPath + "/sigil.events.out-" + std::to_string(tid) + ".gz", &pos)
 {
     assert(tid >= 1);
-
-    /* XXX PERFORMANCE: modify this to reduce memory in STGen.
-     * Buffers for asynchronous I/O */
-    spdlog::set_async_mode(1 << 14);
-
-    auto filePath = outputPath + "/sigil.events.out-" + std::to_string(tid) + ".gz";
-    std::tie(logger, gzfile) = sigil2::getGzLogger(filePath);
 }
 
 
 TextLoggerCompressed::~TextLoggerCompressed()
 {
-    sigil2::blockingFlushAndDeleteLogger(logger);
-    /* gzofstream destructor closes gzfile  */
+    /* TextWriter destructor flushes and closes the file */
 }
 
 
 auto TextLoggerCompressed::flush(const STCompEventCompressed& ev, EID eid, TID tid) -> void
 {
-    /* http://stackoverflow.com/a/18892355 */
-    logMsg += std::to_string(eid);
-    logMsg += ",";
-    logMsg += std::to_string(tid);
-    logMsg += ",";
-    logMsg += std::to_string(ev.iops);
-    logMsg += ",";
-    logMsg += std::to_string(ev.flops);
-    logMsg += ",";
-    logMsg += std::to_string(ev.reads);
-    logMsg += ",";
-    logMsg += std::to_string(ev.writes);
-
-    char hexStr[sizeof(Addr)*2+3];
-    for (auto &p : ev.uniqueWriteAddrs.get())
+    auto &writes = ev.uniqueWriteAddrs.get();
+    auto &reads = ev.uniqueReadAddrs.get();
+    out.reserve(6*decLen + (writes.size() + reads.size())*(3 + 2*hexLen) + 1);
+
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
+    out.put(',');
+    out.dec(ev.iops);
+    out.put(',');
+    out.dec(ev.flops);
+    out.put(',');
+    out.dec(ev.reads);
+    out.put(',');
+    out.dec(ev.writes);
+
+    for (auto &p : writes)
     {
         assert(p.first <= p.second);
-        logMsg += " $ ";
-        logMsg += n2hexstr(hexStr, p.first);
-        logMsg += " ";
-        logMsg += n2hexstr(hexStr, p.second);
+        out.put(" $ ");
+        out.hex(p.first);
+        out.put(' ');
+        out.hex(p.second);
     }
 
-    for (auto &p : ev.uniqueReadAddrs.get())
+    for (auto &p : reads)
     {
         assert(p.first <= p.second);
-        logMsg += " * ";
-        logMsg += n2hexstr(hexStr, p.first);
-        logMsg += " ";
-        logMsg += n2hexstr(hexStr, p.second);
+        out.put(" * ");
+        out.hex(p.first);
+        out.put(' ');
+        out.hex(p.second);
     }
 
-    logger->info(logMsg);
-    logMsg.clear();
+    out.put('\n');
+    pos.onEvent(eid);
 }
 
 
 auto TextLoggerCompressed::flush(const STCommEventCompressed& ev, EID eid, TID tid) -> void
 {
     assert(ev.comms.empty() == false);
-    logMsg += std::to_string(eid);
-    logMsg += ",";
-    logMsg += std::to_string(tid);
+    size_t ranges = 0;
+    for (auto &edge : ev.comms)
+        ranges += std::get<2>(edge).get().size();
+    out.reserve(2*decLen + ranges*(3 + 2*decLen + 2*hexLen) + 1);
+
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
 
-    char hexStr[sizeof(Addr)*2+3];
     for (auto &edge : ev.comms)
     {
         for (auto &p : std::get<2>(edge).get())
         {
             assert(p.first <= p.second);
-            logMsg += " # ";
-            logMsg += std::to_string(std::get<0>(edge));
-            logMsg += " ";
-            logMsg += std::to_string(std::get<1>(edge));
-            logMsg += " ";
-            logMsg += n2hexstr(hexStr, p.first);
-            logMsg += " ";
-            logMsg += n2hexstr(hexStr, p.second);
+            out.put(" # ");
+            out.dec(std::get<0>(edge));
+            out.put(' ');
+            out.dec(std::get<1>(edge));
+            out.put(' ');
+            out.hex(p.first);
+            out.put(' ');
+            out.hex(p.second);
         }
     }
 
-    logger->info(logMsg);
-    logMsg.clear();
+    out.put('\n');
+    pos.onEvent(eid);
 }
 
 
 auto TextLoggerCompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                                  EID eid, TID tid) -> void
 {
-    flushSyncEvent(syncType, numArgs, syncArgs, eid, tid, logger);
+    flushSyncEvent(syncType, numArgs, syncArgs, eid, tid, out);
+    pos.onSync(syncType, eid);
 }
 
 
 auto TextLoggerCompressed::instrMarker(int limit) -> void
 {
-    flushInstrMarker(limit, logger);
+    flushInstrMarker(limit, out);
+    pos.onMarker(limit);
 }
 
 
-TextLoggerUncompressed::TextLoggerUncompressed(TID tid, std::string outputPath)
+auto TextLoggerCompressed::repeat(unsigned events, unsigned period, int64_t stride,
+                                  EID eid, TID tid) -> void
 {
-    assert(tid >= 1);
+    assert(events > 0 && period > 0);
+    out.reserve(5*decLen + 4 + 1);
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
+    out.put(",rep:");
+    out.dec(events);
+    out.put('^');
+    out.dec(period);
+    out.put('^');
+    out.dec(stride);
+    out.put('\n');
+    pos.onEvent(eid + events - 1);
+}
 
-    /* XXX PERFORMANCE: modify this to reduce memory in STGen.
-     * Buffers for asynchronous I/O */
-    spdlog::set_async_mode(1 << 14);
 
-    auto filePath = outputPath + "/sigil.events.out-" + std::to_string(tid) + ".gz";
-    std::tie(logger, gzfile) = sigil2::getGzLogger(filePath);
+TextLoggerUncompressed::TextLoggerUncompressed(TID tid, std::string outputPath)
+    : out(outputPath + "/sigil.events.out-" + std::to_string(tid) + ".gz", &pos)
+{
+    assert(tid >= 1);
 }
 
 
 TextLoggerUncompressed::~TextLoggerUncompressed()
 {
-    sigil2::blockingFlushAndDeleteLogger(logger);
-    /* gzofstream destructor closes gzfile  */
+    /* TextWriter destructor flushes and closes the file */
 }
 
 
@@ -199,16 +183,15 @@ auto TextLoggerUncompressed::flush(StatCounter iops, StatCounter flops,
                                    STCompEventUncompressed::MemType type, Addr start, Addr end,
                                    EID eid, TID tid) -> void
 {
-    /* http://stackoverflow.com/a/18892355 */
-    logMsg += std::to_string(eid);
-    logMsg += ",";
-    logMsg += std::to_string(tid);
-    logMsg += ",";
-    logMsg += std::to_string(iops);
-    logMsg += ",";
-    logMsg += std::to_string(flops);
-
-    char hexStr[sizeof(Addr)*2+3];
+    out.reserve(6*decLen + 3 + 2*hexLen + 1);
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
+    out.put(',');
+    out.dec(iops);
+    out.put(',');
+    out.dec(flops);
+
     switch (type)
     {
     /* only one of
@@ -217,62 +200,64 @@ auto TextLoggerUncompressed::flush(StatCounter iops, StatCounter flops,
      *  - one write
      * possible in uncompressed mode */
     case STCompEventUncompressed::MemType::READ:
-        logMsg += ",1,0 * ";
-        logMsg += n2hexstr(hexStr, start);
-        logMsg += " ";
-        logMsg += n2hexstr(hexStr, end);
+        out.put(",1,0 * ");
+        out.hex(start);
+        out.put(' ');
+        out.hex(end);
         break;
     case STCompEventUncompressed::MemType::WRITE:
-        logMsg += ",0,1 $ ";
-        logMsg += n2hexstr(hexStr, start);
-        logMsg += " ";
-        logMsg += n2hexstr(hexStr, end);
+        out.put(",0,1 $ ");
+        out.hex(start);
+        out.put(' ');
+        out.hex(end);
         break;
     case STCompEventUncompressed::MemType::NONE:
-        logMsg += ",0,0";
+        out.put(",0,0");
         break;
     default:
         fatal("textlogger encountered unhandled memory type");
     }
 
-    logger->info(logMsg);
-    logMsg.clear();
+    out.put('\n');
+    pos.onEvent(eid);
 }
 
 
 auto TextLoggerUncompressed::flush(EID producerEID, TID producerTID, Addr start, Addr end,
                                    EID eid, TID tid) -> void
 {
-    logMsg += std::to_string(eid);
-    logMsg += ",";
-    logMsg += std::to_string(tid);
-
-    logMsg += " # ";
-    logMsg += std::to_string(producerTID);
-    logMsg += " ";
-    logMsg += std::to_string(producerEID);
-    logMsg += " ";
-
-    char hexStr[sizeof(Addr)*2+3];
-    logMsg += n2hexstr(hexStr, start);
-    logMsg += " ";
-    logMsg += n2hexstr(hexStr, end);
-
-    logger->info(logMsg);
-    logMsg.clear();
+    out.reserve(4*decLen + 3 + 2*hexLen + 1);
+    out.dec(eid);
+    out.put(',');
+    out.dec(tid);
+
+    out.put(" # ");
+    out.dec(producerTID);
+    out.put(' ');
+    out.dec(producerEID);
+    out.put(' ');
+
+    out.hex(start);
+    out.put(' ');
+    out.hex(end);
+
+    out.put('\n');
+    pos.onEvent(eid);
 }
 
 
 auto TextLoggerUncompressed::flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                                    EID eid, TID tid) -> void
 {
-    flushSyncEvent(syncType, numArgs, syncArgs, eid, tid, logger);
+    flushSyncEvent(syncType, numArgs, syncArgs, eid, tid, out);
+    pos.onSync(syncType, eid);
 }
 
 
 auto TextLoggerUncompressed::instrMarker(int limit) -> void
 {
-    flushInstrMarker(limit, logger);
+    flushInstrMarker(limit, out);
+    pos.onMarker(limit);
 }
 
 
@@ -322,7 +307,29 @@ auto flushPthread(std::string filePath,
 }
 
 
-auto flushStats(std::string filePath, ThreadStatMap allThreadsStats) -> void
+namespace
+{
+
+auto formatSummary(const StatSummary &summary) -> std::string
+{
+    /* e.g. "sum 300, min 1, max 200, log2 histogram 1:1 7:1 8:1",
+     * where 'N:count' counts values in [2^(N-1), 2^N) */
+    std::ostringstream ss;
+    ss << "sum " << summary.sum
+       << ", min " << summary.min
+       << ", max " << summary.max
+       << ", log2 histogram";
+    for (size_t i = 0; i < summary.log2Buckets.size(); ++i)
+        if (summary.log2Buckets[i] > 0)
+            ss << " " << i << ":" << summary.log2Buckets[i];
+    return ss.str();
+}
+
+}; //end namespace
+
+
+auto flushStats(std::string filePath, ThreadStatMap allThreadsStats,
+                ShadowMemoryStats shadowStats) -> void
 {
     auto loggerPair = sigil2::getFileLogger(filePath);
     auto logger = std::move(loggerPair.first);
@@ -343,32 +350,32 @@ auto flushStats(std::string filePath, ThreadStatMap allThreadsStats) -> void
 
         totalInstrs += std::get<INSTR>(stats);
 
-        AllBarriersStats barrierStatsForThread = p.second.getBarrierStats();
-        for (auto &p : barrierStatsForThread)
+        p.second.forEachBarrier([&](Addr id, const BarrierStats &region)
         {
-            /* per barrier region */
-            logger->info("\tBarrier: " + std::to_string(p.first));
-            logger->info("\t\tIOPs: " + std::to_string(p.second.iops));
-            logger->info("\t\tFLOPs: " + std::to_string(p.second.flops));
-            logger->info("\t\tInstrs: " + std::to_string(p.second.instrs));
-            logger->info("\t\tMemAccesses: " + std::to_string(p.second.memAccesses));
-            logger->info("\t\tCommunication: " + std::to_string(p.second.communication));
-            logger->info("\t\tlocks: " + std::to_string(p.second.locks));
-            logger->info("\t\tIOPs/Mem: " + std::to_string(p.second.iopsPerMemAccess()));
-            logger->info("\t\tFLOPs/Mem: " + std::to_string(p.second.flopsPerMemAccess()));
-            logger->info("\t\tlocks/OPs: " + std::to_string(p.second.locksPerIopsPlusFlops()));
-        }
+            /* per barrier region, read back from the thread's barrier statistics file */
+            logger->info("\tBarrier: " + std::to_string(id));
+            logger->info("\t\tIOPs: " + std::to_string(region.iops));
+            logger->info("\t\tFLOPs: " + std::to_string(region.flops));
+            logger->info("\t\tInstrs: " + std::to_string(region.instrs));
+            logger->info("\t\tMemAccesses: " + std::to_string(region.memAccesses));
+            logger->info("\t\tCommunication: " + std::to_string(region.communication));
+            logger->info("\t\tlocks: " + std::to_string(region.locks));
+            logger->info("\t\tIOPs/Mem: " + std::to_string(region.iopsPerMemAccess()));
+            logger->info("\t\tFLOPs/Mem: " + std::to_string(region.flopsPerMemAccess()));
+            logger->info("\t\tlocks/OPs: " + std::to_string(region.locksPerIopsPlusFlops()));
+        });
 
         AllLocksStats lockStatsForThread = p.second.getLockStats();
         for (auto &p : lockStatsForThread)
         {
-            /* per lock region */
+            /* per lock, over all its lock regions */
             logger->info("\tLock: " + std::to_string(p.first));
-            logger->info("\t\tIOPs: " + std::to_string(p.second.iops));
-            logger->info("\t\tFLOPs: " + std::to_string(p.second.flops));
-            logger->info("\t\tInstrs: " + std::to_string(p.second.instrs));
-            logger->info("\t\tMemAccesses: " + std::to_string(p.second.memAccesses));
-            logger->info("\t\tCommunication: " + std::to_string(p.second.communication));
+            logger->info("\t\tRegions: " + std::to_string(p.second.count));
+            logger->info("\t\tIOPs: " + formatSummary(p.second.iops));
+            logger->info("\t\tFLOPs: " + formatSummary(p.second.flops));
+            logger->info("\t\tInstrs: " + formatSummary(p.second.instrs));
+            logger->info("\t\tMemAccesses: " + formatSummary(p.second.memAccesses));
+            logger->info("\t\tCommunication: " + formatSummary(p.second.communication));
         }
     }
 
@@ -391,8 +398,42 @@ auto flushStats(std::string filePath, ThreadStatMap allThreadsStats) -> void
     }
 
     logger->info("Total instructions for all threads: " + std::to_string(totalInstrs));
+
+    logger->info("Shadow memory:");
+    logger->info("\tSecondary maps allocated: " + std::to_string(shadowStats.smAllocated));
+    logger->info("\tSecondary maps resident: " + std::to_string(shadowStats.smResident));
+    logger->info("\tResident bytes: " + std::to_string(shadowStats.bytesResident));
+    logger->info("\tPeak resident bytes: " + std::to_string(shadowStats.bytesPeak));
+    logger->info("\tSecondary maps spilled: " + std::to_string(shadowStats.smEvicted));
+    logger->info("\tSecondary maps restored: " + std::to_string(shadowStats.smFaulted));
+    logger->info("\tSpill file bytes: " + std::to_string(shadowStats.spillFileBytes));
+    logger->info("\tReader sets: " + std::to_string(shadowStats.readerSets));
+    logger->info("\tPeak reader sets: " + std::to_string(shadowStats.readerSetsPeak));
     logger->flush();
     sigil2::blockingFlushAndDeleteLogger(logger);
 }
 
+auto flushCommMatrix(std::string filePath, const ThreadStatMap &allThreadsStats) -> void
+{
+    info("Flushing communication matrix to: " + filePath);
+
+    FILE *file = fopen(filePath.c_str(), "w");
+    if (file == NULL)
+        fatal("opening communication matrix: " + filePath + ": " + strerror(errno));
+
+    /* sparse, only thread pairs that communicated */
+    bool ok = fputs("consumer,producer,bytes,edges\n", file) != EOF;
+    for (auto &p : allThreadsStats)
+    {
+        auto &row = p.second.getCommRow();
+        for (size_t producer = 0; producer < row.size() && ok; ++producer)
+            if (row[producer].edges > 0)
+                ok = fprintf(file, "%d,%zu,%llu,%llu\n", p.first, producer,
+                             row[producer].bytes, row[producer].edges) >= 0;
+    }
+
+    if (ok == false || fclose(file) != 0)
+        fatal("writing communication matrix: " + filePath + ": " + strerror(errno));
+}
+
 }; //end namespace STGen
@@ -5,6 +5,7 @@
 #include "Utils/FileLogger.hpp"
 #include "STLogger.hpp"
 #include "BarrierMerge.hpp"
+#include "TextWriter.hpp"
 #include "spdlog/spdlog.h"
 #include <sstream>
 
@@ -14,7 +15,8 @@ namespace STGen
 
 class TextLoggerCompressed : public STLoggerCompressed
 {
-    /* Uses spdlog logging library to asynchronously log to a text file.
+    /* Formats events directly into a gzipped text file,
+     * with a side index for seeking (see TraceIndex.hpp).
      * The format is a custom format.
      * Each new logger writes to a new file */
 
@@ -29,17 +31,19 @@ class TextLoggerCompressed : public STLoggerCompressed
     auto flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
                EID eid, TID tid) -> void override final;
     auto instrMarker(int limit) -> void override final;
+    auto repeat(unsigned events, unsigned period, int64_t stride,
+                EID eid, TID tid) -> void override final;
 
   private:
-    std::string logMsg; // reuse to save on heap allocations space
-    std::shared_ptr<spdlog::logger> logger;
-    std::shared_ptr<gzofstream> gzfile;
+    TracePosition pos;
+    TextWriter out;
 };
 
 
 class TextLoggerUncompressed : public STLoggerUncompressed
 {
-    /* Uses spdlog logging library to asynchronously log to a text file.
+    /* Formats events directly into a gzipped text file,
+     * with a side index for seeking (see TraceIndex.hpp).
      * The format is a custom format.
      * Each new logger writes to a new file */
 
@@ -59,9 +63,8 @@ class TextLoggerUncompressed : public STLoggerUncompressed
     auto instrMarker(int limit) -> void override final;
 
   private:
-    std::string logMsg; // reuse to save on heap allocations space
-    std::shared_ptr<spdlog::logger> logger;
-    std::shared_ptr<gzofstream> gzfile;
+    TracePosition pos;
+    TextWriter out;
 };
 
 
@@ -70,7 +73,11 @@ auto flushPthread(std::string filePath,
                   SpawnList threadSpawns,
                   BarrierList barrierParticipants) -> void;
 
-auto flushStats(std::string filePath, ThreadStatMap allThreadsStats) -> void;
+auto flushStats(std::string filePath, ThreadStatMap allThreadsStats,
+                ShadowMemoryStats shadowStats) -> void;
+
+auto flushCommMatrix(std::string filePath, const ThreadStatMap &allThreadsStats) -> void;
+/* CSV of the bytes and edges between each consumer and producer thread */
 
 }; //end namespace STGen
 
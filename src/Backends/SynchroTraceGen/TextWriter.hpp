@@ -0,0 +1,185 @@
+#ifndef STGEN_TEXT_WRITER_H
+#define STGEN_TEXT_WRITER_H
+
+#include "STTypes.hpp" // Addr
+#include "ParallelGzip.hpp"
+#include <memory>
+#include <type_traits>
+#include <cstring>
+#include <cassert>
+
+namespace STGen
+{
+
+class TextWriter
+{
+    /* Formats text directly into a per-thread buffer.
+     * No intermediate strings are built, and full blocks
+     * are handed to the gzip writer in one call.
+     *
+     * Callers reserve space for a whole line first;
+     * the appends themselves do not check for space.
+     *
+     * With a trace position, the output is indexed. Flushes happen only
+     * between lines, where 'pos' must hold the position of the next line */
+  public:
+    static constexpr size_t blockSize = 1 << 20;
+    static constexpr size_t maxDecLen = 20;
+    static constexpr size_t maxHexLen = sizeof(Addr)*2 + 2;
+
+    TextWriter(std::string filePath, const TracePosition *pos = nullptr)
+        : gz(filePath, pos != nullptr)
+        , pos(pos)
+        , capacity(blockSize)
+        , buf(new char[blockSize])
+    {
+    }
+    TextWriter(const TextWriter &) = delete;
+    TextWriter &operator=(const TextWriter &) = delete;
+    ~TextWriter()
+    {
+        flush();
+        /* GzipWriter destructor finishes the file */
+    }
+
+    auto reserve(size_t bytes) -> void
+    {
+        if (used + bytes <= capacity)
+            return;
+
+        flush();
+        if (bytes > capacity)
+        {
+            /* an unusually long line */
+            capacity = bytes;
+            buf.reset(new char[capacity]);
+        }
+    }
+
+    auto put(char c) -> void
+    {
+        assert(used < capacity);
+        buf[used++] = c;
+    }
+
+    template <size_t N>
+    auto put(const char (&s)[N]) -> void
+    {
+        /* string literals, without the terminating null */
+        assert(used + N-1 <= capacity);
+        memcpy(buf.get() + used, s, N-1);
+        used += N-1;
+    }
+
+    template <typename I>
+    auto dec(I val) -> void
+    {
+        static_assert(std::is_integral<I>::value, "decimal format needs an integer");
+        dec(val, std::is_signed<I>{});
+    }
+
+    auto hex(Addr val) -> void
+    {
+        /* Leading zeros are dropped, e.g. 0xdeadbeef.
+         * XXX For compatibility with existing traces,
+         * zero is printed at full width, i.e. 0x0000000000000000 */
+        static const char digits[] = "0123456789abcdef";
+        constexpr int hexDigits = sizeof(Addr)*2;
+
+        int len = hexDigits;
+        if (val != 0)
+            len = hexDigits - __builtin_clzll(val)/4;
+
+        assert(used + len + 2 <= capacity);
+        char *p = buf.get() + used;
+        p[0] = '0';
+        p[1] = 'x';
+        for (int i = len+1; i >= 2; --i, val >>= 4)
+            p[i] = digits[val & 0x0f];
+        used += len + 2;
+    }
+
+    auto flush() -> void
+    {
+        if (used == 0)
+            return;
+
+        gz.write(buf.get(), used);
+        used = 0;
+        if (pos != nullptr)
+            gz.mark(*pos);
+    }
+
+  private:
+    auto decUnsigned(uint64_t val) -> void
+    {
+        static const char pairs[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        /* write backwards from the end of a scratch area, two digits at a time */
+        char tmp[maxDecLen];
+        char *end = tmp + maxDecLen;
+        char *p = end;
+        while (val >= 100)
+        {
+            unsigned idx = (val % 100) * 2;
+            val /= 100;
+            *--p = pairs[idx+1];
+            *--p = pairs[idx];
+        }
+        if (val >= 10)
+        {
+            *--p = pairs[val*2+1];
+            *--p = pairs[val*2];
+        }
+        else
+        {
+            *--p = '0' + val;
+        }
+
+        size_t len = end - p;
+        assert(used + len <= capacity);
+        memcpy(buf.get() + used, p, len);
+        used += len;
+    }
+
+    template <typename I>
+    auto dec(I val, std::true_type) -> void
+    {
+        if (val < 0)
+        {
+            put('-');
+            decUnsigned(static_cast<uint64_t>(0) - static_cast<uint64_t>(val));
+        }
+        else
+        {
+            decUnsigned(val);
+        }
+    }
+
+    template <typename I>
+    auto dec(I val, std::false_type) -> void
+    {
+        decUnsigned(val);
+    }
+
+    GzipWriter gz;
+    const TracePosition *pos;
+
+    size_t capacity;
+    size_t used{0};
+    std::unique_ptr<char[]> buf;
+};
+
+}; //end namespace STGen
+
+#endif
@@ -1,11 +1,99 @@
 #include "ThreadContext.hpp"
 #include "TextLogger.hpp"
 #include "CapnLogger.hpp"
+#include "RawLogger.hpp"
 #include "NullLogger.hpp"
+#include "RepeatLogger.hpp"
+#include "TraceShards.hpp"
+#include <algorithm>
 
 namespace STGen
 {
 
+namespace
+{
+
+auto barrierStatsPath(TID tid, std::string outputPath) -> std::string
+{
+    return outputPath + "/sigil.barriers.out-" + std::to_string(tid) + ".csv";
+}
+
+auto commRegionsPath(TID tid, std::string outputPath) -> std::string
+{
+    return outputPath + "/sigil.comm.out-" + std::to_string(tid) + ".csv";
+}
+
+}; //end namespace
+
+
+//-----------------------------------------------------------------------------
+/** Shadow Memory Checks **/
+auto ThreadContext::classifyRead(TID tid, Addr start, Addr bytes,
+                                 bool firstEdgeOnly, ReadRuns &runs) -> void
+{
+    runs.clear();
+    const unsigned levels = shadow.getLevels();
+    EID writerEvents[maxCompressionLevels];
+
+    /* Each byte of the read may have been touched by a different thread,
+     * so check the reader/writer pair for each byte.
+     * Consecutive bytes from the same producer event are batched into one run */
+    for (Addr i = 0; i < bytes; ++i)
+    {
+        Addr addr = start + i;
+        TID producer = SO_UNDEF;
+        try
+        {
+            TID writer = shadow.getWriterTID(addr);
+            bool isReader= shadow.isReaderTID(addr, tid);
+
+            if (isReader == false)
+                shadow.updateReader(addr, 1, tid);
+
+            if ((isReader == false) && (writer != tid) && (writer != SO_UNDEF))
+            {
+                producer = writer;
+                shadow.getWriterEIDs(addr, writerEvents);
+            }
+        }
+        catch(std::out_of_range &e)
+        {
+            /* treat as a local event */
+            warn(e.what());
+        }
+
+        if (runs.empty() == false && runs.back().writer == producer &&
+            (producer == SO_UNDEF ||
+             std::equal(writerEvents, writerEvents + levels, runs.back().writerEvents)))
+        {
+            runs.back().end = addr;
+        }
+        else
+        {
+            runs.push_back(ReadRun{producer, addr, addr, {}});
+            if (producer != SO_UNDEF)
+                std::copy(writerEvents, writerEvents + levels, runs.back().writerEvents);
+        }
+
+        if (firstEdgeOnly == true && producer != SO_UNDEF)
+            break;
+    }
+}
+
+
+auto ThreadContext::recordWrite(TID tid, Addr start, Addr bytes, const EID *eids) -> void
+{
+    try
+    {
+        shadow.updateWriter(start, bytes, tid, eids);
+    }
+    catch(std::out_of_range &e)
+    {
+        warn(e.what());
+    }
+}
+
+
 //-----------------------------------------------------------------------------
 /** Compressed ThreadContext **/
 ThreadContextCompressed::ThreadContextCompressed(TID tid,
@@ -14,12 +102,14 @@ ThreadContextCompressed::ThreadContextCompressed(TID tid,
                                                  std::string loggerType)
     : tid(tid)
     , primsPerStCompEv(primsPerStCompEv)
+    , stats(barrierStatsPath(tid, outputPath), commRegionsPath(tid, outputPath))
+    , outputPath(outputPath)
+    , loggerType(loggerType)
 {
-    /* current shadow memory limit */
-    assert(tid <= 128);
+    assert(tid > 0);
     assert(primsPerStCompEv > 0 && primsPerStCompEv <= 100);
 
-    logger = getLogger(tid, outputPath, loggerType);
+    openTrace();
 }
 
 
@@ -27,6 +117,9 @@ ThreadContextCompressed::~ThreadContextCompressed()
 {
     compFlushIfActive();
     commFlushIfActive();
+
+    if (TraceShards::sharded() == true)
+        TraceShards::record(region, tid, tracePath, regionStart, events, nullptr);
 }
 
 
@@ -53,39 +146,30 @@ auto ThreadContextCompressed::onFlop() -> void
 
 
 auto ThreadContextCompressed::onRead(Addr start, Addr bytes) -> void
+{
+    classifyRead(tid, start, bytes, false, runs);
+    applyRead(start, bytes, runs, 0);
+}
+
+
+auto ThreadContextCompressed::applyRead(Addr, Addr,
+                                        const ReadRuns &runs, unsigned level) -> void
 {
     bool isCommEdge = false;
 
-    /* Each byte of the read may have been touched by a different thread,
-     * so check the reader/writer pair for each byte */
-    for (Addr i = 0; i < bytes; ++i)
+    for (auto &run : runs)
     {
-        Addr addr = start + i;
-        try
+        if (run.writer != SO_UNDEF)
         {
-            TID writer = shadow.getWriterTID(addr);
-            bool isReader= shadow.isReaderTID(addr, tid);
-
-            if (isReader == false)
-                shadow.updateReader(addr, 1, tid);
-
-            if ((isReader == false) && (writer != tid) && (writer != SO_UNDEF))
-            {
-                isCommEdge = true;
-                stComm.addEdge(writer, shadow.getWriterEID(addr), addr);
-            }
-            else /*local load, comp event*/
-            {
-                /* treat a read/write to an address with
-                 * UNDEF thread as a local compute event */
-                stComp.updateReads(addr, 1);
-            }
+            isCommEdge = true;
+            stComm.addEdge(run.writer, run.writerEvents[level], run.begin, run.end);
+            stats.incCommEdge(run.writer, run.end - run.begin + 1);
         }
-        catch(std::out_of_range &e)
+        else /*local load, comp event*/
         {
-            /* treat as a local event */
-            warn(e.what());
-            stComp.updateReads(addr, 1);
+            /* treat a read/write to an address with
+             * UNDEF thread as a local compute event */
+            stComp.updateReads(run.begin, run.end - run.begin + 1);
         }
     }
 
@@ -111,21 +195,22 @@ auto ThreadContextCompressed::onRead(Addr start, Addr bytes) -> void
 
 
 auto ThreadContextCompressed::onWrite(Addr start, Addr bytes) -> void
+{
+    EID writerEvent = applyWrite(start, bytes);
+    recordWrite(tid, start, bytes, &writerEvent);
+}
+
+
+auto ThreadContextCompressed::applyWrite(Addr start, Addr bytes) -> EID
 {
     stComp.incWrites();
     stComp.updateWrites(start, bytes);
 
-    try
-    {
-        shadow.updateWriter(start, bytes, tid, events);
-    }
-    catch(std::out_of_range &e)
-    {
-        warn(e.what());
-    }
-
+    EID writerEvent = events;
     checkCompFlushLimit();
     stats.incWrites();
+
+    return writerEvent;
 }
 
 
@@ -140,6 +225,9 @@ auto ThreadContextCompressed::onSync(unsigned char syncType,
 
     if (INCR_EID_OVERFLOW(events))
         fatal("Event ID overflow detected in thread: " + std::to_string(tid));
+
+    if (syncType == barrierSyncType && TraceShards::sharded() == true)
+        nextRegion(syncArgs[0]);
 }
 
 
@@ -197,17 +285,45 @@ auto ThreadContextCompressed::flushAll() -> void
 }
 
 
+auto ThreadContextCompressed::openTrace() -> void
+{
+    /* each barrier region has its own trace when sharded */
+    if (TraceShards::sharded() == true)
+        tracePath = TraceShards::regionPath(outputPath, region);
+    else
+        tracePath = outputPath;
+    logger = getLogger(tid, tracePath, loggerType);
+}
+
+
+auto ThreadContextCompressed::nextRegion(Addr barrier) -> void
+{
+    /* the barrier ends the region */
+    TraceShards::record(region, tid, tracePath, regionStart, events, &barrier);
+    ++region;
+    regionStart = events;
+
+    logger.reset();
+    openTrace();
+}
+
+
 auto ThreadContextCompressed::getLogger(TID tid, std::string outputPath,
                                         std::string loggerType) -> LogPtr
 {
+    LogPtr logger;
     if (loggerType == "text")
-        return std::make_unique<TextLoggerCompressed>(tid, outputPath);
+        logger = std::make_unique<TextLoggerCompressed>(tid, outputPath);
     else if (loggerType == "capnp")
-        return std::make_unique<CapnLoggerCompressed>(tid, outputPath);
+        logger = std::make_unique<CapnLoggerCompressed>(tid, outputPath);
     else if (loggerType == "null")
-        return std::make_unique<NullLogger>(tid, outputPath);
+        logger = std::make_unique<NullLogger>(tid, outputPath);
     else
         fatal("Invalid logger type");
+
+    if (RepeatLoggerCompressed::maxPeriod() > 0)
+        logger = std::make_unique<RepeatLoggerCompressed>(std::move(logger));
+    return logger;
 }
 
 
@@ -219,18 +335,23 @@ ThreadContextUncompressed::ThreadContextUncompressed(TID tid,
                                                      std::string loggerType)
     : tid(tid)
     , primsPerStCompEv(primsPerStCompEv)
+    , stats(barrierStatsPath(tid, outputPath), commRegionsPath(tid, outputPath))
+    , outputPath(outputPath)
+    , loggerType(loggerType)
 {
-    /* current shadow memory limit */
-    assert(tid <= 128);
+    assert(tid > 0);
     assert(primsPerStCompEv > 0 && primsPerStCompEv <= 100);
 
-    logger = getLogger(tid, outputPath, loggerType);
+    openTrace();
 }
 
 
 ThreadContextUncompressed::~ThreadContextUncompressed()
 {
     compFlushIfActive();
+
+    if (TraceShards::sharded() == true)
+        TraceShards::record(region, tid, tracePath, regionStart, events, nullptr);
 }
 
 
@@ -264,38 +385,23 @@ auto ThreadContextUncompressed::onRead(Addr start, Addr bytes) -> void
      *
      * TODO MDL20170321 Create parity with compressed read event */
 
-    bool isCommEdge = false;
-    TID producerTID{0};
-    EID producerEID{0};
+    classifyRead(tid, start, bytes, true, runs);
+    applyRead(start, bytes, runs, 0);
+}
 
-    for (Addr i = 0; i < bytes; ++i)
-    {
-        Addr addr = start + i;
-        try
-        {
-            TID writer = shadow.getWriterTID(addr);
-            bool isReader= shadow.isReaderTID(addr, tid);
 
-            if (isReader == false)
-                shadow.updateReader(addr, 1, tid);
+auto ThreadContextUncompressed::applyRead(Addr start, Addr bytes,
+                                          const ReadRuns &runs, unsigned level) -> void
+{
+    /* the first producer stands for the whole read */
+    auto edge = std::find_if(runs.cbegin(), runs.cend(),
+                             [](const ReadRun &run){ return run.writer != SO_UNDEF; });
 
-            if /*comm edge*/((isReader == false) && (writer != tid) && (writer != SO_UNDEF))
-            {
-                isCommEdge = true;
-                producerTID = writer;
-                producerEID = shadow.getWriterEID(addr);
-                break;
-            }
-        }
-        catch(std::out_of_range &e)
-        {
-            /* XXX treat as a local event */
-            warn(e.what());
-        }
+    if (edge != runs.cend())
+    {
+        commFlush(edge->writerEvents[level], edge->writer, start, start+bytes-1);
+        stats.incCommEdge(edge->writer, bytes);
     }
-
-    if (isCommEdge == true)
-        commFlush(producerEID, producerTID, start, start+bytes-1);
     else
         compFlush(STCompEventUncompressed::MemType::READ, start, start+bytes-1);
 
@@ -305,18 +411,16 @@ auto ThreadContextUncompressed::onRead(Addr start, Addr bytes) -> void
 
 auto ThreadContextUncompressed::onWrite(Addr start, Addr bytes) -> void
 {
-    compFlush(STCompEventUncompressed::MemType::WRITE, start, start+bytes-1);
+    EID writerEvent = applyWrite(start, bytes);
+    recordWrite(tid, start, bytes, &writerEvent);
+}
 
-    try
-    {
-        shadow.updateWriter(start, bytes, tid, events);
-    }
-    catch(std::out_of_range &e)
-    {
-        warn(e.what());
-    }
 
+auto ThreadContextUncompressed::applyWrite(Addr start, Addr bytes) -> EID
+{
+    compFlush(STCompEventUncompressed::MemType::WRITE, start, start+bytes-1);
     stats.incWrites();
+    return events;
 }
 
 
@@ -329,6 +433,9 @@ auto ThreadContextUncompressed::onSync(unsigned char syncType,
 
     if (INCR_EID_OVERFLOW(events))
         fatal("Event ID overflow detected in thread: " + std::to_string(tid));
+
+    if (syncType == barrierSyncType && TraceShards::sharded() == true)
+        nextRegion(syncArgs[0]);
 }
 
 
@@ -385,6 +492,29 @@ auto ThreadContextUncompressed::flushAll() -> void
 }
 
 
+auto ThreadContextUncompressed::openTrace() -> void
+{
+    /* each barrier region has its own trace when sharded */
+    if (TraceShards::sharded() == true)
+        tracePath = TraceShards::regionPath(outputPath, region);
+    else
+        tracePath = outputPath;
+    logger = getLogger(tid, tracePath, loggerType);
+}
+
+
+auto ThreadContextUncompressed::nextRegion(Addr barrier) -> void
+{
+    /* the barrier ends the region */
+    TraceShards::record(region, tid, tracePath, regionStart, events, &barrier);
+    ++region;
+    regionStart = events;
+
+    logger.reset();
+    openTrace();
+}
+
+
 auto ThreadContextUncompressed::getLogger(TID tid, std::string outputPath,
                                           std::string loggerType) -> LogPtr
 {
@@ -392,10 +522,116 @@ auto ThreadContextUncompressed::getLogger(TID tid, std::string outputPath,
         return std::make_unique<TextLoggerUncompressed>(tid, outputPath);
     else if (loggerType == "capnp")
         return std::make_unique<CapnLoggerUncompressed>(tid, outputPath);
+    else if (loggerType == "raw")
+        return std::make_unique<RawLoggerUncompressed>(tid, outputPath, false);
+    else if (loggerType == "rawgz")
+        return std::make_unique<RawLoggerUncompressed>(tid, outputPath, true);
     else if (loggerType == "null")
         return std::make_unique<NullLogger>(tid, outputPath);
     else
         fatal("Invalid logger type");
 }
 
+
+
+//-----------------------------------------------------------------------------
+/** Multi-level ThreadContext **/
+ThreadContextMultiLevel::ThreadContextMultiLevel(TID tid,
+                                                 std::vector<unsigned> primsPerStCompEv,
+                                                 std::string outputPath,
+                                                 std::string loggerType)
+    : tid(tid)
+{
+    assert(tid > 0);
+    assert(primsPerStCompEv.size() == shadow.getLevels());
+
+    for (auto prims : primsPerStCompEv)
+    {
+        std::string path = levelPath(outputPath, prims);
+        if (prims == 1)
+            levels.push_back(std::make_unique<ThreadContextUncompressed>(tid, prims, path, loggerType));
+        else
+            levels.push_back(std::make_unique<ThreadContextCompressed>(tid, prims, path, loggerType));
+    }
+}
+
+
+auto ThreadContextMultiLevel::getStats() const -> PerThreadStats
+{
+    return levels.front()->getStats();
+}
+
+
+auto ThreadContextMultiLevel::getLevelStats() const -> std::vector<PerThreadStats>
+{
+    std::vector<PerThreadStats> ret;
+    for (auto &level : levels)
+        ret.push_back(level->getStats());
+    return ret;
+}
+
+
+auto ThreadContextMultiLevel::onIop() -> void
+{
+    for (auto &level : levels)
+        level->onIop();
+}
+
+
+auto ThreadContextMultiLevel::onFlop() -> void
+{
+    for (auto &level : levels)
+        level->onFlop();
+}
+
+
+auto ThreadContextMultiLevel::onRead(Addr start, Addr bytes) -> void
+{
+    /* Every byte is checked and marked as read, as in a compressed context,
+     * including by a '1' level. On its own, an uncompressed context stops
+     * marking bytes after the first communicating byte, so its later reads
+     * of the remaining bytes can differ from a '1' level's */
+    classifyRead(tid, start, bytes, false, runs);
+    for (unsigned i = 0; i < levels.size(); ++i)
+        levels[i]->applyRead(start, bytes, runs, i);
+}
+
+
+auto ThreadContextMultiLevel::onWrite(Addr start, Addr bytes) -> void
+{
+    EID writerEvents[maxCompressionLevels];
+    for (unsigned i = 0; i < levels.size(); ++i)
+        writerEvents[i] = levels[i]->applyWrite(start, bytes);
+    recordWrite(tid, start, bytes, writerEvents);
+}
+
+
+auto ThreadContextMultiLevel::onSync(unsigned char syncType,
+                                     unsigned numArgs, Addr *syncArgs) -> void
+{
+    for (auto &level : levels)
+        level->onSync(syncType, numArgs, syncArgs);
+}
+
+
+auto ThreadContextMultiLevel::onInstr() -> void
+{
+    for (auto &level : levels)
+        level->onInstr();
+}
+
+
+auto ThreadContextMultiLevel::flushAll() -> void
+{
+    for (auto &level : levels)
+        level->flushAll();
+}
+
+
+auto ThreadContextMultiLevel::levelPath(std::string outputPath,
+                                        unsigned primsPerStCompEv) -> std::string
+{
+    return outputPath + "/c" + std::to_string(primsPerStCompEv);
+}
+
 }; //end namespace STGen
@@ -11,19 +11,27 @@
 #define ALLOW_ADDRESS_OVERFLOW 1
 #include "STShadowMemory.hpp"
 
-/* XXX overflow builtin not in GCC <5.
- * This overflow check should only be used for
- * variables which increment by 1 each time. */
-#if __GNUC__ >= 5
-#define INCR_EID_OVERFLOW(var) __builtin_add_overflow(var, 1, &var)
-#else
-#define INCR_EID_OVERFLOW(var) (var == UINT_MAX ? true : (var += 1) && false)
-#endif
+/* This overflow check should only be used for
+ * event IDs, which increment by 1 each time. */
+#define INCR_EID_OVERFLOW(var) (var == MAX_EID ? true : (var += 1) && false)
 
 
 namespace STGen
 {
 
+struct ReadRun
+{
+    /* Consecutive bytes of a read that are either local,
+     * or were all produced by the same event of another thread */
+    TID writer;     /* SO_UNDEF for local bytes */
+    Addr begin;
+    Addr end;
+    EID writerEvents[maxCompressionLevels];
+    /* the producer event at each compression level */
+};
+using ReadRuns = std::vector<ReadRun>;
+
+
 class ThreadContext
 {
     /* SynchroTraceGen makes use of 3 SynchroTrace events,
@@ -35,6 +43,12 @@ class ThreadContext
   public:
     virtual ~ThreadContext() {}
     virtual auto getStats() const -> PerThreadStats = 0;
+    virtual auto getLevelStats() const -> std::vector<PerThreadStats>
+    {
+        return {getStats()};
+    }
+    /* the stats of each compression level, in the order given */
+
     virtual auto onIop() -> void = 0;
     virtual auto onFlop() -> void = 0;
     virtual auto onRead(Addr start, Addr bytes) -> void = 0;
@@ -46,12 +60,44 @@ class ThreadContext
     virtual auto onInstr() -> void = 0;
     virtual auto flushAll() -> void = 0;
 
+    static auto setCompressionLevels(unsigned levels) -> void
+    {
+        shadow.setLevels(levels);
+    }
+    static auto setShadowMemoryLimit(uint64_t bytes, std::string spillDir) -> void
+    {
+        shadow.setLimit(bytes, spillDir);
+    }
+    static auto getShadowMemoryStats() -> ShadowMemoryStats
+    {
+        return shadow.getStats();
+    }
+
   protected:
+    static auto classifyRead(TID tid, Addr start, Addr bytes,
+                             bool firstEdgeOnly, ReadRuns &runs) -> void;
+    /* Check each byte of a read against shadow memory, and mark it as read.
+     * Stops after the first communicating byte if 'firstEdgeOnly' */
+    static auto recordWrite(TID tid, Addr start, Addr bytes, const EID *eids) -> void;
+
     static STShadowMemory shadow; // Shadow memory is shared amongst all threads
 };
 
 
-class ThreadContextCompressed : public ThreadContext
+class ThreadContextLevel : public ThreadContext
+{
+    /* Aggregates events at a single compression level.
+     * Reads and writes can also be passed in after being checked
+     * against shadow memory, so several levels can share one check */
+  public:
+    virtual auto applyRead(Addr start, Addr bytes,
+                           const ReadRuns &runs, unsigned level) -> void = 0;
+    virtual auto applyWrite(Addr start, Addr bytes) -> EID = 0;
+    /* returns the event ID to record as the writer */
+};
+
+
+class ThreadContextCompressed : public ThreadContextLevel
 {
     using LogPtr = std::unique_ptr<STLoggerCompressed>;
   public:
@@ -68,11 +114,17 @@ class ThreadContextCompressed : public ThreadContext
     auto onInstr() -> void override final;
     auto flushAll() -> void override final;
 
+    auto applyRead(Addr start, Addr bytes,
+                   const ReadRuns &runs, unsigned level) -> void override final;
+    auto applyWrite(Addr start, Addr bytes) -> EID override final;
+
   private:
     auto checkCompFlushLimit() -> void;
     auto compFlushIfActive() -> void;
     auto commFlushIfActive() -> void;
     static auto getLogger(TID tid, std::string outputPath, std::string loggerType) -> LogPtr;
+    auto openTrace() -> void;
+    auto nextRegion(Addr barrier) -> void;
 
     STCompEventCompressed stComp;
     STCommEventCompressed stComm;
@@ -81,15 +133,26 @@ class ThreadContextCompressed : public ThreadContext
     unsigned primsPerStCompEv;
     /* compression level of events */
 
-    StatCounter events{0};
+    EID events{0};
     PerThreadStats stats;
     /* track statistics */
 
+    ReadRuns runs;
+    /* reused for each read */
+
     LogPtr logger;
+
+    std::string outputPath;
+    std::string loggerType;
+    std::string tracePath;
+    uint64_t region{0};
+    EID regionStart{0};
+    /* Sharded traces have a directory per barrier region.
+     * See TraceShards.hpp */
 };
 
 
-class ThreadContextUncompressed : public ThreadContext
+class ThreadContextUncompressed : public ThreadContextLevel
 {
     using LogPtr = std::unique_ptr<STLoggerUncompressed>;
   public:
@@ -106,11 +169,17 @@ class ThreadContextUncompressed : public ThreadContext
     auto onInstr() -> void override final;
     auto flushAll() -> void override final;
 
+    auto applyRead(Addr start, Addr bytes,
+                   const ReadRuns &runs, unsigned level) -> void override final;
+    auto applyWrite(Addr start, Addr bytes) -> EID override final;
+
   private:
     auto compFlushIfActive() -> void;
     auto compFlush(STCompEventUncompressed::MemType type, Addr start, Addr end) -> void;
     auto commFlush(EID producerEID, TID producerTID, Addr start, Addr end) -> void;
     static auto getLogger(TID tid, std::string outputPath, std::string loggerType) -> LogPtr;
+    auto openTrace() -> void;
+    auto nextRegion(Addr barrier) -> void;
 
     STCompEventUncompressed stComp;
 
@@ -118,11 +187,55 @@ class ThreadContextUncompressed : public ThreadContext
     unsigned primsPerStCompEv;
     /* compression level of events */
 
-    StatCounter events{0};
+    EID events{0};
     PerThreadStats stats;
     /* track statistics */
 
+    ReadRuns runs;
+    /* reused for each read */
+
     LogPtr logger;
+
+    std::string outputPath;
+    std::string loggerType;
+    std::string tracePath;
+    uint64_t region{0};
+    EID regionStart{0};
+    /* Sharded traces have a directory per barrier region.
+     * See TraceShards.hpp */
+};
+
+
+
+class ThreadContextMultiLevel : public ThreadContext
+{
+    /* Generates events at several compression levels in one pass.
+     * Each read and write is checked against shadow memory once,
+     * and the result is passed to a context for each level.
+     * Each level logs to its own subdirectory of the output path */
+  public:
+    ThreadContextMultiLevel(TID tid, std::vector<unsigned> primsPerStCompEv,
+                            std::string outputPath, std::string loggerType);
+
+    auto getStats() const -> PerThreadStats override final;
+    /* the first level's stats */
+    auto getLevelStats() const -> std::vector<PerThreadStats> override final;
+    auto onIop() -> void override final;
+    auto onFlop() -> void override final;
+    auto onRead(Addr start, Addr bytes) -> void override final;
+    auto onWrite(Addr start, Addr bytes) -> void override final;
+    auto onSync(unsigned char syncType, unsigned numArgs, Addr *syncArgs) -> void override final;
+    auto onInstr() -> void override final;
+    auto flushAll() -> void override final;
+
+    static auto levelPath(std::string outputPath, unsigned primsPerStCompEv) -> std::string;
+
+  private:
+    TID tid;
+    std::vector<std::unique_ptr<ThreadContextLevel>> levels;
+    /* in the order given; level 0's event IDs are kept with the writer */
+
+    ReadRuns runs;
 };
 
 }; //end namespace STGen
@@ -0,0 +1,134 @@
+#include "TraceIndex.hpp"
+#include "Core/SigiLog.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <zlib.h>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+struct IndexedTraceReader::Inflater
+{
+    z_stream strm;
+    unsigned char in[1 << 16];
+};
+
+
+IndexedTraceReader::IndexedTraceReader(std::string tracePath)
+    : tracePath(tracePath)
+    , inflater(std::make_unique<Inflater>())
+{
+    std::string indexPath = tracePath + ".idx";
+    FILE *indexFile = fopen(indexPath.c_str(), "rb");
+    if (indexFile == NULL)
+        fatal("opening trace index: " + indexPath + ": " + strerror(errno));
+
+    IndexHeader header;
+    if (fread(&header, sizeof(header), 1, indexFile) != 1 ||
+        memcmp(header.magic, "STGENIDX", sizeof(header.magic)) != 0)
+        fatal("not a trace index: " + indexPath);
+    if (header.version != traceIndexVersion || header.entryBytes != sizeof(IndexEntry))
+        fatal("unsupported trace index version: " + indexPath);
+
+    IndexEntry entry;
+    while (fread(&entry, sizeof(entry), 1, indexFile) == 1)
+        index.push_back(entry);
+    fclose(indexFile);
+    if (index.empty() == true)
+        fatal("empty trace index: " + indexPath);
+
+    file = fopen(tracePath.c_str(), "rb");
+    if (file == NULL)
+        fatal("opening trace: " + tracePath + ": " + strerror(errno));
+
+    memset(&inflater->strm, 0, sizeof(inflater->strm));
+    if (inflateInit2(&inflater->strm, 15 + 16 /* gzip wrapper */) != Z_OK)
+        fatal("initializing trace decompression");
+}
+
+
+IndexedTraceReader::~IndexedTraceReader()
+{
+    inflateEnd(&inflater->strm);
+    fclose(file);
+}
+
+
+auto IndexedTraceReader::seekEvent(uint64_t eid) -> TracePosition
+{
+    return seek(&IndexEntry::eid, eid, true);
+}
+
+
+auto IndexedTraceReader::seekInstrs(uint64_t instrs) -> TracePosition
+{
+    return seek(&IndexEntry::instrs, instrs, false);
+}
+
+
+auto IndexedTraceReader::seekBarrier(uint64_t barriers) -> TracePosition
+{
+    return seek(&IndexEntry::barriers, barriers, false);
+}
+
+
+auto IndexedTraceReader::seek(uint64_t IndexEntry::*key, uint64_t value,
+                              bool inclusive) -> TracePosition
+{
+    /* positions never decrease through the trace */
+    auto it = (inclusive == true ?
+               std::upper_bound(index.cbegin(), index.cend(), value,
+                                [key](uint64_t v, const IndexEntry &e){ return v < e.*key; }) :
+               std::lower_bound(index.cbegin(), index.cend(), value,
+                                [key](const IndexEntry &e, uint64_t v){ return e.*key < v; }));
+    if (it != index.cbegin())
+        --it;
+
+    if (fseeko(file, it->offset, SEEK_SET) != 0)
+        fatal("seeking trace: " + tracePath + ": " + strerror(errno));
+    inflateReset(&inflater->strm);
+    inflater->strm.avail_in = 0;
+
+    TracePosition pos;
+    pos.eid = it->eid;
+    pos.instrs = it->instrs;
+    pos.barriers = it->barriers;
+    return pos;
+}
+
+
+auto IndexedTraceReader::read(void *buf, size_t bytes) -> size_t
+{
+    z_stream &strm = inflater->strm;
+    strm.next_out = static_cast<Bytef*>(buf);
+    strm.avail_out = bytes;
+
+    while (strm.avail_out > 0)
+    {
+        if (strm.avail_in == 0)
+        {
+            size_t got = fread(inflater->in, 1, sizeof(inflater->in), file);
+            if (got == 0)
+            {
+                if (ferror(file) != 0)
+                    fatal("reading trace: " + tracePath + ": " + strerror(errno));
+                break;
+            }
+            strm.next_in = inflater->in;
+            strm.avail_in = got;
+        }
+
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+            inflateReset(&strm); /* on to the next member */
+        else if (ret != Z_OK)
+            fatal("decompressing trace: " + tracePath);
+    }
+
+    return bytes - strm.avail_out;
+}
+
+}; //end namespace STGen
@@ -0,0 +1,116 @@
+#ifndef STGEN_TRACE_INDEX_H
+#define STGEN_TRACE_INDEX_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Side index for gzipped SynchroTraceGen traces.
+ *
+ * Indexed traces are cut into gzip members only between events, so
+ * decompression can start at any member and the first byte out is the
+ * start of an event (a text line, a capnproto message, or a raw event).
+ *
+ * Each trace 'sigil.events.out-#...gz' has an index 'sigil.events.out-#...gz.idx',
+ * an IndexHeader followed by one IndexEntry per member, in file order.
+ * Each entry holds the trace position at the start of its member.
+ * The first member also starts with the trace's file header, if it has one.
+ * Seeking to an event, instruction count, or barrier is a binary search
+ * of the index, then decompressing a single member to reach the target.
+ *
+ * Simulators can include this header and build TraceIndex.cpp
+ * to read traces */
+
+namespace STGen
+{
+
+constexpr uint16_t traceIndexVersion = 1;
+constexpr unsigned char barrierSyncType = 5; /* P_BARRIER_WT */
+
+struct TracePosition
+{
+    /* A point in a thread's trace, between two events */
+    uint64_t eid{0};        /* ID of the next event */
+    uint64_t instrs{0};     /* instructions counted by markers so far */
+    uint64_t barriers{0};   /* barriers passed so far */
+
+    auto onEvent(uint64_t id) -> void { eid = id + 1; }
+    auto onSync(unsigned char syncType, uint64_t id) -> void
+    {
+        onEvent(id);
+        if (syncType == barrierSyncType)
+            ++barriers;
+    }
+    auto onMarker(int limit) -> void { instrs += limit; }
+};
+
+
+struct IndexHeader
+{
+    char magic[8];          /* "STGENIDX" */
+    uint16_t version;       /* traceIndexVersion */
+    uint16_t entryBytes;    /* sizeof(IndexEntry) */
+    uint32_t reserved;
+};
+
+struct IndexEntry
+{
+    uint64_t offset;        /* byte offset of the gzip member in the trace */
+    uint64_t inOffset;      /* uncompressed byte offset of the member */
+    uint64_t eid;
+    uint64_t instrs;
+    uint64_t barriers;
+    /* trace position at the start of the member */
+};
+
+static_assert(sizeof(IndexHeader) == 16, "trace index header layout changed");
+static_assert(sizeof(IndexEntry) == 40, "trace index entry layout changed");
+
+
+class IndexedTraceReader
+{
+    /* Reads an indexed trace from any indexed position.
+     *
+     * After a seek, read() returns the decompressed trace from the
+     * start of the chosen member onward, through the end of the file.
+     * The returned position is where decompression starts: at or before
+     * the target, within one member of it */
+  public:
+    IndexedTraceReader(std::string tracePath);
+    IndexedTraceReader(const IndexedTraceReader &) = delete;
+    IndexedTraceReader &operator=(const IndexedTraceReader &) = delete;
+    ~IndexedTraceReader();
+
+    auto seekEvent(uint64_t eid) -> TracePosition;
+    /* the member holding event 'eid' */
+
+    auto seekInstrs(uint64_t instrs) -> TracePosition;
+    /* the member holding the marker that reaches 'instrs' instructions */
+
+    auto seekBarrier(uint64_t barriers) -> TracePosition;
+    /* the member where 'barriers' barriers have been passed */
+
+    auto read(void *buf, size_t bytes) -> size_t;
+    /* returns 0 at the end of the trace */
+
+    auto entries() const -> const std::vector<IndexEntry>& { return index; }
+
+  private:
+    auto seek(uint64_t IndexEntry::*key, uint64_t value, bool inclusive) -> TracePosition;
+    /* the last member starting before 'value', or at it if 'inclusive'.
+     * A member starting with N barriers or instructions passed may start
+     * after the Nth barrier or marker itself, so counts are exclusive */
+
+    const std::string tracePath;
+    std::vector<IndexEntry> index;
+    FILE *file{nullptr};
+
+    struct Inflater;
+    std::unique_ptr<Inflater> inflater;
+};
+
+}; //end namespace STGen
+
+#endif
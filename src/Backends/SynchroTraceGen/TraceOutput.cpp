@@ -0,0 +1,114 @@
+#include "TraceOutput.hpp"
+#include "Core/SigiLog.hpp"
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+namespace
+{
+
+std::string socketPath;
+/* set once, before any threads write output */
+
+}; //end namespace
+
+
+auto TraceOutput::configure(std::string path) -> void
+{
+    sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path))
+        fatal("trace stream socket path is too long: " + path);
+    socketPath = path;
+}
+
+
+auto TraceOutput::streaming() -> bool
+{
+    return socketPath.empty() == false;
+}
+
+
+TraceOutput::TraceOutput(std::string filePath)
+    : filePath(filePath)
+{
+    if (streaming() == true)
+    {
+        connectStream();
+    }
+    else
+    {
+        file = fopen(filePath.c_str(), "wb");
+        if (file == NULL)
+            fatal("opening trace: " + filePath + ": " + strerror(errno));
+    }
+}
+
+
+TraceOutput::~TraceOutput()
+{
+    if (file != nullptr && fclose(file) != 0)
+        fatal("closing trace: " + filePath + ": " + strerror(errno));
+    if (fd >= 0 && close(fd) != 0)
+        fatal("closing trace stream: " + filePath + ": " + strerror(errno));
+}
+
+
+auto TraceOutput::write(const void *data, size_t bytes) -> void
+{
+    if (file != nullptr)
+    {
+        if (fwrite(data, 1, bytes, file) != bytes)
+            fatal("writing trace: " + filePath + ": " + strerror(errno));
+        return;
+    }
+
+    const char *src = static_cast<const char*>(data);
+    while (bytes > 0)
+    {
+        /* blocks until the consumer makes room */
+        ssize_t sent = send(fd, src, bytes, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fatal("streaming trace: " + filePath + ": " + strerror(errno));
+        }
+        src += sent;
+        bytes -= sent;
+    }
+}
+
+
+auto TraceOutput::connectStream() -> void
+{
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        fatal("creating trace stream: " + std::string(strerror(errno)));
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        fatal("connecting to trace consumer at " + socketPath + ": " + strerror(errno));
+
+    /* the consumer only sees the file name, not the output directory */
+    std::string name = filePath.substr(filePath.find_last_of('/') + 1);
+
+    TraceStreamHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "STGENSTR", sizeof(header.magic));
+    header.version = traceStreamVersion;
+    header.nameBytes = name.size();
+    write(&header, sizeof(header));
+    write(name.data(), name.size());
+}
+
+}; //end namespace STGen
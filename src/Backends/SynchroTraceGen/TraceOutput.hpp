@@ -0,0 +1,66 @@
+#ifndef STGEN_TRACE_OUTPUT_H
+#define STGEN_TRACE_OUTPUT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace STGen
+{
+
+constexpr uint16_t traceStreamVersion = 1;
+
+struct TraceStreamHeader
+{
+    /* Sent first on each stream, followed by 'nameBytes' of the trace
+     * file's name, e.g. "sigil.events.out-1.gz".
+     * The rest of the stream is the trace file's contents, until the
+     * writer closes the connection */
+    char magic[8];          /* "STGENSTR" */
+    uint16_t version;       /* traceStreamVersion */
+    uint16_t nameBytes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TraceStreamHeader) == 16, "trace stream header layout changed");
+
+
+class TraceOutput
+{
+    /* Where a trace file's contents go.
+     *
+     * By default, each trace is a file.
+     * When streaming, each trace is instead sent to a live consumer over
+     * its own connection to a Unix domain socket, as it is produced.
+     * Writes block while the consumer falls behind, so a slow consumer
+     * throttles trace generation instead of filling memory.
+     *
+     * A single output is not thread safe; calls must be serialized */
+  public:
+    static auto configure(std::string socketPath) -> void;
+    /* Stream to the consumer listening on 'socketPath'.
+     * Must be called before any output is created.
+     * An empty path writes files */
+
+    static auto streaming() -> bool;
+
+    TraceOutput(std::string filePath);
+    TraceOutput(const TraceOutput &) = delete;
+    TraceOutput &operator=(const TraceOutput &) = delete;
+    ~TraceOutput();
+
+    auto write(const void *data, size_t bytes) -> void;
+
+    auto name() const -> const std::string& { return filePath; }
+
+  private:
+    auto connectStream() -> void;
+
+    const std::string filePath;
+    FILE *file{nullptr};
+    int fd{-1};
+};
+
+}; //end namespace STGen
+
+#endif
@@ -0,0 +1,81 @@
+#include "TraceShards.hpp"
+#include "Core/SigiLog.hpp"
+#include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+#include <sys/stat.h>
+
+using SigiLog::fatal;
+
+namespace STGen
+{
+
+namespace
+{
+
+FILE *manifest{nullptr};
+std::string manifestPath;
+std::mutex manifestMtx;
+/* set once, before any threads write output */
+
+}; //end namespace
+
+
+auto TraceShards::configure(bool sharded, std::string outputPath) -> void
+{
+    if (sharded == false)
+        return;
+
+    manifestPath = outputPath + "/sigil.shards.out.csv";
+    manifest = fopen(manifestPath.c_str(), "w");
+    if (manifest == NULL)
+        fatal("opening shard manifest: " + manifestPath + ": " + strerror(errno));
+    if (fputs("region,thread,path,firstEvent,endEvent,barrier\n", manifest) == EOF)
+        fatal("writing shard manifest: " + manifestPath + ": " + strerror(errno));
+}
+
+
+auto TraceShards::sharded() -> bool
+{
+    return manifest != nullptr;
+}
+
+
+auto TraceShards::regionPath(std::string outputPath, uint64_t region) -> std::string
+{
+    /* every thread reaching the region tries to create it */
+    std::string path = outputPath + "/r" + std::to_string(region);
+    if (mkdir(path.c_str(), 0777) != 0 && errno != EEXIST)
+        fatal("creating output directory: " + path + ": " + strerror(errno));
+    return path;
+}
+
+
+auto TraceShards::record(uint64_t region, TID tid, std::string path,
+                         EID firstEvent, EID endEvent, const Addr *barrier) -> void
+{
+    assert(manifest != nullptr);
+
+    std::string line = (std::to_string(region) + "," + std::to_string(tid) + "," +
+                        path + "," + std::to_string(firstEvent) + "," +
+                        std::to_string(endEvent) + "," +
+                        (barrier != nullptr ? std::to_string(*barrier) : "") + "\n");
+
+    std::lock_guard<std::mutex> lock(manifestMtx);
+    if (fputs(line.c_str(), manifest) == EOF)
+        fatal("writing shard manifest: " + manifestPath + ": " + strerror(errno));
+}
+
+
+auto TraceShards::close() -> void
+{
+    if (manifest == nullptr)
+        return;
+
+    if (fclose(manifest) != 0)
+        fatal("closing shard manifest: " + manifestPath + ": " + strerror(errno));
+    manifest = nullptr;
+}
+
+}; //end namespace STGen
@@ -0,0 +1,45 @@
+#ifndef STGEN_TRACE_SHARDS_H
+#define STGEN_TRACE_SHARDS_H
+
+#include "STTypes.hpp"
+#include <string>
+
+namespace STGen
+{
+
+class TraceShards
+{
+    /* Splits each thread's trace at every barrier, so downstream tools
+     * can process barrier regions concurrently.
+     *
+     * Region N of a thread holds its events after its Nth barrier, up to
+     * and including the next barrier. Its trace goes to the usual file name
+     * in the region's own directory, 'PATH/rN'. Event IDs are not restarted,
+     * so communication edges still name the producer's event.
+     *
+     * Each completed region is listed in a CSV manifest, 'PATH/sigil.shards.out.csv',
+     * as the thread that wrote it moves on or finishes:
+     *   region,thread,path,firstEvent,endEvent,barrier
+     * where events [firstEvent, endEvent) are in the region, and the barrier
+     * that ended it is empty for the last region of each thread.
+     * Lines from different threads may be interleaved in any order */
+  public:
+    static auto configure(bool sharded, std::string outputPath) -> void;
+    /* Must be called before any traces are created */
+
+    static auto sharded() -> bool;
+
+    static auto regionPath(std::string outputPath, uint64_t region) -> std::string;
+    /* Created if it does not exist */
+
+    static auto record(uint64_t region, TID tid, std::string path,
+                       EID firstEvent, EID endEvent, const Addr *barrier) -> void;
+    /* 'barrier' is null for a thread's last region. Thread safe */
+
+    static auto close() -> void;
+    /* After every region is recorded */
+};
+
+}; //end namespace STGen
+
+#endif
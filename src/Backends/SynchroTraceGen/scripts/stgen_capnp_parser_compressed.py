@@ -28,7 +28,7 @@ def processSTEventTrace(file):
                     # the thread-event tuple that generated
                     # this communication edge
                     edge.producerThread
-                    edge.producerEvent
+                    edge.producerEvent | edge.producerEventHi << 32
                     for addr in edge.addrs:
                         addr.start  # start of address range
                         addr.end    # end of address range
@@ -60,6 +60,13 @@ def processSTEventTrace(file):
             elif which == 'marker':
                 # the number of instructions since the last marker
                 event.marker.count
+            elif which == 'repeat':
+                # the next 'events' comp events each copy the comp event
+                # 'period' events before it, with every address range
+                # moved by 'stride' bytes
+                event.repeat.events
+                event.repeat.period
+                event.repeat.stride
 
 if __name__ == '__main__':
     filepath = sys.argv[1]
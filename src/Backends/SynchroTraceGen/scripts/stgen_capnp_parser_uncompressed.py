@@ -24,7 +24,7 @@ def processSTEventTrace(file):
             elif which == 'comm':
                 # communication edge
                 event.comm.producerThread
-                event.comm.producerEvent
+                event.comm.producerEvent | event.comm.producerEventHi << 32
                 event.comm.startAddr
                 event.comm.endAddr
             elif which == 'sync':
@@ -0,0 +1,63 @@
+#!/bin/python
+
+import sys
+import os
+import gzip
+import struct
+
+# See RawTrace.hpp for the layout
+header = struct.Struct('=8sHHHHI12x')
+event = struct.Struct('=BBxxIIIQQ')
+COMP, COMM, SYNC, MARKER = range(4)
+NONE, READ, WRITE = range(3)
+
+
+def processSTEventTrace(file):
+    magic, version, headerBytes, eventBytes, byteOrder, tid = \
+        header.unpack(file.read(header.size))
+    if magic != b'STGENRAW' or byteOrder != 0x0102:
+        raise Exception('not a raw trace, or written with another byte order')
+    if eventBytes != event.size:
+        raise Exception('unexpected event size: ' + str(eventBytes))
+
+    eid = 0
+    while True:
+        chunk = file.read(event.size * 4096)
+        if not chunk:
+            break
+        for offset in range(0, len(chunk), event.size):
+            which, subtype, a, b, c, start, end = event.unpack_from(chunk, offset)
+            if which == COMP:
+                a  # iops
+                b  # flops
+                if subtype == READ or subtype == WRITE:
+                    # address range read or written
+                    start
+                    end
+            elif which == COMM:
+                # communication edge
+                a  # producer thread
+                b | c << 32  # producer event
+                start
+                end
+            elif which == SYNC:
+                subtype  # sync type, as in the text trace's pth_ty
+                start  # first sync argument, e.g. the mutex or barrier
+                if a > 1:
+                    end  # second sync argument, e.g. the mutex of a condWait
+            elif which == MARKER:
+                # the number of instructions since the last marker
+                a
+                continue
+            else:
+                raise Exception('unhandled event type')
+            eid += 1
+
+if __name__ == '__main__':
+    filepath = sys.argv[1]
+    name, ext = os.path.splitext(filepath)
+    if ext == '.gz':
+        f = gzip.open(filepath, 'rb')
+    else:
+        f = open(filepath, 'rb')
+    processSTEventTrace(f)
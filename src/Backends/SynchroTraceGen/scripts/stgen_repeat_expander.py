@@ -0,0 +1,56 @@
+#!/bin/python
+
+# Expands the repeat records in a SynchroTraceGen text trace,
+# generated with '-r', back into the compute events they stand for.
+
+import sys
+import gzip
+
+
+def hexAddr(addr):
+    # formatted as in TextWriter::hex, with zero at full width
+    return '0x%016x' % addr if addr == 0 else '0x%x' % addr
+
+
+def shift(line, stride):
+    # move every address range in a comp event line by 'stride' bytes
+    fields = line.split(' ')
+    out = [fields[0]]
+    i = 1
+    while i < len(fields):
+        out.append(fields[i])  # '$' or '*'
+        out.append(hexAddr((int(fields[i+1], 16) + stride) % 2**64))
+        out.append(hexAddr((int(fields[i+2], 16) + stride) % 2**64))
+        i += 3
+    return ' '.join(out)
+
+
+def expand(lines, out):
+    comps = []  # comp events since the last comm or sync event
+    for line in lines:
+        line = line.rstrip('\n')
+        if line.startswith('!'):
+            out.write(line + '\n')
+            continue
+
+        if ' # ' in line or ',pth_ty:' in line:
+            out.write(line + '\n')
+            comps = []
+        elif ',rep:' in line:
+            eid, tid, rep = line.split(',')
+            events, period, stride = (int(x) for x in rep[4:].split('^'))
+            for i in range(events):
+                counts = comps[-period].split(',', 2)[2]
+                comp = shift('%d,%s,%s' % (int(eid) + i, tid, counts), stride)
+                out.write(comp + '\n')
+                comps.append(comp)
+        else:
+            out.write(line + '\n')
+            comps.append(line)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: stgen_repeat_expander.py TRACE.gz EXPANDED.gz')
+    with gzip.open(sys.argv[1], 'rt') as lines, gzip.open(sys.argv[2], 'wt') as out:
+        expand(lines, out)
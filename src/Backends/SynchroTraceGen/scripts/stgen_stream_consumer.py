@@ -0,0 +1,67 @@
+#!/bin/python
+
+import sys
+import os
+import socket
+import struct
+import threading
+
+# See TraceOutput.hpp for the stream layout
+header = struct.Struct('=8sHH4x')
+
+
+def readAll(conn, size):
+    data = b''
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise Exception('stream closed early')
+        data += chunk
+    return data
+
+
+def processStream(conn, outputPath):
+    magic, version, nameBytes = header.unpack(readAll(conn, header.size))
+    if magic != b'STGENSTR':
+        raise Exception('not a SynchroTraceGen trace stream')
+    name = readAll(conn, nameBytes).decode()
+
+    # the name comes off the socket, so keep it inside the output directory
+    name = os.path.basename(name)
+    if name == '' or name.startswith('.'):
+        conn.close()
+        raise Exception('bad trace stream name: ' + repr(name))
+
+    # A simulator would decode events here, as they arrive.
+    # This consumer saves each trace, or just counts its bytes.
+    out = open(os.path.join(outputPath, name), 'wb') if outputPath else None
+    total = 0
+    while True:
+        chunk = conn.recv(1 << 20)
+        if not chunk:
+            break
+        total += len(chunk)
+        if out:
+            out.write(chunk)
+    if out:
+        out.close()
+    conn.close()
+    print(name + ': ' + str(total) + ' bytes')
+
+
+if __name__ == '__main__':
+    socketPath = sys.argv[1]
+    outputPath = sys.argv[2] if len(sys.argv) > 2 else None
+
+    if os.path.exists(socketPath):
+        os.unlink(socketPath)
+    server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    server.bind(socketPath)
+    server.listen(128)
+
+    # one connection per thread's trace, until interrupted
+    while True:
+        conn, _ = server.accept()
+        t = threading.Thread(target=processStream, args=(conn, outputPath))
+        t.daemon = True
+        t.start()
@@ -0,0 +1,133 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <set>
+
+#include "SynchroTraceGen/AddrSet.hpp"
+
+using STGen::AddrSet;
+using AddrRange = AddrSet::AddrRange;
+
+std::vector<AddrRange> ranges(const AddrSet &set)
+{
+    return std::vector<AddrRange>(set.get().begin(), set.get().end());
+}
+
+TEST_CASE("address ranges are merged", "[AddrSetMerge]")
+{
+    SECTION("ascending contiguous ranges collapse into one")
+    {
+        AddrSet set;
+        for (Addr addr = 0x1000; addr < 0x1100; addr += 4)
+            set.insert(std::make_pair(addr, addr + 3));
+        REQUIRE(ranges(set) == std::vector<AddrRange>{{0x1000, 0x10ff}});
+    }
+
+    SECTION("disjoint ranges stay sorted")
+    {
+        AddrSet set;
+        set.insert(std::make_pair(50, 59));
+        set.insert(std::make_pair(10, 19));
+        set.insert(std::make_pair(30, 39));
+        REQUIRE(ranges(set) == (std::vector<AddrRange>{{10, 19}, {30, 39}, {50, 59}}));
+    }
+
+    SECTION("a range touching both neighbours joins them")
+    {
+        AddrSet set;
+        set.insert(std::make_pair(10, 19));
+        set.insert(std::make_pair(30, 39));
+        set.insert(std::make_pair(20, 29));
+        REQUIRE(ranges(set) == std::vector<AddrRange>{{10, 39}});
+    }
+
+    SECTION("a range spanning many ranges swallows them")
+    {
+        AddrSet set;
+        for (Addr addr = 100; addr < 200; addr += 10)
+            set.insert(std::make_pair(addr, addr + 1));
+        REQUIRE(set.get().size() == 10);
+
+        set.insert(std::make_pair(95, 150));
+        REQUIRE(ranges(set) == (std::vector<AddrRange>{{95, 151}, {160, 161}, {170, 171},
+                                                         {180, 181}, {190, 191}}));
+    }
+
+    SECTION("contained ranges change nothing")
+    {
+        AddrSet set;
+        set.insert(std::make_pair(0, 100));
+        set.insert(std::make_pair(200, 300));
+        set.insert(std::make_pair(10, 20));
+        set.insert(std::make_pair(0, 0));
+        REQUIRE(ranges(set) == (std::vector<AddrRange>{{0, 100}, {200, 300}}));
+    }
+
+    SECTION("ranges at the top of the address space")
+    {
+        constexpr Addr max = std::numeric_limits<Addr>::max();
+        AddrSet set;
+        set.insert(std::make_pair(max - 1, max));
+        set.insert(std::make_pair(max - 3, max - 2));
+        set.insert(std::make_pair(max, max));
+        REQUIRE(ranges(set) == std::vector<AddrRange>{{max - 3, max}});
+    }
+
+    SECTION("copies are independent")
+    {
+        AddrSet set;
+        for (Addr addr = 0; addr < 100; addr += 2)
+            set.insert(std::make_pair(addr, addr));
+        AddrSet copy(set);
+        set.clear();
+        REQUIRE(set.get().empty());
+        REQUIRE(copy.get().size() == 50);
+    }
+}
+
+TEST_CASE("address ranges match a byte-wise reference", "[AddrSetRandom]")
+{
+    srand(time(NULL));
+
+    SECTION("random inserts")
+    {
+        AddrSet set;
+        std::set<Addr> bytes;
+        for (int i = 0; i < 2000; ++i)
+        {
+            Addr begin = rand() % 65536;
+            Addr end = begin + rand() % 8;
+            set.insert(std::make_pair(begin, end));
+            for (Addr addr = begin; addr <= end; ++addr)
+                bytes.insert(addr);
+        }
+
+        std::set<Addr> fromSet;
+        Addr prevEnd = 0;
+        bool first = true;
+        for (auto &p : set.get())
+        {
+            REQUIRE(p.first <= p.second);
+            if (first == false)
+                REQUIRE(p.first > prevEnd + 1);
+            first = false;
+            prevEnd = p.second;
+            for (Addr addr = p.first; addr <= p.second; ++addr)
+                fromSet.insert(addr);
+        }
+        REQUIRE(fromSet == bytes);
+    }
+
+    SECTION("pathological descending inserts")
+    {
+        AddrSet set;
+        for (Addr addr = 40000; addr > 0; addr -= 2)
+            set.insert(std::make_pair(addr, addr));
+        REQUIRE(set.get().size() == 20000);
+
+        set.insert(std::make_pair(0, 40000));
+        REQUIRE(ranges(set) == std::vector<AddrRange>{{0, 40000}});
+    }
+}
@@ -1,6 +1,9 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <stdlib.h>
+#include <time.h>
+
 #include "SynchroTraceGen/BarrierMerge.hpp"
 
 using namespace STGen;
@@ -14,6 +17,60 @@ bool equal(const BarrierStats &l, const BarrierStats &r)
             l.locks == r.locks);
 }
 
+bool equal(const AllBarriersStats &l, const AllBarriersStats &r)
+{
+    if (l.size() != r.size())
+        return false;
+    for (auto lit = l.begin(), rit = r.begin(); lit != l.end(); ++lit, ++rit)
+        if (lit->first != rit->first || equal(lit->second, rit->second) == false)
+            return false;
+    return true;
+}
+
+void referenceMerge(const AllBarriersStats &from, AllBarriersStats &to)
+{
+    /* the straightforward quadratic merge: for each barrier in 'from',
+     * scan 'to' from just after the last match */
+    if (from.empty())
+        return;
+    if (to.empty())
+    {
+        to = from;
+        return;
+    }
+
+    auto current = to.begin();
+    auto previous = to.end();
+    auto begin = from.begin();
+    for (auto it = from.begin(); it != from.end(); ++it)
+    {
+        auto match = current;
+        while (match != to.end() && match->first != it->first)
+            ++match;
+        if (match == to.end())
+            continue;
+
+        match->second += it->second;
+        to.insert(match, begin, it);
+        current = previous = std::next(match);
+        begin = std::next(it);
+    }
+    to.insert(previous, begin, from.end());
+}
+
+AllBarriersStats randomBarriers(size_t count, Addr barriers)
+{
+    AllBarriersStats ret;
+    for (size_t i = 0; i < count; ++i)
+    {
+        BarrierStats stats;
+        stats.iops = rand() % 100;
+        stats.instrs = rand() % 100;
+        ret.push_back(std::make_pair(rand() % barriers, stats));
+    }
+    return ret;
+}
+
 TEST_CASE("merge empty barriers", "[EmptyBarriers]")
 {
     SECTION("two empty barriers")
@@ -303,3 +360,67 @@ TEST_CASE("more complex cases", "[ComplexBarriers]")
         REQUIRE(it == merged.end());
     }
 }
+
+
+TEST_CASE("merge long barrier sequences", "[LongBarriers]")
+{
+    srand(time(NULL));
+
+    SECTION("matches the straightforward merge")
+    {
+        for (int trial = 0; trial < 50; ++trial)
+        {
+            AllBarriersStats merged;
+            AllBarriersStats reference;
+            int threads = 1 + rand() % 8;
+            for (int t = 0; t < threads; ++t)
+            {
+                auto barriers = randomBarriers(rand() % 2000, 1 + rand() % 10);
+                BarrierMerge::merge(barriers, merged);
+                referenceMerge(barriers, reference);
+            }
+            REQUIRE(equal(merged, reference));
+        }
+    }
+
+    SECTION("millions of barriers merge without recursion")
+    {
+        /* every thread reaches the same barriers, in the same order */
+        constexpr size_t count = 2000000;
+        AllBarriersStats barriers;
+        BarrierStats stats;
+        stats.iops = 1;
+        for (size_t i = 0; i < count; ++i)
+            barriers.push_back(std::make_pair(i % 3, stats));
+
+        AllBarriersStats merged;
+        for (int t = 0; t < 4; ++t)
+            BarrierMerge::merge(barriers, merged);
+
+        REQUIRE(merged.size() == count);
+        bool allMerged = true;
+        for (auto &p : merged)
+            allMerged &= (p.second.iops == 4);
+        REQUIRE(allMerged);
+    }
+
+    SECTION("millions of barriers with no matches are appended")
+    {
+        constexpr size_t count = 1000000;
+        AllBarriersStats evens;
+        AllBarriersStats odds;
+        BarrierStats stats;
+        for (size_t i = 0; i < count; ++i)
+        {
+            evens.push_back(std::make_pair(2*(i % 1000), stats));
+            odds.push_back(std::make_pair(2*(i % 1000) + 1, stats));
+        }
+
+        AllBarriersStats merged;
+        BarrierMerge::merge(evens, merged);
+        BarrierMerge::merge(odds, merged);
+        REQUIRE(merged.size() == 2*count);
+        REQUIRE(merged.front().first == 0);
+        REQUIRE(merged.back().first == 2*999 + 1);
+    }
+}
@@ -0,0 +1,421 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <zlib.h>
+
+#include "SynchroTraceGen/CapnLogger.hpp"
+#include <kj/io.h>
+
+using STGen::CapnLoggerCompressed;
+using STGen::CapnLoggerUncompressed;
+using STGen::STCompEventCompressed;
+using STGen::STCommEventCompressed;
+using STGen::capnpEventsPerChunk;
+using STGen::TID;
+using STGen::EID;
+using AddrRange = STGen::AddrSet::AddrRange;
+
+namespace
+{
+
+struct Logged
+{
+    /* an event as it was handed to the logger */
+    enum Kind { COMP, COMM, SYNC, MARKER, REPEAT } kind;
+    unsigned iops, flops, reads, writes;
+    std::vector<AddrRange> writeAddrs, readAddrs;
+    std::vector<std::tuple<TID, EID, std::vector<AddrRange>>> edges;
+    unsigned char syncType;
+    std::vector<Addr> syncArgs;
+    int count;
+    int64_t stride;
+    unsigned events, period;
+    /* uncompressed events only */
+    STGen::STCompEventUncompressed::MemType mem;
+    Addr start, end;
+};
+
+auto tempDir() -> std::string
+{
+    char path[] = "./sigil.capn.test.XXXXXX";
+    REQUIRE(mkdtemp(path) != NULL);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    std::string data;
+    gzFile fz = gzopen(path.c_str(), "rb");
+    REQUIRE(fz != NULL);
+    char buf[1 << 16];
+    int bytes;
+    while ((bytes = gzread(fz, buf, sizeof(buf))) > 0)
+        data.append(buf, bytes);
+    REQUIRE(bytes == 0);
+    gzclose(fz);
+    unlink(path.c_str());
+    unlink((path + ".idx").c_str());
+    return data;
+}
+
+template <typename EventStream, typename Check>
+auto readMessages(const std::string &path, Check check) -> std::vector<unsigned>
+{
+    /* Reads back-to-back packed messages, and checks each event in order.
+     * Returns the number of events in each message */
+    auto data = readBack(path);
+    kj::ArrayInputStream input(kj::arrayPtr(reinterpret_cast<const kj::byte*>(data.data()),
+                                            data.size()));
+    std::vector<unsigned> chunks;
+    size_t idx = 0;
+    while (input.tryGetReadBuffer().size() > 0)
+    {
+        ::capnp::PackedMessageReader message(input);
+        auto events = message.getRoot<EventStream>().getEvents();
+        chunks.push_back(events.size());
+        for (auto ev : events)
+            check(ev, idx++);
+    }
+    return chunks;
+}
+
+auto randomAddr() -> Addr
+{
+    return (static_cast<Addr>(rand()) << 16) | (rand() & 0xffff);
+}
+
+auto randomEID() -> EID
+{
+    /* past 32 bits, to exercise the high bits of producer events */
+    return (static_cast<EID>(rand() & 0xffff) << 32) | static_cast<uint32_t>(rand());
+}
+
+auto randomSync(Logged &log) -> void
+{
+    log.kind = Logged::SYNC;
+    log.syncType = rand() % 10 + 1;
+    log.syncArgs.push_back(randomAddr());
+    if (log.syncType == 6)
+        log.syncArgs.push_back(randomAddr());
+}
+
+auto expectedSyncType(unsigned char syncType) -> unsigned
+{
+    /* the capnp enum is ordered differently than the Sigil2 sync types */
+    using SyncType = EventStreamCompressed::Event::SyncType;
+    static const SyncType types[] = {SyncType::LOCK, SyncType::UNLOCK,
+                                     SyncType::SPAWN, SyncType::JOIN, SyncType::BARRIER,
+                                     SyncType::COND_WAIT, SyncType::COND_SIGNAL,
+                                     SyncType::COND_BROADCAST, SyncType::SPIN_LOCK,
+                                     SyncType::SPIN_UNLOCK};
+    return static_cast<unsigned>(types[syncType - 1]);
+}
+
+template <typename Ranges>
+auto checkRanges(Ranges ranges, const std::vector<AddrRange> &expected) -> void
+{
+    REQUIRE(ranges.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        REQUIRE(ranges[i].getStart() == expected[i].first);
+        REQUIRE(ranges[i].getEnd() == expected[i].second);
+    }
+}
+
+auto logCompressed(CapnLoggerCompressed &logger, EID eid) -> Logged
+{
+    Logged log{};
+    switch (rand() % 5)
+    {
+    case 0:
+    {
+        STCompEventCompressed ev;
+        ev.iops = rand() % 1000;
+        ev.flops = rand() % 1000;
+        ev.reads = rand() % 1000;
+        ev.writes = rand() % 1000;
+        for (int i = rand() % 4; i > 0; --i)
+            ev.updateWrites(randomAddr(), rand() % 64 + 1);
+        for (int i = rand() % 4; i > 0; --i)
+            ev.updateReads(randomAddr(), rand() % 64 + 1);
+        log.kind = Logged::COMP;
+        log.iops = ev.iops;
+        log.flops = ev.flops;
+        log.reads = ev.reads;
+        log.writes = ev.writes;
+        log.writeAddrs.assign(ev.uniqueWriteAddrs.get().begin(), ev.uniqueWriteAddrs.get().end());
+        log.readAddrs.assign(ev.uniqueReadAddrs.get().begin(), ev.uniqueReadAddrs.get().end());
+        logger.flush(ev, eid, 1);
+        break;
+    }
+    case 1:
+    {
+        STCommEventCompressed ev;
+        for (int i = rand() % 3 + 1; i > 0; --i)
+        {
+            auto start = randomAddr();
+            ev.addEdge(rand() % 64 + 1, randomEID(), start, start + rand() % 64);
+        }
+        log.kind = Logged::COMM;
+        for (auto &edge : ev.comms)
+        {
+            auto &ranges = std::get<2>(edge).get();
+            log.edges.emplace_back(std::get<0>(edge), std::get<1>(edge),
+                                   std::vector<AddrRange>(ranges.begin(), ranges.end()));
+        }
+        logger.flush(ev, eid, 1);
+        break;
+    }
+    case 2:
+        randomSync(log);
+        logger.flush(log.syncType, log.syncArgs.size(), log.syncArgs.data(), eid, 1);
+        break;
+    case 3:
+        log.kind = Logged::MARKER;
+        log.count = rand() % 1000 + 1;
+        logger.instrMarker(log.count);
+        break;
+    case 4:
+        log.kind = Logged::REPEAT;
+        log.events = rand() % 100 + 1;
+        log.period = rand() % 8 + 1;
+        log.stride = static_cast<int64_t>(randomAddr()) - static_cast<int64_t>(randomAddr());
+        logger.repeat(log.events, log.period, log.stride, eid, 1);
+        break;
+    }
+    return log;
+}
+
+auto checkCompressed(EventStreamCompressed::Event::Reader ev, const Logged &log) -> void
+{
+    using Event = EventStreamCompressed::Event;
+    switch (log.kind)
+    {
+    case Logged::COMP:
+    {
+        REQUIRE(ev.which() == Event::COMP);
+        auto comp = ev.getComp();
+        REQUIRE(comp.getIops() == log.iops);
+        REQUIRE(comp.getFlops() == log.flops);
+        REQUIRE(comp.getReads() == log.reads);
+        REQUIRE(comp.getWrites() == log.writes);
+        checkRanges(comp.getWriteAddrs(), log.writeAddrs);
+        checkRanges(comp.getReadAddrs(), log.readAddrs);
+        break;
+    }
+    case Logged::COMM:
+    {
+        REQUIRE(ev.which() == Event::COMM);
+        auto edges = ev.getComm().getEdges();
+        REQUIRE(edges.size() == log.edges.size());
+        for (size_t i = 0; i < log.edges.size(); ++i)
+        {
+            auto producer = (static_cast<EID>(edges[i].getProducerEventHi()) << 32 |
+                             edges[i].getProducerEvent());
+            REQUIRE(edges[i].getProducerThread() == std::get<0>(log.edges[i]));
+            REQUIRE(producer == std::get<1>(log.edges[i]));
+            checkRanges(edges[i].getAddrs(), std::get<2>(log.edges[i]));
+        }
+        break;
+    }
+    case Logged::SYNC:
+    {
+        REQUIRE(ev.which() == Event::SYNC);
+        auto sync = ev.getSync();
+        REQUIRE(static_cast<unsigned>(sync.getType()) == expectedSyncType(log.syncType));
+        auto args = sync.getArgs();
+        REQUIRE(args.size() == log.syncArgs.size());
+        for (size_t i = 0; i < log.syncArgs.size(); ++i)
+            REQUIRE(args[i] == log.syncArgs[i]);
+        break;
+    }
+    case Logged::MARKER:
+        REQUIRE(ev.which() == Event::MARKER);
+        REQUIRE(ev.getMarker().getCount() == log.count);
+        break;
+    case Logged::REPEAT:
+    {
+        REQUIRE(ev.which() == Event::REPEAT);
+        auto rep = ev.getRepeat();
+        REQUIRE(rep.getEvents() == log.events);
+        REQUIRE(rep.getPeriod() == log.period);
+        REQUIRE(rep.getStride() == log.stride);
+        break;
+    }
+    }
+}
+
+auto logUncompressed(CapnLoggerUncompressed &logger, EID eid) -> Logged
+{
+    using MemType = STGen::STCompEventUncompressed::MemType;
+    Logged log{};
+    switch (rand() % 4)
+    {
+    case 0:
+    {
+        static const MemType types[] = {MemType::NONE, MemType::READ, MemType::WRITE};
+        log.kind = Logged::COMP;
+        log.iops = rand() % 1000;
+        log.flops = rand() % 1000;
+        log.mem = types[rand() % 3];
+        log.start = randomAddr();
+        log.end = log.start + rand() % 64;
+        logger.flush(log.iops, log.flops, log.mem, log.start, log.end, eid, 1);
+        break;
+    }
+    case 1:
+        log.kind = Logged::COMM;
+        log.edges.emplace_back(rand() % 64 + 1, randomEID(), std::vector<AddrRange>{});
+        log.start = randomAddr();
+        log.end = log.start + rand() % 64;
+        logger.flush(std::get<1>(log.edges[0]), std::get<0>(log.edges[0]),
+                     log.start, log.end, eid, 1);
+        break;
+    case 2:
+        randomSync(log);
+        logger.flush(log.syncType, log.syncArgs.size(), log.syncArgs.data(), eid, 1);
+        break;
+    case 3:
+        log.kind = Logged::MARKER;
+        log.count = rand() % 1000 + 1;
+        logger.instrMarker(log.count);
+        break;
+    }
+    return log;
+}
+
+auto checkUncompressed(EventStreamUncompressed::Event::Reader ev, const Logged &log) -> void
+{
+    using Event = EventStreamUncompressed::Event;
+    switch (log.kind)
+    {
+    case Logged::COMP:
+    {
+        REQUIRE(ev.which() == Event::COMP);
+        auto comp = ev.getComp();
+        REQUIRE(comp.getIops() == log.iops);
+        REQUIRE(comp.getFlops() == log.flops);
+        REQUIRE(static_cast<unsigned>(comp.getMem()) == static_cast<unsigned>(log.mem));
+        REQUIRE(comp.getStartAddr() == log.start);
+        REQUIRE(comp.getEndAddr() == log.end);
+        break;
+    }
+    case Logged::COMM:
+    {
+        REQUIRE(ev.which() == Event::COMM);
+        auto comm = ev.getComm();
+        auto producer = (static_cast<EID>(comm.getProducerEventHi()) << 32 |
+                         comm.getProducerEvent());
+        REQUIRE(comm.getProducerThread() == std::get<0>(log.edges[0]));
+        REQUIRE(producer == std::get<1>(log.edges[0]));
+        REQUIRE(comm.getStartAddr() == log.start);
+        REQUIRE(comm.getEndAddr() == log.end);
+        break;
+    }
+    case Logged::SYNC:
+    {
+        REQUIRE(ev.which() == Event::SYNC);
+        auto sync = ev.getSync();
+        REQUIRE(static_cast<unsigned>(sync.getType()) == expectedSyncType(log.syncType));
+        auto args = sync.getArgs();
+        REQUIRE(args.size() == log.syncArgs.size());
+        for (size_t i = 0; i < log.syncArgs.size(); ++i)
+            REQUIRE(args[i] == log.syncArgs[i]);
+        break;
+    }
+    default:
+        REQUIRE(ev.which() == Event::MARKER);
+        REQUIRE(ev.getMarker().getCount() == log.count);
+        break;
+    }
+}
+
+template <typename Logger, typename EventStream, typename Log, typename Check>
+auto roundTrip(size_t numEvents, const std::string &suffix, Log logEvent, Check check)
+    -> std::vector<unsigned>
+{
+    auto dir = tempDir();
+    std::vector<Logged> logged;
+    {
+        Logger logger(1, dir);
+        for (EID eid = 0; eid < numEvents; ++eid)
+            logged.push_back(logEvent(logger, eid));
+    }
+    /* the last chunk is written when the logger is destroyed */
+
+    auto chunks = readMessages<EventStream>(dir + "/sigil.events.out-1." + suffix,
+                                            [&](typename EventStream::Event::Reader ev, size_t idx)
+    {
+        REQUIRE(idx < logged.size());
+        check(ev, logged[idx]);
+    });
+    rmdir(dir.c_str());
+
+    size_t total = 0;
+    for (auto events : chunks)
+        total += events;
+    REQUIRE(total == numEvents);
+    return chunks;
+}
+
+}; //end namespace
+
+
+TEST_CASE("compressed capnp events read back", "[CapnLoggerCompressed]")
+{
+    srand(time(NULL));
+    auto compressed = [](size_t numEvents)
+    {
+        return roundTrip<CapnLoggerCompressed, EventStreamCompressed>(
+            numEvents, "compressed.capn.bin.gz", logCompressed, checkCompressed);
+    };
+
+    SECTION("a partial chunk is cut short")
+    {
+        REQUIRE(compressed(1000) == std::vector<unsigned>{1000});
+    }
+
+    SECTION("a full chunk is written whole")
+    {
+        REQUIRE(compressed(capnpEventsPerChunk) == std::vector<unsigned>{capnpEventsPerChunk});
+    }
+
+    SECTION("events span several chunks")
+    {
+        REQUIRE(compressed(2*capnpEventsPerChunk + 123) ==
+                (std::vector<unsigned>{capnpEventsPerChunk, capnpEventsPerChunk, 123}));
+    }
+
+    SECTION("an empty trace has no messages")
+    {
+        REQUIRE(compressed(0).empty() == true);
+    }
+}
+
+
+TEST_CASE("uncompressed capnp events read back", "[CapnLoggerUncompressed]")
+{
+    srand(time(NULL));
+    auto uncompressed = [](size_t numEvents)
+    {
+        return roundTrip<CapnLoggerUncompressed, EventStreamUncompressed>(
+            numEvents, "uncompressed.capn.bin.gz", logUncompressed, checkUncompressed);
+    };
+
+    SECTION("a partial chunk is cut short")
+    {
+        REQUIRE(uncompressed(1000) == std::vector<unsigned>{1000});
+    }
+
+    SECTION("events span several chunks")
+    {
+        REQUIRE(uncompressed(capnpEventsPerChunk + 1) ==
+                (std::vector<unsigned>{capnpEventsPerChunk, 1}));
+    }
+}
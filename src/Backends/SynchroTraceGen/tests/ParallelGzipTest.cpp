@@ -0,0 +1,121 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <thread>
+#include <string>
+#include <zlib.h>
+
+#include "SynchroTraceGen/ParallelGzip.hpp"
+
+using STGen::GzipWriter;
+
+namespace
+{
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.gzip.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    std::string data;
+    gzFile fz = gzopen(path.c_str(), "rb");
+    REQUIRE(fz != NULL);
+    char buf[4096];
+    int bytes;
+    while ((bytes = gzread(fz, buf, sizeof(buf))) > 0)
+        data.append(buf, bytes);
+    REQUIRE(bytes == 0);
+    gzclose(fz);
+    unlink(path.c_str());
+    return data;
+}
+
+auto randomText(size_t bytes) -> std::string
+{
+    /* compressible, but not trivially */
+    std::string text;
+    while (text.size() < bytes)
+        text += std::to_string(rand() % 100000) + ",";
+    text.resize(bytes);
+    return text;
+}
+
+}; //end namespace
+
+
+TEST_CASE("gzip blocks are deflated in parallel", "[ParallelGzip]")
+{
+    srand(time(NULL));
+
+    /* small blocks, so each file spans many gzip members */
+    static bool configured = false;
+    if (configured == false)
+    {
+        GzipWriter::configure(3, GzipWriter::minBlockSize);
+        configured = true;
+    }
+
+    SECTION("output is a readable gzip file")
+    {
+        auto path = tempPath();
+        std::string text = randomText(1 << 20);
+        {
+            GzipWriter gz(path);
+            size_t pos = 0;
+            while (pos < text.size())
+            {
+                /* odd sized writes that straddle block boundaries */
+                size_t bytes = std::min<size_t>(rand() % 10000, text.size() - pos);
+                gz.write(text.data() + pos, bytes);
+                pos += bytes;
+            }
+        }
+        REQUIRE(readBack(path) == text);
+    }
+
+    SECTION("empty output is a valid gzip file")
+    {
+        auto path = tempPath();
+        {
+            GzipWriter gz(path);
+        }
+        REQUIRE(readBack(path).empty());
+    }
+
+    SECTION("writers on many threads share the workers")
+    {
+        constexpr int writers = 8;
+        std::vector<std::string> paths;
+        std::vector<std::string> texts;
+        for (int i = 0; i < writers; ++i)
+        {
+            paths.push_back(tempPath());
+            texts.push_back(randomText(100000 + i*12345));
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < writers; ++i)
+        {
+            threads.emplace_back([&, i]
+            {
+                GzipWriter gz(paths[i]);
+                for (size_t pos = 0; pos < texts[i].size(); pos += 1000)
+                    gz.write(texts[i].data() + pos, std::min<size_t>(1000, texts[i].size() - pos));
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+
+        for (int i = 0; i < writers; ++i)
+            REQUIRE(readBack(paths[i]) == texts[i]);
+    }
+}
@@ -0,0 +1,127 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "SynchroTraceGen/RawTrace.hpp"
+
+using STGen::RawWriter;
+using STGen::RawHeader;
+using STGen::RawEvent;
+
+namespace
+{
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.raw.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    /* gzread passes uncompressed files through as-is */
+    std::string data;
+    gzFile fz = gzopen(path.c_str(), "rb");
+    REQUIRE(fz != NULL);
+    char buf[1 << 16];
+    int bytes;
+    while ((bytes = gzread(fz, buf, sizeof(buf))) > 0)
+        data.append(buf, bytes);
+    REQUIRE(bytes == 0);
+    gzclose(fz);
+    unlink(path.c_str());
+    return data;
+}
+
+auto randomEvent() -> RawEvent
+{
+    RawEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = rand() % 4;
+    ev.subtype = rand() % 11;
+    ev.a = rand();
+    ev.b = rand();
+    ev.c = rand() % (1 << 16);
+    ev.start = (static_cast<uint64_t>(rand()) << 32) | rand();
+    ev.end = ev.start + rand() % 64;
+    return ev;
+}
+
+auto checkTrace(const std::string &data, const std::vector<RawEvent> &events) -> void
+{
+    REQUIRE(data.size() == sizeof(RawHeader) + events.size()*sizeof(RawEvent));
+
+    RawHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    REQUIRE(std::string(header.magic, sizeof(header.magic)) == "STGENRAW");
+    REQUIRE(header.version == STGen::rawTraceVersion);
+    REQUIRE(header.headerBytes == sizeof(RawHeader));
+    REQUIRE(header.eventBytes == sizeof(RawEvent));
+    REQUIRE(header.byteOrder == 0x0102);
+    REQUIRE(header.tid == 7);
+
+    /* compare whole events, but only report the first mismatch */
+    const char *raw = data.data() + sizeof(RawHeader);
+    size_t mismatch = events.size();
+    for (size_t i = 0; i < events.size() && mismatch == events.size(); ++i)
+        if (memcmp(raw + i*sizeof(RawEvent), &events[i], sizeof(RawEvent)) != 0)
+            mismatch = i;
+    REQUIRE(mismatch == events.size());
+}
+
+}; //end namespace
+
+
+TEST_CASE("raw traces hold a header and fixed-width events", "[RawTrace]")
+{
+    srand(time(NULL));
+
+    SECTION("empty trace is just the header")
+    {
+        auto path = tempPath();
+        {
+            RawWriter out(path, 7, false);
+        }
+        checkTrace(readBack(path), {});
+    }
+
+    SECTION("mapped trace spans multiple windows")
+    {
+        std::vector<RawEvent> events;
+        for (size_t i = 0; i < RawWriter::windowBytes/sizeof(RawEvent) + 1000; ++i)
+            events.push_back(randomEvent());
+
+        auto path = tempPath();
+        {
+            RawWriter out(path, 7, false);
+            for (auto &ev : events)
+                out.put(ev);
+        }
+        checkTrace(readBack(path), events);
+    }
+
+    SECTION("gzipped trace spans multiple buffers")
+    {
+        std::vector<RawEvent> events;
+        for (size_t i = 0; i < 3*RawWriter::bufferBytes/sizeof(RawEvent) + 1000; ++i)
+            events.push_back(randomEvent());
+
+        auto path = tempPath();
+        {
+            RawWriter out(path, 7, true);
+            for (auto &ev : events)
+                out.put(ev);
+        }
+        checkTrace(readBack(path), events);
+    }
+}
@@ -0,0 +1,440 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "SynchroTraceGen/RepeatLogger.hpp"
+#include "SynchroTraceGen/TextLogger.hpp"
+
+using STGen::STCompEventCompressed;
+using STGen::STCommEventCompressed;
+using STGen::STLoggerCompressed;
+using STGen::RepeatLoggerCompressed;
+using STGen::TextLoggerCompressed;
+using STGen::TID;
+using STGen::EID;
+using AddrRange = STGen::AddrSet::AddrRange;
+
+namespace
+{
+
+struct Event
+{
+    /* a flattened trace event, for comparing traces */
+    enum Kind { COMP, COMM, SYNC, MARKER } kind;
+    EID eid;
+    STGen::StatCounter iops, flops, reads, writes;
+    std::vector<AddrRange> writeAddrs, readAddrs;
+
+    bool operator==(const Event &other) const
+    {
+        return (kind == other.kind && eid == other.eid &&
+                iops == other.iops && flops == other.flops &&
+                reads == other.reads && writes == other.writes &&
+                writeAddrs == other.writeAddrs && readAddrs == other.readAddrs);
+    }
+};
+
+struct Record
+{
+    Event ev;
+    unsigned repeatEvents, period;
+    int64_t stride;
+    /* a repeat record if 'repeatEvents' is non-zero */
+};
+
+class RecordingLogger : public STLoggerCompressed
+{
+  public:
+    RecordingLogger(std::vector<Record> &records) : records(records) {}
+
+    auto flush(const STCompEventCompressed& ev, EID eid, TID tid) -> void override final
+    {
+        (void)tid;
+        Event flat{Event::COMP, eid, ev.iops, ev.flops, ev.reads, ev.writes,
+                   {ev.uniqueWriteAddrs.get().begin(), ev.uniqueWriteAddrs.get().end()},
+                   {ev.uniqueReadAddrs.get().begin(), ev.uniqueReadAddrs.get().end()}};
+        records.push_back(Record{flat, 0, 0, 0});
+    }
+
+    auto flush(const STCommEventCompressed& ev, EID eid, TID tid) -> void override final
+    {
+        (void)ev;
+        (void)tid;
+        records.push_back(Record{Event{Event::COMM, eid, 0, 0, 0, 0, {}, {}}, 0, 0, 0});
+    }
+
+    auto flush(unsigned char syncType, unsigned numArgs, Addr *syncArgs,
+               EID eid, TID tid) -> void override final
+    {
+        (void)syncType;
+        (void)numArgs;
+        (void)syncArgs;
+        (void)tid;
+        records.push_back(Record{Event{Event::SYNC, eid, 0, 0, 0, 0, {}, {}}, 0, 0, 0});
+    }
+
+    auto instrMarker(int limit) -> void override final
+    {
+        records.push_back(Record{Event{Event::MARKER, 0, (unsigned)limit, 0, 0, 0, {}, {}}, 0, 0, 0});
+    }
+
+    auto repeat(unsigned events, unsigned period, int64_t stride,
+                EID eid, TID tid) -> void override final
+    {
+        (void)tid;
+        records.push_back(Record{Event{Event::COMP, eid, 0, 0, 0, 0, {}, {}}, events, period, stride});
+    }
+
+  private:
+    std::vector<Record> &records;
+};
+
+auto moved(const std::vector<AddrRange> &ranges, int64_t stride) -> std::vector<AddrRange>
+{
+    std::vector<AddrRange> ret;
+    for (auto &r : ranges)
+        ret.emplace_back(r.first + stride, r.second + stride);
+    return ret;
+}
+
+auto expand(const std::vector<Record> &records) -> std::vector<Event>
+{
+    /* what a trace reader does with repeat records */
+    std::vector<Event> events;
+    std::vector<Event> comps;
+    for (auto &rec : records)
+    {
+        if (rec.repeatEvents == 0)
+        {
+            events.push_back(rec.ev);
+            if (rec.ev.kind == Event::COMP)
+                comps.push_back(rec.ev);
+            else if (rec.ev.kind != Event::MARKER)
+                comps.clear();
+            continue;
+        }
+
+        REQUIRE(rec.period <= comps.size());
+        for (unsigned i=0; i<rec.repeatEvents; ++i)
+        {
+            Event ev = comps[comps.size() - rec.period];
+            ev.eid = rec.ev.eid + i;
+            ev.writeAddrs = moved(ev.writeAddrs, rec.stride);
+            ev.readAddrs = moved(ev.readAddrs, rec.stride);
+            events.push_back(ev);
+            comps.push_back(ev);
+        }
+    }
+    return events;
+}
+
+class Trace
+{
+    /* feeds events to a logger, and keeps them for comparison */
+  public:
+    Trace(STLoggerCompressed &logger) : logger(logger) {}
+
+    auto comp(unsigned iops, unsigned flops,
+              std::vector<AddrRange> writes, std::vector<AddrRange> reads) -> void
+    {
+        STCompEventCompressed ev;
+        ev.iops = iops;
+        ev.flops = flops;
+        for (auto &r : writes)
+        {
+            ev.updateWrites(r.first, r.second - r.first + 1);
+            ev.incWrites();
+        }
+        for (auto &r : reads)
+        {
+            ev.updateReads(r.first, r.second - r.first + 1);
+            ev.incReads();
+        }
+        logger.flush(ev, eid, 1);
+        events.push_back(Event{Event::COMP, eid++, iops, flops,
+                               (unsigned)reads.size(), (unsigned)writes.size(),
+                               {ev.uniqueWriteAddrs.get().begin(), ev.uniqueWriteAddrs.get().end()},
+                               {ev.uniqueReadAddrs.get().begin(), ev.uniqueReadAddrs.get().end()}});
+    }
+
+    auto comm() -> void
+    {
+        STCommEventCompressed ev;
+        logger.flush(ev, eid, 1);
+        events.push_back(Event{Event::COMM, eid++, 0, 0, 0, 0, {}, {}});
+    }
+
+    auto sync() -> void
+    {
+        Addr arg = 0x1000;
+        logger.flush(2, 1, &arg, eid, 1);
+        events.push_back(Event{Event::SYNC, eid++, 0, 0, 0, 0, {}, {}});
+    }
+
+    auto marker() -> void
+    {
+        logger.instrMarker(100);
+        events.push_back(Event{Event::MARKER, 0, 100, 0, 0, 0, {}, {}});
+    }
+
+    std::vector<Event> events;
+
+  private:
+    STLoggerCompressed &logger;
+    EID eid{0};
+};
+
+auto range(Addr start, Addr bytes) -> AddrRange
+{
+    return std::make_pair(start, start + bytes - 1);
+}
+
+template <typename F>
+auto fold(F generate) -> std::vector<Record>
+{
+    /* logs the generated trace, and checks it expands back exactly */
+    std::vector<Record> records;
+    std::vector<Event> input;
+    {
+        RepeatLoggerCompressed logger(std::make_unique<RecordingLogger>(records));
+        Trace trace(logger);
+        generate(trace);
+        input = trace.events;
+    }
+    /* the logger ends its last run when destroyed */
+
+    auto output = expand(records);
+    REQUIRE(output.size() == input.size());
+    REQUIRE(output == input);
+    return records;
+}
+
+auto repeats(const std::vector<Record> &records) -> size_t
+{
+    size_t ret = 0;
+    for (auto &rec : records)
+        ret += (rec.repeatEvents > 0);
+    return ret;
+}
+
+auto tempDir() -> std::string
+{
+    char path[] = "./sigil.repeat.test.XXXXXX";
+    REQUIRE(mkdtemp(path) != NULL);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    std::string data;
+    gzFile fz = gzopen(path.c_str(), "rb");
+    REQUIRE(fz != NULL);
+    char buf[1 << 16];
+    int bytes;
+    while ((bytes = gzread(fz, buf, sizeof(buf))) > 0)
+        data.append(buf, bytes);
+    REQUIRE(bytes == 0);
+    gzclose(fz);
+    unlink(path.c_str());
+    unlink((path + ".idx").c_str());
+    return data;
+}
+
+auto loopTrace(STLoggerCompressed &logger, unsigned seed) -> void
+{
+    /* random loops, logged the same way for the same seed.
+     * Descending loops may end at address zero */
+    srand(seed);
+    EID eid = 0;
+    for (int loop = 0; loop < 300; ++loop)
+    {
+        Addr base = 0x1000 * (rand() % 4);
+        int64_t step = 8 * (rand() % 5) - 16;
+        unsigned iters = rand() % 40 + 1;
+        unsigned body = rand() % 3 + 1;
+        for (unsigned i = 0; i < iters; ++i)
+        {
+            Addr offset = step >= 0 ? step*i : -step*(iters - 1 - i);
+            for (unsigned b = 0; b < body; ++b)
+            {
+                STCompEventCompressed ev;
+                ev.iops = b + 1;
+                ev.flops = loop % 2;
+                ev.updateWrites(base + 0x100*b + offset, 8);
+                ev.incWrites();
+                if (b % 2 == 1)
+                {
+                    ev.updateReads(base + 0x10000 + offset, 4);
+                    ev.incReads();
+                }
+                logger.flush(ev, eid++, 1);
+            }
+        }
+
+        int choice = rand() % 4;
+        if (choice == 0)
+        {
+            logger.instrMarker(100);
+        }
+        else if (choice == 1)
+        {
+            STCommEventCompressed ev;
+            ev.addEdge(2, eid, 0x5000, 0x5007);
+            logger.flush(ev, eid++, 1);
+        }
+        else if (choice == 2)
+        {
+            Addr arg = 0x1000;
+            logger.flush(2, 1, &arg, eid++, 1);
+        }
+    }
+}
+
+}; //end namespace
+
+
+TEST_CASE("repeated compute events fold into repeat records", "[RepeatLogger]")
+{
+    srand(time(NULL));
+    RepeatLoggerCompressed::configure(8);
+
+    SECTION("a loop walking arrays is one record")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<1000; ++i)
+                trace.comp(3, 1, {range(0x10000 + 8*i, 8)}, {range(0x20000 + 8*i, 8)});
+        });
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[1].repeatEvents == 999);
+        REQUIRE(records[1].period == 1);
+        REQUIRE(records[1].stride == 8);
+    }
+
+    SECTION("descending strides")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<1000; ++i)
+                trace.comp(2, 0, {range(0x90000 - 64*i, 4)}, {});
+        });
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[1].stride == -64);
+    }
+
+    SECTION("loop bodies of several events")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<500; ++i)
+            {
+                trace.comp(5, 0, {range(0x10000 + 16*i, 4)}, {});
+                trace.comp(1, 2, {}, {range(0x40000 + 16*i, 8), range(0x50000 + 16*i, 8)});
+                trace.comp(7, 0, {}, {});
+            }
+        });
+        REQUIRE(records.size() <= 4);
+        REQUIRE(repeats(records) == 1);
+    }
+
+    SECTION("events without addresses")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<100; ++i)
+                trace.comp(100, 0, {}, {});
+        });
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[1].stride == 0);
+    }
+
+    SECTION("markers and synchronization split loops")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<1000; ++i)
+            {
+                trace.comp(3, 1, {range(0x10000 + 8*i, 8)}, {});
+                if (i % 10 == 9)
+                    trace.marker();
+                if (i % 100 == 99)
+                    trace.comm();
+                if (i % 250 == 249)
+                    trace.sync();
+            }
+        });
+        REQUIRE(repeats(records) > 0);
+    }
+
+    SECTION("loop bodies longer than the period limit are not folded")
+    {
+        auto records = fold([](Trace &trace)
+        {
+            for (Addr i=0; i<20; ++i)
+                for (unsigned j=0; j<9; ++j)
+                    trace.comp(j+1, 0, {range(0x10000 + 256*i, 4)}, {});
+        });
+        REQUIRE(repeats(records) == 0);
+    }
+
+    SECTION("random traces expand exactly")
+    {
+        fold([](Trace &trace)
+        {
+            for (int i=0; i<20000; ++i)
+            {
+                int choice = rand() % 100;
+                Addr base = 0x1000 * (rand() % 4) + 8 * (rand() % 4);
+                if (choice < 2)
+                    trace.comm();
+                else if (choice < 3)
+                    trace.sync();
+                else if (choice < 8)
+                    trace.marker();
+                else if (choice < 50)
+                    trace.comp(rand() % 3, 0, {range(base, 8)}, {});
+                else
+                    trace.comp(1, rand() % 2, {}, {range(base, 4), range(base + 16, 4)});
+            }
+        });
+    }
+}
+
+
+TEST_CASE("folded text traces expand to the unfolded trace", "[RepeatExpander]")
+{
+    RepeatLoggerCompressed::configure(8);
+    unsigned seed = time(NULL);
+
+    auto plainDir = tempDir();
+    auto foldedDir = tempDir();
+    {
+        TextLoggerCompressed logger(1, plainDir);
+        loopTrace(logger, seed);
+    }
+    {
+        RepeatLoggerCompressed logger(std::make_unique<TextLoggerCompressed>(1, foldedDir));
+        loopTrace(logger, seed);
+    }
+
+    std::string trace = "/sigil.events.out-1.gz";
+    std::string expand = ("python3 " STGEN_SCRIPTS_DIR "/stgen_repeat_expander.py " +
+                          foldedDir + trace + " " + foldedDir + "/expanded.gz");
+    REQUIRE(system(expand.c_str()) == 0);
+
+    auto plain = readBack(plainDir + trace);
+    auto folded = readBack(foldedDir + trace);
+    auto expanded = readBack(foldedDir + "/expanded.gz");
+    rmdir(plainDir.c_str());
+    rmdir(foldedDir.c_str());
+
+    REQUIRE(folded.find(",rep:") != std::string::npos);
+    REQUIRE(folded.size() < plain.size());
+    REQUIRE(expanded == plain);
+}
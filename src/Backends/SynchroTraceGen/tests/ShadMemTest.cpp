@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <time.h>
+#include <thread>
 
 #include "SynchroTraceGen/STShadowMemory.hpp"
 
@@ -10,6 +11,9 @@ using STGen::STShadowMemory;
 using STGen::TID;
 using STGen::EID;
 
+constexpr TID maxTestTID = 4096;
+/* well beyond the old 128 thread limit */
+
 TEST_CASE("shadow memory inits readers/writers", "[ShadowMemoryInit]")
 {
     SECTION("secondary maps and values are INITIALIZED")
@@ -18,10 +22,13 @@ TEST_CASE("shadow memory inits readers/writers", "[ShadowMemoryInit]")
         REQUIRE(sm.getWriterTID(0) == STGen::SO_UNDEF);
         REQUIRE(sm.getWriterEID(0) == 0);
 
-        for(size_t i = 0; i < STGen::MAX_THREADS; ++i)
+        for(size_t i = 0; i < maxTestTID; ++i)
         {
             REQUIRE(sm.isReaderTID(0, i) == false);
         }
+
+        /* checking for a reader does not create a set */
+        REQUIRE(sm.readers.count() == 1);
     }
 }
 
@@ -34,12 +41,12 @@ TEST_CASE("shadow memory tracks readers/writers", "[ShadowMemorySetGet]")
         std::cout << std::endl;
         STShadowMemory sm;
 
-        TID tid1 = rand() % STGen::MAX_THREADS;
+        TID tid1 = rand() % maxTestTID;
         Addr addr1 = 0x0000;
         SglMemEv ev1 = {addr1, 4, SGLPRIM_MEM_LOAD,};
         sm.updateReader(ev1.begin_addr, ev1.size, tid1);
 
-        TID tid2 = rand() % STGen::MAX_THREADS;
+        TID tid2 = rand() % maxTestTID;
         Addr addr2 = sm.sm.sm_size - 1;
         ByteCount bytes = 8;
         SglMemEv ev2 = {addr2, bytes, SGLPRIM_MEM_LOAD,};
@@ -57,13 +64,13 @@ TEST_CASE("shadow memory tracks readers/writers", "[ShadowMemorySetGet]")
     {
         STShadowMemory sm;
 
-        TID tid1 = rand() % STGen::MAX_THREADS;
+        TID tid1 = rand() % maxTestTID;
         Addr addr1 = 0x0000;
         SglMemEv ev1 = {addr1, 4, SGLPRIM_MEM_STORE,};
         EID eid1 = rand() % 1000;
         sm.updateWriter(ev1.begin_addr, ev1.size, tid1, eid1);
 
-        TID tid2 = rand() % STGen::MAX_THREADS;
+        TID tid2 = rand() % maxTestTID;
         Addr addr2 = sm.sm.sm_size - 1;
         ByteCount bytes = 8;
         SglMemEv ev2 = {addr2, bytes, SGLPRIM_MEM_STORE,};
@@ -103,15 +110,231 @@ TEST_CASE("shadow memory tracks readers/writers", "[ShadowMemorySetGet]")
         REQUIRE(sm.getWriterEID(addr1) == eid1);
     }
 
+    SECTION("setting WRITERS with event IDs past 32 bits")
+    {
+        STShadowMemory sm;
+
+        EID eid1 = (1ULL << 32) + 7;
+        EID eid2 = STGen::MAX_EID;
+        sm.updateWriter(0x0000, 4, 1, eid1);
+        sm.updateWriter(0x0004, 4, 2, eid2);
+
+        REQUIRE(sm.getWriterEID(0x0000) == eid1);
+        REQUIRE(sm.getWriterEID(0x0003) == eid1);
+        REQUIRE(sm.getWriterEID(0x0004) == eid2);
+        REQUIRE(sm.getWriterTID(0x0004) == 2);
+
+        sm.updateWriter(0x0000, 1, 1, 5);
+        REQUIRE(sm.getWriterEID(0x0000) == 5);
+        REQUIRE(sm.getWriterEID(0x0001) == eid1);
+    }
+
+    SECTION("setting WRITERS with an event ID per compression level")
+    {
+        STShadowMemory sm;
+        sm.setLevels(3);
+        REQUIRE(sm.levelEvents != nullptr);
+
+        EID eids1[] = {7, (1ULL << 32) + 3, 1};
+        EID eids2[] = {8, STGen::MAX_EID, 2};
+        sm.updateWriter(0x0000, 4, 1, eids1);
+        sm.updateWriter(0x0002, 1, 2, eids2);
+
+        EID got[STGen::maxCompressionLevels];
+        sm.getWriterEIDs(0x0003, got);
+        REQUIRE(sm.getWriterTID(0x0003) == 1);
+        REQUIRE(got[0] == eids1[0]);
+        REQUIRE(got[1] == eids1[1]);
+        REQUIRE(got[2] == eids1[2]);
+
+        sm.getWriterEIDs(0x0002, got);
+        REQUIRE(sm.getWriterTID(0x0002) == 2);
+        REQUIRE(sm.getWriterEID(0x0002) == eids2[0]);
+        REQUIRE(got[1] == eids2[1]);
+        REQUIRE(got[2] == eids2[2]);
+
+        auto stats = sm.getStats();
+        REQUIRE(stats.smAllocated == 2);
+        REQUIRE(stats.bytesResident == (sm.sm.getStats().bytesResident +
+                                        sm.levelEvents->getStats().bytesResident));
+    }
+
     SECTION("setting multiple readers")
     {
-        //TODO
+        STShadowMemory sm;
+
+        Addr addr1 = 0x1000;
+        Addr addr2 = 0x2000;
+        for (TID tid = 1; tid < maxTestTID; ++tid)
+        {
+            sm.updateReader(addr1, 8, tid);
+            sm.updateReader(addr2, 8, maxTestTID - tid);
+        }
+
+        for (TID tid = 1; tid < maxTestTID; ++tid)
+        {
+            REQUIRE(sm.isReaderTID(addr1, tid) == true);
+            REQUIRE(sm.isReaderTID(addr1 + 7, tid) == true);
+            REQUIRE(sm.isReaderTID(addr2, tid) == true);
+        }
+        REQUIRE(sm.isReaderTID(addr1, maxTestTID) == false);
+        REQUIRE(sm.isReaderTID(addr1 + 8, 1) == false);
+
+        /* same readers in a different order share one set */
+        REQUIRE(sm.sm[addr1].last_readers == sm.sm[addr2].last_readers);
+        REQUIRE(sm.readers.members(sm.sm[addr1].last_readers).size() == maxTestTID - 1);
+
+        sm.updateWriter(addr1, 8, 1, 1);
+        for (TID tid = 1; tid < maxTestTID; ++tid)
+        {
+            REQUIRE(sm.isReaderTID(addr1, tid) == false);
+            REQUIRE(sm.isReaderTID(addr2, tid) == true);
+        }
+
+        REQUIRE(sizeof(STShadowMemory::ShadowObject) <= 12);
+
+        /* one node per set, and the larger sets share the smaller ones */
+        REQUIRE(sm.readers.count() == maxTestTID);
+        REQUIRE(sm.getStats().readerSets == maxTestTID);
+
+        sm.updateWriter(addr2, 8, 1, 1);
+        REQUIRE(sm.readers.count() == 1);
     }
 
     SECTION("thread safety of setting/resetting multiple readers")
     {
-        //TODO
+        /* Each thread reads its own addresses, but with the same readers,
+         * so the threads share, and release, the same sets */
+        STShadowMemory sm;
+        constexpr unsigned threads = 8;
+        constexpr unsigned rounds = 200;
+        std::vector<std::thread> pool;
+        std::vector<int> errors(threads, 0);
+
+        /* secondary maps are allocated up front; only the sets are shared */
+        for (unsigned t = 0; t < threads; ++t)
+            sm.updateWriter(0x10000 * (t + 1), 1, t + 1, 1);
+
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            pool.emplace_back([&, t]{
+                Addr base = 0x10000 * (t + 1);
+                for (unsigned round = 0; round < rounds; ++round)
+                {
+                    for (TID tid = 1; tid <= 16; ++tid)
+                        sm.updateReader(base, 64, (tid * 7 + round) % 16 + 1);
+                    for (TID tid = 1; tid <= 16; ++tid)
+                        errors[t] += (sm.isReaderTID(base + tid, tid) == false);
+                    errors[t] += (sm.isReaderTID(base + 64, 1) == true);
+                    sm.updateWriter(base, 64, t + 1, round);
+                    errors[t] += (sm.isReaderTID(base, 1) == true);
+                }
+            });
+        }
+        for (auto &thread : pool)
+            thread.join();
+
+        for (unsigned t = 0; t < threads; ++t)
+            REQUIRE(errors[t] == 0);
+        REQUIRE(sm.readers.count() == 1);
+    }
+}
+
+
+TEST_CASE("reader sets are reclaimed and reused", "[ReaderSets]")
+{
+    STShadowMemory sm;
+
+    SECTION("sets are released by writes")
+    {
+        for (TID tid = 1; tid < maxTestTID; ++tid)
+            sm.updateReader(0x1000, 4, tid);
+        REQUIRE(sm.readers.count() == maxTestTID);
+
+        /* a partial write leaves the set with the remaining bytes */
+        sm.updateWriter(0x1000, 2, 1, 1);
+        REQUIRE(sm.readers.count() == maxTestTID);
+        sm.updateWriter(0x1002, 2, 1, 1);
+        REQUIRE(sm.readers.count() == 1);
+        REQUIRE(sm.getStats().readerSetsPeak >= maxTestTID);
+    }
+
+    SECTION("adding readers out of order does not keep the old sets")
+    {
+        for (TID tid = maxTestTID - 1; tid > 0; --tid)
+            sm.updateReader(0x1000, 4, tid);
+        REQUIRE(sm.readers.count() == maxTestTID);
+        REQUIRE(sm.readers.members(sm.sm[0x1000].last_readers).front() == 1);
+    }
+
+    SECTION("reused sets are not confused with reclaimed ones")
+    {
+        sm.updateReader(0x1000, 1, 1);
+        REQUIRE(sm.isReaderTID(0x1000, 1) == true);
+        REQUIRE(sm.isReaderTID(0x1000, 2) == false);
+        auto reclaimed = sm.sm[0x1000].last_readers;
+
+        sm.updateWriter(0x1000, 1, 3, 1);
+        sm.updateReader(0x2000, 1, 2);
+        REQUIRE(sm.sm[0x2000].last_readers == reclaimed);
+
+        REQUIRE(sm.isReaderTID(0x2000, 1) == false);
+        REQUIRE(sm.isReaderTID(0x2000, 2) == true);
+        sm.updateReader(0x2000, 1, 1);
+        REQUIRE(sm.readers.members(sm.sm[0x2000].last_readers) == std::vector<TID>({1, 2}));
     }
 }
 
 
+
+
+TEST_CASE("shadow memory footprint and spilling", "[ShadowMemoryLimit]")
+{
+    SECTION("secondary maps are counted")
+    {
+        STShadowMemory sm;
+        auto before = sm.sm.getStats();
+        REQUIRE(before.smAllocated == 0);
+        REQUIRE(before.smResident == 0);
+
+        sm.updateWriter(0, 1, 1, 1);
+        sm.updateWriter(sm.sm.sm_size, 1, 1, 1);
+        sm.updateWriter(sm.sm.sm_size + 1, 1, 1, 1);
+
+        auto after = sm.sm.getStats();
+        REQUIRE(after.smAllocated == 2);
+        REQUIRE(after.smResident == 2);
+        REQUIRE(after.bytesResident == before.bytesResident + 2*sm.sm.sm_bytes);
+        REQUIRE(after.bytesPeak == after.bytesResident);
+    }
+
+    SECTION("evicted secondary maps are restored on access")
+    {
+        STShadowMemory sm;
+        auto baseline = sm.sm.getStats().bytesResident;
+        sm.sm.setLimit(baseline + 2*sm.sm.sm_bytes, ".");
+
+        constexpr unsigned maps = 6;
+        for (unsigned i = 0; i < maps; ++i)
+            sm.updateWriter(i*sm.sm.sm_size + i, 4, i+1, 1000+i);
+
+        auto stats = sm.sm.getStats();
+        REQUIRE(stats.smAllocated == maps);
+        REQUIRE(stats.smResident <= 2);
+        REQUIRE(stats.smEvicted >= maps - 2);
+        REQUIRE(stats.bytesPeak <= baseline + 2*sm.sm.sm_bytes);
+
+        for (unsigned i = 0; i < maps; ++i)
+        {
+            Addr addr = i*sm.sm.sm_size + i;
+            REQUIRE(sm.getWriterTID(addr) == static_cast<TID>(i+1));
+            REQUIRE(sm.getWriterEID(addr + 3) == 1000+i);
+            REQUIRE(sm.getWriterTID(addr + 4) == STGen::SO_UNDEF);
+        }
+
+        stats = sm.sm.getStats();
+        REQUIRE(stats.smAllocated == maps);
+        REQUIRE(stats.smFaulted > 0);
+        REQUIRE(stats.smResident <= 2);
+    }
+}
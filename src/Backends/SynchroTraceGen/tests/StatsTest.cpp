@@ -0,0 +1,193 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "SynchroTraceGen/STStats.hpp"
+
+using namespace STGen;
+
+namespace
+{
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.stats.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+}; //end namespace
+
+
+TEST_CASE("lock regions are summarized per lock", "[LockStats]")
+{
+    PerLockStats stats;
+    for (int i = 0; i < 1000; ++i)
+    {
+        Addr lock = 0x1000 + 0x10*(i % 3);
+        stats.lock();
+        for (int j = 0; j < i % 5; ++j)
+            stats.incIOPs();
+        stats.incInstrs();
+        stats.unlock(lock);
+
+        /* outside a lock region */
+        stats.incIOPs();
+    }
+
+    auto locks = stats.getAllLocksStats();
+    REQUIRE(locks.size() == 3);
+
+    StatCounter regions = 0;
+    StatCounter iops = 0;
+    for (auto &p : locks)
+    {
+        regions += p.second.count;
+        iops += p.second.iops.sum;
+        REQUIRE(p.second.iops.min == 0);
+        REQUIRE(p.second.iops.max == 4);
+        REQUIRE(p.second.instrs.min == 1);
+        REQUIRE(p.second.instrs.max == 1);
+        REQUIRE(p.second.instrs.log2Buckets[1] == p.second.count);
+
+        StatCounter bucketed = 0;
+        for (auto count : p.second.iops.log2Buckets)
+            bucketed += count;
+        REQUIRE(bucketed == p.second.count);
+    }
+    REQUIRE(regions == 1000);
+    REQUIRE(iops == 200*(0+1+2+3+4));
+
+    SECTION("values land in their power of two bucket")
+    {
+        StatSummary summary;
+        summary.add(0);
+        summary.add(1);
+        summary.add(2);
+        summary.add(3);
+        summary.add(4);
+        summary.add(~0ULL);
+        REQUIRE(summary.log2Buckets[0] == 1);
+        REQUIRE(summary.log2Buckets[1] == 1);
+        REQUIRE(summary.log2Buckets[2] == 2);
+        REQUIRE(summary.log2Buckets[3] == 1);
+        REQUIRE(summary.log2Buckets[64] == 1);
+    }
+}
+
+
+TEST_CASE("barrier regions are streamed to a file", "[BarrierStats]")
+{
+    auto path = tempPath();
+    {
+        PerBarrierStats stats(path);
+        for (StatCounter i = 0; i < 10000; ++i)
+        {
+            for (StatCounter j = 0; j < i % 7; ++j)
+                stats.incIOPs();
+            stats.incInstrs();
+            if (i % 11 == 0)
+                stats.incLocks();
+            stats.barrier(0x2000 + 8*(i % 4));
+        }
+
+        /* reading back does not stop later regions from being recorded */
+        REQUIRE(stats.getAllBarriersStats().size() == 10000);
+        stats.incFLOPs();
+        stats.barrier(0x3000);
+
+        PerBarrierStats copy{stats};
+        auto barriers = copy.getAllBarriersStats();
+        REQUIRE(barriers.size() == 10001);
+
+        StatCounter i = 0;
+        for (auto &p : barriers)
+        {
+            if (i < 10000)
+            {
+                REQUIRE(p.first == 0x2000 + 8*(i % 4));
+                REQUIRE(p.second.iops == i % 7);
+                REQUIRE(p.second.instrs == 1);
+                REQUIRE(p.second.locks == (i % 11 == 0 ? 1 : 0));
+            }
+            else
+            {
+                REQUIRE(p.first == 0x3000);
+                REQUIRE(p.second.flops == 1);
+            }
+            ++i;
+        }
+    }
+    unlink(path.c_str());
+}
+
+
+TEST_CASE("communication is counted per producer thread", "[CommStats]")
+{
+    auto path = tempPath();
+
+    SECTION("without barrier regions, only the totals are kept")
+    {
+        PerCommStats::configure(false);
+        PerCommStats stats(path);
+        stats.edge(2, 8);
+        stats.edge(2, 4);
+        stats.edge(5, 1);
+        stats.barrier(0x1000);
+
+        auto &row = stats.getRow();
+        REQUIRE(row.size() == 6);
+        REQUIRE(row[2].bytes == 12);
+        REQUIRE(row[2].edges == 2);
+        REQUIRE(row[5].bytes == 1);
+        REQUIRE(row[5].edges == 1);
+        REQUIRE(row[3].edges == 0);
+    }
+
+    SECTION("each barrier region's row is streamed to a file")
+    {
+        PerCommStats::configure(true);
+        {
+            PerCommStats stats(path);
+            for (int region = 0; region < 100; ++region)
+            {
+                for (int i = 0; i <= region % 3; ++i)
+                    stats.edge(1 + i, 8);
+                stats.barrier(0x1000 + region % 2);
+            }
+
+            PerCommStats copy{stats};
+            REQUIRE(copy.getRow()[1].edges == 100);
+            REQUIRE(copy.getRow()[3].bytes == 8*33);
+        }
+        PerCommStats::configure(false);
+
+        FILE *file = fopen(path.c_str(), "r");
+        REQUIRE(file != NULL);
+        char header[64];
+        REQUIRE(fgets(header, sizeof(header), file) != NULL);
+        REQUIRE(std::string(header) == "region,barrier,producer,bytes,edges\n");
+
+        unsigned long long region, barrier, bytes, edges;
+        size_t producer;
+        int lines = 0;
+        bool ok = true;
+        while (fscanf(file, "%llu,%llu,%zu,%llu,%llu\n",
+                      &region, &barrier, &producer, &bytes, &edges) == 5)
+        {
+            ok &= (barrier == 0x1000 + region % 2);
+            ok &= (producer >= 1 && producer <= 1 + region % 3);
+            ok &= (bytes == 8 && edges == 1);
+            ++lines;
+        }
+        fclose(file);
+        REQUIRE(ok);
+        REQUIRE(lines == 34*1 + 33*2 + 33*3);
+    }
+
+    unlink(path.c_str());
+}
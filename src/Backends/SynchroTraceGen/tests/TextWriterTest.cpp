@@ -0,0 +1,119 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <limits>
+#include <string>
+
+#include "SynchroTraceGen/TextWriter.hpp"
+
+using STGen::TextWriter;
+
+namespace
+{
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.textwriter.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+auto readBack(const std::string &path) -> std::string
+{
+    std::string text;
+    gzFile fz = gzopen(path.c_str(), "rb");
+    REQUIRE(fz != NULL);
+    char buf[4096];
+    int bytes;
+    while ((bytes = gzread(fz, buf, sizeof(buf))) > 0)
+        text.append(buf, bytes);
+    gzclose(fz);
+    unlink(path.c_str());
+    return text;
+}
+
+auto hexRef(Addr addr) -> std::string
+{
+    /* the format of the original text traces */
+    char buf[32];
+    if (addr == 0)
+        return "0x0000000000000000";
+    snprintf(buf, sizeof(buf), "0x%lx", static_cast<unsigned long>(addr));
+    return buf;
+}
+
+}; //end namespace
+
+
+TEST_CASE("text writer formats integers", "[TextWriterFormat]")
+{
+    srand(time(NULL));
+
+    SECTION("decimal and hex match the reference format")
+    {
+        auto path = tempPath();
+        std::string expected;
+        {
+            TextWriter out(path);
+            std::vector<uint64_t> vals{0, 1, 9, 10, 99, 100, 101, 4095, 65536,
+                                       std::numeric_limits<uint32_t>::max(),
+                                       std::numeric_limits<uint64_t>::max()};
+            for (int i = 0; i < 1000; ++i)
+                vals.push_back(static_cast<uint64_t>(rand()) << (rand() % 33));
+
+            for (auto val : vals)
+            {
+                out.reserve(TextWriter::maxDecLen + TextWriter::maxHexLen + 2);
+                out.dec(val);
+                out.put(' ');
+                out.hex(val);
+                out.put('\n');
+                expected += std::to_string(val) + " " + hexRef(val) + "\n";
+            }
+
+            int16_t tid = -12;
+            unsigned char syncType = 7;
+            out.reserve(2*TextWriter::maxDecLen + 16);
+            out.dec(tid);
+            out.put(",pth_ty:");
+            out.dec(syncType);
+            out.put('\n');
+            expected += "-12,pth_ty:7\n";
+        }
+        REQUIRE(readBack(path) == expected);
+    }
+
+    SECTION("output spans multiple blocks and long lines")
+    {
+        auto path = tempPath();
+        std::string expected;
+        {
+            TextWriter out(path);
+            for (uint64_t i = 0; i < 200000; ++i)
+            {
+                out.reserve(TextWriter::maxDecLen + 1);
+                out.dec(i);
+                out.put('\n');
+                expected += std::to_string(i) + "\n";
+            }
+
+            /* a single line longer than a block */
+            size_t ranges = TextWriter::blockSize / TextWriter::maxHexLen + 10;
+            out.reserve(ranges * (TextWriter::maxHexLen + 1) + 1);
+            for (size_t i = 0; i < ranges; ++i)
+            {
+                out.put(' ');
+                out.hex(i + 1);
+                expected += " " + hexRef(i + 1);
+            }
+            out.put('\n');
+            expected += "\n";
+        }
+        REQUIRE(readBack(path) == expected);
+    }
+}
@@ -0,0 +1,172 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "SynchroTraceGen/TextWriter.hpp"
+#include "SynchroTraceGen/TraceIndex.hpp"
+
+using STGen::TextWriter;
+using STGen::TracePosition;
+using STGen::IndexedTraceReader;
+
+namespace
+{
+
+constexpr uint64_t numEvents = 1000000;
+constexpr uint64_t eventsPerBarrier = 1000;
+constexpr int markerLimit = 4096;
+/* a few megabytes of text, so the trace spans several blocks */
+
+auto tempPath() -> std::string
+{
+    char path[] = "./sigil.traceindex.test.XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    return path;
+}
+
+auto writeTrace(const std::string &path) -> void
+{
+    /* lines of "eid instrs barriers" */
+    TracePosition pos;
+    TextWriter out(path, &pos);
+    for (uint64_t eid = 0; eid < numEvents; ++eid)
+    {
+        if (eid % 100 == 0)
+        {
+            out.reserve(16);
+            out.put("! ");
+            out.dec(markerLimit);
+            out.put('\n');
+            pos.onMarker(markerLimit);
+        }
+
+        out.reserve(3*(TextWriter::maxDecLen+1));
+        out.dec(eid);
+        out.put(' ');
+        out.dec(pos.instrs);
+        out.put(' ');
+        out.dec(pos.barriers);
+        out.put('\n');
+
+        if (eid % eventsPerBarrier == eventsPerBarrier-1)
+            pos.onSync(STGen::barrierSyncType, eid);
+        else
+            pos.onEvent(eid);
+    }
+}
+
+auto readFrom(IndexedTraceReader &reader, size_t bytes) -> std::string
+{
+    std::string text(bytes, '\0');
+    text.resize(reader.read(&text[0], bytes));
+    return text;
+}
+
+auto firstEventLine(const std::string &text) -> std::string
+{
+    /* skip markers */
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line) && line[0] == '!');
+    return line;
+}
+
+auto hasLineStarting(const std::string &text, const std::string &prefix) -> bool
+{
+    return (text.compare(0, prefix.size(), prefix) == 0 ||
+            text.find("\n" + prefix) != std::string::npos);
+}
+
+}; //end namespace
+
+
+TEST_CASE("indexed traces seek to events", "[TraceIndex]")
+{
+    srand(time(NULL));
+
+    auto path = tempPath();
+    writeTrace(path);
+
+    IndexedTraceReader reader(path);
+    REQUIRE(reader.entries().size() > 2);
+
+    /* no more than a block, plus a line, is decompressed to reach a target */
+    const size_t maxSkip = 2*TextWriter::blockSize;
+
+    SECTION("the whole trace reads back from the start")
+    {
+        auto pos = reader.seekEvent(0);
+        REQUIRE(pos.eid == 0);
+        std::string text;
+        std::string chunk;
+        while ((chunk = readFrom(reader, 1 << 20)).empty() == false)
+            text += chunk;
+        REQUIRE(std::count(text.begin(), text.end(), '\n') ==
+                numEvents + numEvents/100);
+    }
+
+    SECTION("members start on event boundaries")
+    {
+        for (auto &entry : reader.entries())
+        {
+            auto pos = reader.seekEvent(entry.eid);
+            REQUIRE(pos.eid == entry.eid);
+            std::istringstream line(firstEventLine(readFrom(reader, 4096)));
+            uint64_t eid, instrs, barriers;
+            line >> eid >> instrs >> barriers;
+            REQUIRE(eid == pos.eid);
+            REQUIRE(barriers == pos.barriers);
+            REQUIRE(instrs >= pos.instrs);
+        }
+    }
+
+    SECTION("members starting partway through a barrier region are skipped")
+    {
+        for (auto &entry : reader.entries())
+        {
+            auto pos = reader.seekBarrier(entry.barriers);
+            REQUIRE(pos.barriers <= entry.barriers);
+            std::string text = readFrom(reader, maxSkip);
+            REQUIRE(hasLineStarting(text, std::to_string(entry.barriers*eventsPerBarrier) + " "));
+        }
+    }
+
+    SECTION("seeking stops within one block of the target")
+    {
+        for (int i = 0; i < 20; ++i)
+        {
+            uint64_t target = rand() % numEvents;
+            auto pos = reader.seekEvent(target);
+            REQUIRE(pos.eid <= target);
+            std::string text = readFrom(reader, maxSkip);
+            REQUIRE(hasLineStarting(text, std::to_string(target) + " "));
+        }
+
+        for (int i = 0; i < 20; ++i)
+        {
+            uint64_t barrier = rand() % (numEvents/eventsPerBarrier);
+            auto pos = reader.seekBarrier(barrier);
+            REQUIRE(pos.barriers <= barrier);
+            std::string text = readFrom(reader, maxSkip);
+            REQUIRE(hasLineStarting(text, std::to_string(barrier*eventsPerBarrier) + " "));
+        }
+
+        for (int i = 0; i < 20; ++i)
+        {
+            uint64_t instrs = rand() % (numEvents/100*markerLimit);
+            auto pos = reader.seekInstrs(instrs);
+            REQUIRE(pos.instrs <= instrs);
+        }
+    }
+
+    unlink(path.c_str());
+    unlink((path + ".idx").c_str());
+}
@@ -0,0 +1,116 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "SynchroTraceGen/TraceShards.hpp"
+
+using STGen::TraceShards;
+using STGen::TID;
+using STGen::EID;
+
+namespace
+{
+
+constexpr int numThreads = 8;
+constexpr uint64_t numRegions = 500;
+
+auto tempDir() -> std::string
+{
+    char path[] = "./sigil.shards.test.XXXXXX";
+    REQUIRE(mkdtemp(path) != NULL);
+    return path;
+}
+
+auto isDirectory(const std::string &path) -> bool
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+}; //end namespace
+
+
+TEST_CASE("regions of every thread are listed in the manifest", "[TraceShards]")
+{
+    auto dir = tempDir();
+    TraceShards::configure(true, dir);
+    REQUIRE(TraceShards::sharded() == true);
+
+    /* each thread records a region per barrier, then its last region */
+    std::vector<std::thread> threads;
+    for (TID tid = 1; tid <= numThreads; ++tid)
+        threads.emplace_back([tid, &dir]
+        {
+            EID first = 0;
+            for (uint64_t region = 0; region <= numRegions; ++region)
+            {
+                std::string path = TraceShards::regionPath(dir, region);
+                EID end = first + 10 + tid;
+                Addr barrier = 0x1000 + region % 3;
+                TraceShards::record(region, tid, path, first, end,
+                                    region < numRegions ? &barrier : nullptr);
+                first = end;
+            }
+        });
+    for (auto &t : threads)
+        t.join();
+    TraceShards::close();
+    REQUIRE(TraceShards::sharded() == false);
+
+    std::ifstream manifest(dir + "/sigil.shards.out.csv");
+    std::string line;
+    REQUIRE(std::getline(manifest, line));
+    REQUIRE(line == "region,thread,path,firstEvent,endEvent,barrier");
+
+    std::map<TID, std::vector<std::vector<std::string>>> regions;
+    while (std::getline(manifest, line))
+    {
+        std::vector<std::string> fields;
+        std::istringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ','))
+            fields.push_back(field);
+        if (line.back() == ',')
+            fields.push_back("");
+        REQUIRE(fields.size() == 6);
+        regions[std::stoi(fields[1])].push_back(fields);
+    }
+
+    REQUIRE(regions.size() == numThreads);
+    bool ok = true;
+    for (auto &p : regions)
+    {
+        /* each thread's regions are in order and cover its events */
+        REQUIRE(p.second.size() == numRegions + 1);
+        EID first = 0;
+        for (uint64_t region = 0; region <= numRegions; ++region)
+        {
+            auto &fields = p.second[region];
+            ok &= (std::stoull(fields[0]) == region);
+            ok &= (fields[2] == dir + "/r" + std::to_string(region));
+            ok &= (std::stoull(fields[3]) == first);
+            first = std::stoull(fields[4]);
+            ok &= (fields[5] == (region < numRegions ?
+                                 std::to_string(0x1000 + region % 3) : ""));
+        }
+    }
+    REQUIRE(ok);
+
+    for (uint64_t region = 0; region <= numRegions; ++region)
+    {
+        std::string path = dir + "/r" + std::to_string(region);
+        REQUIRE(isDirectory(path));
+        rmdir(path.c_str());
+    }
+    unlink((dir + "/sigil.shards.out.csv").c_str());
+    rmdir(dir.c_str());
+}
@@ -0,0 +1,192 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#include "SynchroTraceGen/ParallelGzip.hpp"
+#include "SynchroTraceGen/TraceOutput.hpp"
+
+using STGen::GzipWriter;
+using STGen::TraceOutput;
+using STGen::TraceStreamHeader;
+
+namespace
+{
+
+auto readAll(int fd, void *buf, size_t bytes) -> bool
+{
+    char *dst = static_cast<char*>(buf);
+    while (bytes > 0)
+    {
+        ssize_t got = recv(fd, dst, bytes, 0);
+        if (got <= 0)
+            return false;
+        dst += got;
+        bytes -= got;
+    }
+    return true;
+}
+
+auto gunzip(const std::string &data) -> std::string
+{
+    /* inflate concatenated gzip members */
+    std::string text;
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    REQUIRE(inflateInit2(&strm, 15 + 16) == Z_OK);
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    strm.avail_in = data.size();
+    char buf[1 << 16];
+    while (strm.avail_in > 0)
+    {
+        strm.next_out = reinterpret_cast<Bytef*>(buf);
+        strm.avail_out = sizeof(buf);
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        REQUIRE((ret == Z_OK || ret == Z_STREAM_END));
+        text.append(buf, sizeof(buf) - strm.avail_out);
+        if (ret == Z_STREAM_END)
+            inflateReset(&strm);
+    }
+    inflateEnd(&strm);
+    return text;
+}
+
+class TestConsumer
+{
+    /* Stands in for a simulator: collects each stream by name */
+  public:
+    TestConsumer(std::string socketPath, int streams)
+    {
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(listenFd >= 0);
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(socketPath.c_str());
+        REQUIRE(bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        REQUIRE(listen(listenFd, streams) == 0);
+
+        acceptor = std::thread([this, streams]
+        {
+            std::vector<std::thread> readers;
+            for (int i = 0; i < streams; ++i)
+            {
+                int fd = accept(listenFd, nullptr, nullptr);
+                readers.emplace_back(&TestConsumer::consume, this, fd);
+            }
+            for (auto &t : readers)
+                t.join();
+        });
+    }
+
+    ~TestConsumer()
+    {
+        close(listenFd);
+    }
+
+    auto finish() -> std::map<std::string, std::string>
+    {
+        acceptor.join();
+        return received;
+    }
+
+  private:
+    auto consume(int fd) -> void
+    {
+        TraceStreamHeader header;
+        std::string name;
+        std::string data;
+        if (readAll(fd, &header, sizeof(header)) == true &&
+            memcmp(header.magic, "STGENSTR", sizeof(header.magic)) == 0)
+        {
+            name.resize(header.nameBytes);
+            readAll(fd, &name[0], name.size());
+
+            char buf[4096];
+            ssize_t got;
+            while ((got = recv(fd, buf, sizeof(buf), 0)) > 0)
+            {
+                data.append(buf, got);
+                /* a slow consumer, to exercise flow control */
+                if (rand() % 64 == 0)
+                    usleep(100);
+            }
+        }
+        close(fd);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        received[name] = data;
+    }
+
+    int listenFd;
+    std::thread acceptor;
+    std::mutex mtx;
+    std::map<std::string, std::string> received;
+};
+
+}; //end namespace
+
+
+TEST_CASE("traces stream to a live consumer", "[TraceStream]")
+{
+    srand(time(NULL));
+
+    char dir[] = "/tmp/sigil.stream.test.XXXXXX";
+    REQUIRE(mkdtemp(dir) != NULL);
+    std::string socketPath = std::string(dir) + "/stgen.sock";
+
+    constexpr int writers = 4;
+    std::vector<std::string> texts;
+    for (int i = 0; i < writers; ++i)
+    {
+        std::string text;
+        while (text.size() < 3000000)
+            text += std::to_string(rand()) + "\n";
+        texts.push_back(text);
+    }
+
+    TestConsumer consumer(socketPath, writers);
+    TraceOutput::configure(socketPath);
+    REQUIRE(TraceOutput::streaming() == true);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < writers; ++i)
+    {
+        threads.emplace_back([&, i]
+        {
+            /* the output directory is not part of the stream's name */
+            GzipWriter gz(std::string(dir) + "/sigil.events.out-" + std::to_string(i+1) + ".gz");
+            for (size_t pos = 0; pos < texts[i].size(); pos += 5000)
+                gz.write(texts[i].data() + pos, std::min<size_t>(5000, texts[i].size() - pos));
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+
+    auto received = consumer.finish();
+    REQUIRE(received.size() == writers);
+    for (int i = 0; i < writers; ++i)
+    {
+        auto name = "sigil.events.out-" + std::to_string(i+1) + ".gz";
+        REQUIRE(received.count(name) == 1);
+        REQUIRE(gunzip(received[name]) == texts[i]);
+
+        /* nothing was written to disk */
+        REQUIRE(access((std::string(dir) + "/" + name).c_str(), F_OK) != 0);
+    }
+
+    unlink(socketPath.c_str());
+    rmdir(dir);
+}
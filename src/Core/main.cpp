@@ -6,6 +6,7 @@
 #include "Backends/SynchroTraceGen/EventHandlers.hpp"
 #include "Backends/SimpleCount/Handler.hpp"
 #include "Backends/SigilClassic/Handler.hpp"
+#include "Backends/CacheSim/Handler.hpp"
 
 #ifdef PRETTY_PRINT_TITLE
 #include <iostream>
@@ -58,10 +59,16 @@ int main(int argc, char* argv[])
                           {},})
         .registerBackend("sigilclassic",
                          {[]{return std::make_unique<::SigilClassic::Handler>();},
-                          {},
-                          {},
+                          ::SigilClassic::onParse,
+                          ::SigilClassic::onExit,
                           initCaps(), //TODO
                           {},})
+        .registerBackend("cachesim",
+                         {[]{return std::make_unique<::CacheSim::Handler>();},
+                          ::CacheSim::onParse,
+                          ::CacheSim::onExit,
+                          ::CacheSim::requirements(),
+                          {},})
         .registerBackend("null",
                          {[]{return std::make_unique<::BackendIface>();},
                           {},